@@ -314,7 +314,7 @@ echo "Running: ${CMAKE_CMD[*]} ${CMAKE_CMD[@]: -1}"
     print_error "CMake configuration failed."
     print_info "Please check that all dependencies are installed:"
     print_info "  - C++17 compatible compiler"
-    print_info "  - Qt6 development libraries (Qt6Core, Qt6Widgets)"
+    print_info "  - Qt6 development libraries (Qt6Core, Qt6Network, Qt6Widgets)"
     print_info "  - PostgreSQL development libraries (libpq, libpqxx)"
     echo ""
     print_info "Try installing dependencies:"
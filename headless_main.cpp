@@ -0,0 +1,6 @@
+#include "include/HeadlessMonitor.h"
+
+// Server build: QtCore only, no window
+int main(int argc, char *argv[]) {
+    return HeadlessMonitor::exec(argc, argv);
+}
@@ -0,0 +1,76 @@
+#ifndef ALERTDISPATCHER_H
+#define ALERTDISPATCHER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "AlertSink.h"
+
+struct Alert;
+
+struct AlertSinkOptions {
+    size_t queueCapacity = 1000;   // alerts waiting; beyond this new ones are dropped
+    size_t batchSize = 50;
+    int batchDelayMs = 1000;       // longest a queued alert waits for its batch to fill
+    int retryInitialMs = 500;      // doubled after each failed attempt
+    int retryMaxMs = 30000;
+    int maxAttempts = 5;           // then the batch is dropped; 0 retries until stopped
+};
+
+struct AlertSinkStats {
+    std::string name;
+    bool open = false;
+    int pending = 0;
+    int delivered = 0;    // alerts
+    int dropped = 0;      // alerts: queue full, rejected, out of attempts or left at stop
+    int failures = 0;     // failed attempts to open the sink or deliver a batch
+    std::string lastError;
+};
+
+// Fans stored alerts out to the sinks. Each sink has its own bounded queue
+// and thread, which batches alerts, retries failed batches with exponential
+// backoff and counts what it has to drop. publish() only copies the alert
+// into each queue, so a slow or unreachable receiver never holds up the
+// query workers or the GUI thread, nor the other sinks.
+class AlertDispatcher {
+public:
+    AlertDispatcher();
+    ~AlertDispatcher();
+
+    AlertDispatcher(const AlertDispatcher&) = delete;
+    AlertDispatcher& operator=(const AlertDispatcher&) = delete;
+
+    // Before start()
+    void addSink(std::unique_ptr<AlertSink> sink, const AlertSinkOptions& options = AlertSinkOptions());
+    size_t sinkCount() const { return lanes_.size(); }
+
+    void start();
+
+    // Keeps delivering what is queued for up to drainTimeoutMs, plus one
+    // delivery in progress, then drops the rest. A sink that is failing is
+    // not retried.
+    void stop(int drainTimeoutMs = 2000);
+    bool isRunning() const { return running_; }
+
+    // Queues the alert for every sink; never waits on one. False when a full
+    // queue dropped it for at least one sink, or the dispatcher is stopped.
+    bool publish(const Alert& alert, int64_t timestampMs);
+
+    // Published alerts by AlertType, since start
+    int getPublishedCount(AlertType type) const;
+    std::vector<AlertSinkStats> getStats() const;
+
+private:
+    struct Lane;
+
+    void runLane(Lane& lane);
+
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::atomic<bool> running_;
+    std::atomic<int> published_[3];
+};
+
+#endif // ALERTDISPATCHER_H
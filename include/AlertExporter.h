@@ -0,0 +1,82 @@
+#ifndef ALERTEXPORTER_H
+#define ALERTEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <cstdint>
+
+class AlertSystem;
+struct Alert;
+
+enum class ExportFormat {
+    CSV,
+    JSONLines,
+    Columnar   // row groups of typed columns; layout in AlertExporter.cpp
+};
+
+enum class ExportSource {
+    Memory,    // alerts still held by the in-memory store
+    Journal    // the full on-disk history
+};
+
+struct ExportRequest {
+    QString filePath;
+    ExportFormat format = ExportFormat::CSV;
+    ExportSource source = ExportSource::Memory;
+    int64_t fromMs = 0;            // inclusive; 0 = from the oldest alert
+    int64_t toMs = 0;              // exclusive; 0 = up to the newest alert
+    unsigned typeMask = 0x7;       // AlertSearchIndex::typeBit per type
+};
+
+struct ExportResult {
+    int64_t exported = 0;
+    int64_t skipped = 0;           // evicted from the store mid-export
+    bool cancelled = false;
+    QString error;                 // empty on success
+};
+
+// Streams alerts from the store or journal to a file in chunks, so memory
+// use doesn't grow with the export. A cancelled or failed export removes
+// the partial file.
+class AlertExporter : public QObject {
+    Q_OBJECT
+
+public:
+    using ProgressCallback = std::function<void(int64_t done, int64_t total)>;
+
+    explicit AlertExporter(AlertSystem* alertSystem, QObject *parent = nullptr);
+    ~AlertExporter();
+
+    // Runs the export on a background thread; false if one is already running
+    bool start(const ExportRequest& request);
+    void cancel();
+    bool isRunning() const;
+
+    // The export itself, on the calling thread
+    static ExportResult run(AlertSystem* alertSystem, const ExportRequest& request,
+                            const std::atomic<bool>& cancelled,
+                            const ProgressCallback& progress = ProgressCallback());
+
+    static QString formatName(ExportFormat format);
+    static QString fileExtension(ExportFormat format);
+
+    // One alert as the JSON Lines export writes it, newline included
+    static std::string toJsonLine(const Alert& alert);
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished(qint64 exported, bool cancelled, const QString& error);
+
+private:
+    void wait();
+
+    AlertSystem* alertSystem_;
+    QThread* thread_;
+    std::atomic<bool> cancelled_;
+};
+
+#endif // ALERTEXPORTER_H
@@ -0,0 +1,127 @@
+#ifndef ALERTJOURNAL_H
+#define ALERTJOURNAL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+enum class AlertType;
+struct Alert;
+struct JournalSegment;
+
+struct AlertJournalOptions {
+    std::string directory = "journal";
+    int64_t segmentBytes = 64LL * 1024 * 1024;
+    int retentionDays = 30;        // 0 keeps segments regardless of age
+    int maxSegments = 64;          // 0 keeps any number of segments
+    int syncIntervalMs = 1000;     // fsync at most this often while alerts arrive
+    size_t maxPendingAlerts = 10000;
+};
+
+// One journaled alert; the views point into a mapped segment and are only
+// valid inside the visitor they were passed to
+struct JournalEntry {
+    uint64_t sequence = 0;
+    int64_t timestampMs = 0;
+    AlertType type{};
+    std::string_view title;
+    std::string_view querySource;
+    std::string_view message;
+    std::string_view rawResult;
+};
+
+// Append-only alert history on disk, split into segment files. A background
+// thread writes queued alerts and fsyncs them in batches; every segment is
+// memory-mapped for reading, so paging through history never loads it whole.
+// Sequence numbers continue across restarts and have no gaps within a segment.
+class AlertJournal {
+public:
+    using Visitor = std::function<bool(const JournalEntry&)>;   // return false to stop
+
+    explicit AlertJournal(const AlertJournalOptions& options = AlertJournalOptions());
+    ~AlertJournal();
+
+    AlertJournal(const AlertJournal&) = delete;
+    AlertJournal& operator=(const AlertJournal&) = delete;
+
+    // Maps existing segments, applies retention and starts the writer
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    // Queues an alert for writing; never waits on disk. Returns false when
+    // the queue is full and the alert was dropped.
+    bool append(const Alert& alert, int64_t timestampMs);
+
+    // Blocks until everything queued so far is written and synced
+    void flush();
+
+    // Reading; entries appear once written, before they are synced
+    uint64_t firstSequence() const;
+    uint64_t endSequence() const;
+    size_t read(uint64_t from, uint64_t to, const Visitor& visitor) const;
+    size_t readBackward(uint64_t before, size_t maxCount, const Visitor& visitor) const;
+
+    // First sequence with a timestamp at or after timestampMs
+    uint64_t findSequenceAt(int64_t timestampMs) const;
+
+    // Status
+    int getWrittenCount() const;
+    int getDroppedCount() const;
+    int getSyncCount() const;
+    int getSegmentCount() const;
+    int64_t getDiskBytes() const;
+    int getPendingCount() const;
+    std::string getLastError() const;
+
+private:
+    void writerLoop();
+    bool writeBatch(std::vector<std::string>& batch);
+    bool startSegment(uint64_t firstSequence, int64_t minimumBytes);
+    void sealActiveSegment();
+    void syncActiveSegment();
+    void applyRetention();
+    void setError(const std::string& error);
+
+    static bool decodeEntry(const JournalSegment& segment, size_t index, JournalEntry& entry);
+
+    AlertJournalOptions options_;
+
+    // Segments oldest first; the last one is being written while open
+    std::deque<std::unique_ptr<JournalSegment>> segments_;
+    mutable std::shared_mutex segmentsMutex_;
+
+    // Write queue, encoded records
+    std::vector<std::string> pending_;
+    uint64_t nextSequence_;
+    uint64_t flushRequested_;
+    uint64_t syncedSequence_;
+    bool stopping_;
+    mutable std::mutex queueMutex_;
+    std::condition_variable queueChanged_;
+    std::condition_variable synced_;
+
+    // Writer thread state
+    std::thread writer_;
+    std::unique_ptr<class QFile> activeFile_;
+    uint64_t writtenSequence_;
+
+    std::atomic<bool> open_;
+    std::atomic<int> writtenCount_;
+    std::atomic<int> droppedCount_;
+    std::atomic<int> syncCount_;
+
+    std::string lastError_;
+    mutable std::mutex errorMutex_;
+};
+
+#endif // ALERTJOURNAL_H
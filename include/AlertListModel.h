@@ -0,0 +1,131 @@
+#ifndef ALERTLISTMODEL_H
+#define ALERTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QColor>
+#include <QString>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+#include "AlertSystem.h"
+#include "AlertSearchIndex.h"
+
+class AlertJournal;
+
+// List model over the AlertSystem store, newest alert first. Rows hold only
+// alert ids; text and colours are produced when a row is actually painted.
+class AlertListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        AlertIdRole = Qt::UserRole + 1,
+        TypeRole,
+        TitleRole,
+        MessageRole,
+        QuerySourceRole,
+        RawResultRole,
+        TimestampRole
+    };
+
+    explicit AlertListModel(AlertSystem* alertSystem, QObject* parent = nullptr);
+
+    void setAlertSystem(AlertSystem* alertSystem);
+    AlertSystem* alertSystem() const { return alertSystem_; }
+
+    // Card background for an alert type
+    static QColor colorFor(AlertType type);
+
+    // QAbstractListModel
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+
+    // Picks up alerts added and evicted since the last call
+    void refresh();
+
+    // Rebuilds the rows from the store
+    void reload();
+
+    // Changing the filter re-runs the search through the index. A longer
+    // search or fewer types only narrows the current rows.
+    void setFilter(bool showCritical, bool showWarning, bool showInfo, const QString& searchText);
+
+    bool alertAt(int row, AlertRecord& record) const;
+    uint64_t alertIdAt(int row) const;
+
+    // Alerts evicted from the store before a refresh got to them
+    uint64_t droppedAlertCount() const { return droppedAlerts_; }
+
+    // Titles and sources repeat, so each distinct one is converted to QString once
+    QString internedText(const InternedString& value) const;
+
+private:
+    void pruneEvicted(uint64_t firstId);
+
+    AlertSystem* alertSystem_;
+
+    // Keeps the rows' payloads readable between refreshes
+    AlertSnapshot snapshot_;
+
+    // Visible ids, oldest first; row 0 is ids_.back()
+    std::deque<uint64_t> ids_;
+
+    // Next store id not yet looked at
+    uint64_t scannedUpTo_;
+    uint64_t droppedAlerts_;
+
+    // Covers every retained alert, not just the visible ones
+    AlertSearchIndex index_;
+    unsigned typeMask_;
+    std::string needle_;    // case-folded search text
+
+    mutable std::unordered_map<const void*, QString> internedText_;
+};
+
+// Alert history from the journal, newest first, fetched a page at a time as
+// the view scrolls. Rows are sequence numbers counted back from the newest
+// alert at the last reload; entries are read from the mapped segments on paint.
+class JournalHistoryModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit JournalHistoryModel(AlertJournal* journal, QObject* parent = nullptr);
+
+    // QAbstractListModel; AlertIdRole holds the journal sequence
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // Starts again from the newest journaled alert
+    void reload();
+
+    uint64_t sequenceAt(int row) const;
+    uint64_t totalCount() const { return newest_ - oldest_; }
+
+private:
+    static const int kPageSize = 500;
+
+    AlertJournal* journal_;
+    uint64_t newest_;   // end sequence at the last reload
+    uint64_t oldest_;
+    int loaded_;
+};
+
+// Paints a row as a coloured two-line card with a fixed height, so the view
+// can lay out any number of rows without measuring them
+class AlertItemDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit AlertItemDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+};
+
+#endif // ALERTLISTMODEL_H
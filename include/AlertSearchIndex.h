@@ -0,0 +1,66 @@
+#ifndef ALERTSEARCHINDEX_H
+#define ALERTSEARCHINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+#include "AlertStore.h"
+
+// Incremental filter index over the alert store: one bitset per alert type
+// and a trigram index over the lowercased title, message and query source.
+// Alerts must be added in id order; evicted ones are dropped from the front.
+// Matching is case-insensitive for ASCII; other bytes must match exactly.
+class AlertSearchIndex {
+public:
+    static const unsigned AllTypes = 0x7;
+
+    static unsigned typeBit(AlertType type) { return 1u << static_cast<unsigned>(type); }
+
+    AlertSearchIndex();
+
+    void add(const AlertRecord& record);
+    void evictBefore(uint64_t firstId);
+    void clear();
+
+    // Next id the index expects; everything below it has been added or evicted
+    uint64_t endId() const { return endId_; }
+    size_t size() const { return static_cast<size_t>(endId_ - firstId_); }
+
+    // Ids in view matching typeMask and needle, oldest first. When candidates
+    // is given (the previous results of a broader filter) only those are checked.
+    std::vector<uint64_t> search(const AlertSnapshot& view, unsigned typeMask, const std::string& needle,
+                                 const std::vector<uint64_t>* candidates = nullptr) const;
+
+    // Checks a single record without touching the index
+    static bool matches(const AlertRecord& record, unsigned typeMask, const std::string& needle);
+
+    // ASCII lowercase, used for needles
+    static std::string foldCase(std::string_view value);
+
+private:
+    typedef uint32_t Trigram;
+
+    static void collectTrigrams(std::string_view text, std::vector<Trigram>& trigrams);
+    static bool containsFolded(std::string_view haystack, const std::string& needle);
+
+    bool hasType(uint64_t id, unsigned typeMask) const;
+    void compact();
+
+    // One bit per id from the word holding firstId_ onwards, per type
+    std::deque<uint64_t> typeBits_[3];
+    uint64_t firstWord_;
+
+    // Ids stored relative to base_ to halve the postings' size
+    std::unordered_map<Trigram, std::vector<uint32_t>> postings_;
+    uint64_t base_;
+
+    uint64_t firstId_;
+    uint64_t endId_;
+    uint64_t evictedSinceCompact_;
+};
+
+#endif // ALERTSEARCHINDEX_H
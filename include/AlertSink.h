@@ -0,0 +1,89 @@
+#ifndef ALERTSINK_H
+#define ALERTSINK_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <QString>
+
+enum class AlertType;
+
+// A stored alert as handed to the sinks; owns its text, so it outlives the
+// store's copy and the string table
+struct SinkAlert {
+    int id = 0;
+    AlertType type{};
+    int64_t timestampMs = 0;
+    std::string title;
+    std::string querySource;
+    std::string message;
+};
+
+// An output for stored alerts. AlertDispatcher gives each sink a thread of
+// its own and calls every method on it, so a sink may block, and QObjects a
+// sink creates in open() belong to that thread.
+class AlertSink {
+public:
+    enum class Delivery {
+        Delivered,
+        Retry,      // a transient failure; the batch is sent again after a backoff
+        Rejected    // the receiver refused the batch; sending it again would not help
+    };
+
+    virtual ~AlertSink() = default;
+
+    // For logs and the metrics endpoint's labels
+    virtual std::string name() const = 0;
+
+    virtual bool open(std::string& error) { (void)error; return true; }
+    virtual Delivery deliver(const std::vector<SinkAlert>& batch, std::string& error) = 0;
+    virtual void close() {}
+};
+
+// Posts each batch as a JSON array to an HTTP(S) endpoint. A 2xx reply is
+// success; 408, 429, 5xx and network errors are retried, other replies are not.
+class WebhookSink : public AlertSink {
+public:
+    WebhookSink(const QString& url, int timeoutMs);
+    ~WebhookSink() override;
+
+    std::string name() const override { return "webhook"; }
+
+    bool open(std::string& error) override;
+    Delivery deliver(const std::vector<SinkAlert>& batch, std::string& error) override;
+    void close() override;
+
+    static QByteArray formatBatch(const std::vector<SinkAlert>& batch);
+
+private:
+    QString url_;
+    int timeoutMs_;
+    std::unique_ptr<class QNetworkAccessManager> network_;
+};
+
+// Sends each alert as one RFC 5424 datagram over UDP; the severity follows
+// the alert type
+class SyslogSink : public AlertSink {
+public:
+    SyslogSink(const QString& host, int port, int facility);
+    ~SyslogSink() override;
+
+    std::string name() const override { return "syslog"; }
+
+    bool open(std::string& error) override;
+    Delivery deliver(const std::vector<SinkAlert>& batch, std::string& error) override;
+    void close() override;
+
+    static QByteArray formatMessage(const SinkAlert& alert, int facility, const QString& hostName);
+
+private:
+    QString host_;
+    int port_;
+    int facility_;
+    QString hostName_;
+    std::unique_ptr<class QUdpSocket> socket_;
+    std::unique_ptr<class QHostAddress> address_;
+};
+
+#endif // ALERTSINK_H
@@ -0,0 +1,148 @@
+#ifndef ALERTSTORE_H
+#define ALERTSTORE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <shared_mutex>
+#include <cstdint>
+
+#include "StringInterner.h"
+
+enum class AlertType;
+struct Alert;
+struct ArenaChunk;
+class AlertStore;
+
+// One stored alert; the string views point into the store and stay valid
+// for as long as the snapshot they were read through
+struct AlertRecord {
+    uint64_t id = 0;
+    AlertType type{};
+    int64_t timestampMs = 0;
+    InternedString querySource;
+    InternedString title;
+    std::string_view message;
+    std::string_view rawResult;
+    uint64_t fingerprint = 0;
+    uint64_t similarityKey = 0;
+
+    Alert toAlert() const;
+};
+
+// Read-only view of the ids [firstId, endId) at the time it was taken.
+// Rows evicted afterwards read as missing; the store must outlive the view.
+class AlertSnapshot {
+public:
+    AlertSnapshot() = default;
+
+    uint64_t firstId() const { return first_; }
+    uint64_t endId() const { return end_; }
+    size_t size() const { return static_cast<size_t>(end_ - first_); }
+    bool empty() const { return first_ == end_; }
+
+    // Returns false for ids outside the view or evicted since it was taken
+    bool read(uint64_t id, AlertRecord& record) const;
+
+    // Index 0 is the oldest alert in the view
+    bool at(size_t index, AlertRecord& record) const { return read(first_ + index, record); }
+
+private:
+    friend class AlertStore;
+
+    const AlertStore* store_ = nullptr;
+    uint64_t first_ = 0;
+    uint64_t end_ = 0;
+
+    // Keeps the string payloads of the viewed rows alive
+    std::vector<std::shared_ptr<const ArenaChunk>> chunks_;
+};
+
+// Fixed-capacity ring buffer of alerts stored column by column. Titles and
+// query sources are interned; messages and raw results live in a chunked
+// arena that is released in the same FIFO order rows are evicted.
+class AlertStore {
+public:
+    // Called for each evicted row while the store is locked
+    using EvictionHandler = std::function<void(const AlertRecord&)>;
+
+    // Uses a private string table unless one is shared in
+    explicit AlertStore(size_t capacity = 1000, std::shared_ptr<StringInterner> strings = nullptr);
+    ~AlertStore();
+
+    AlertStore(const AlertStore&) = delete;
+    AlertStore& operator=(const AlertStore&) = delete;
+
+    void setEvictionHandler(EvictionHandler handler);
+
+    // Writing; appending to a full store evicts the oldest row
+    uint64_t append(const Alert& alert, int64_t timestampMs);
+    void evictOldest(size_t count);
+    void evictBefore(int64_t timestampMs);
+    void clear();
+    void setCapacity(size_t capacity);
+
+    // Moves retained rows over to another table; later appends intern there
+    void setStringTable(std::shared_ptr<StringInterner> strings);
+
+    // Reading
+    AlertSnapshot snapshot() const;
+    AlertSnapshot snapshotLatest(size_t maxCount) const;
+    AlertSnapshot snapshotSince(int64_t timestampMs) const;
+    bool read(uint64_t id, AlertRecord& record) const;
+
+    // Status
+    size_t size() const;
+    size_t capacity() const;
+    uint64_t firstId() const;
+    uint64_t endId() const;
+    size_t countByType(AlertType type) const;
+    int64_t lastTimestamp() const;
+    size_t arenaBytes() const;
+
+    std::shared_ptr<StringInterner> strings() const;
+
+private:
+    struct Span {
+        const char* data = nullptr;
+        uint32_t length = 0;
+    };
+
+    static const size_t kTypeCount = 3;
+
+    size_t slotOf(uint64_t id) const;
+    bool readLocked(uint64_t id, AlertRecord& record) const;
+    Span storeString(const std::string& value, uint64_t id);
+    void evictFrontLocked();
+    void releaseChunksLocked();
+    AlertSnapshot makeSnapshotLocked(uint64_t first) const;
+
+    // Columns, indexed by slot
+    std::vector<uint64_t> ids_;
+    std::vector<uint8_t> types_;
+    std::vector<int64_t> timestamps_;
+    std::vector<uint32_t> querySourceIds_;
+    std::vector<uint32_t> titleIds_;
+    std::vector<Span> messages_;
+    std::vector<Span> rawResults_;
+    std::vector<uint64_t> fingerprints_;
+    std::vector<uint64_t> similarityKeys_;
+
+    size_t capacity_;
+    size_t headSlot_;          // slot holding firstId_
+    uint64_t firstId_;
+    uint64_t nextId_;
+    size_t typeCounts_[kTypeCount];
+
+    std::shared_ptr<StringInterner> strings_;
+    std::vector<std::shared_ptr<StringInterner>> retiredStrings_;
+    std::deque<std::shared_ptr<ArenaChunk>> chunks_;
+    EvictionHandler evictionHandler_;
+
+    mutable std::shared_mutex mutex_;
+};
+
+#endif // ALERTSTORE_H
@@ -3,13 +3,21 @@
 
 #include <string>
 #include <vector>
-#include <deque>
 #include <chrono>
 #include <memory>
 #include <mutex>
-#include <QColor>
+#include <unordered_map>
+#include <cstdint>
+#include <pqxx/pqxx>
 #include <QDateTime>
 
+#include "AlertStore.h"
+#include "ResultSummary.h"
+#include "KeywordMatcher.h"
+
+class AlertDispatcher;
+class AlertJournal;
+
 enum class AlertType {
     CRITICAL,
     WARNING,
@@ -19,33 +27,29 @@ enum class AlertType {
 struct Alert {
     int id;
     AlertType type;
-    std::string title;
+    InternedString title;          // handles into the shared string table
     std::string message;
-    std::string querySource;
+    InternedString querySource;
     QDateTime timestamp;
     std::string rawResult;
 
+    // Precomputed by AlertSystem when the alert is stored
+    uint64_t fingerprint = 0;     // type, querySource, title and message
+    uint64_t similarityKey = 0;   // type, querySource and title
+
     Alert() : id(0), type(AlertType::INFO) {}
 
-    Alert(int id, AlertType type, const std::string& title, const std::string& message,
-          const std::string& querySource, const std::string& rawResult = "")
+    Alert(int id, AlertType type, InternedString title, const std::string& message,
+          InternedString querySource, const std::string& rawResult = "")
         : id(id), type(type), title(title), message(message),
           querySource(querySource), timestamp(QDateTime::currentDateTime()),
           rawResult(rawResult) {}
 
-    QColor getColor() const {
-        switch (type) {
-            case AlertType::CRITICAL:
-                return QColor("#d32f2f");  // Red
-            case AlertType::WARNING:
-                return QColor("#f57c00");  // Orange/Yellow
-            case AlertType::INFO:
-            default:
-                return QColor("#388e3c");  // Green
-        }
+    std::string getTypeString() const {
+        return typeToString(type);
     }
 
-    std::string getTypeString() const {
+    static std::string typeToString(AlertType type) {
         switch (type) {
             case AlertType::CRITICAL:
                 return "CRITICAL";
@@ -58,6 +62,10 @@ struct Alert {
     }
 
     QString getFormattedTimestamp() const {
+        return formatTimestamp(timestamp);
+    }
+
+    static QString formatTimestamp(const QDateTime& timestamp) {
         QDateTime now = QDateTime::currentDateTime();
         qint64 secondsDiff = timestamp.secsTo(now);
 
@@ -84,10 +92,22 @@ public:
     int addAlert(const Alert& alert);
     int addAlert(AlertType type, const std::string& title, const std::string& message,
                  const std::string& querySource, const std::string& rawResult = "");
+    int addAlert(AlertType type, InternedString title, const std::string& message,
+                 InternedString querySource, const std::string& rawResult = "");
+
+    // Titles and query sources are interned here; QueryEngine shares its own table
+    void setStringTable(std::shared_ptr<StringInterner> strings);
+    std::shared_ptr<StringInterner> stringTable() const;
 
-    // Alert classification
+    // Alert classification. Without a recognised type name, result text
+    // containing a critical keyword makes the alert critical, a warning
+    // keyword a warning.
     AlertType classifyAlert(const std::string& alertTypeStr, const pqxx::result& result);
-    AlertType classifyFromThreshold(const pqxx::result& result, int threshold, AlertType defaultType);
+    void setClassificationKeywords(const std::vector<std::string>& critical,
+                                   const std::vector<std::string>& warning);
+    static const char* const DEFAULT_CRITICAL_KEYWORDS;
+    static const char* const DEFAULT_WARNING_KEYWORDS;
+    AlertType classifyFromThreshold(const ResultSummary& summary, int threshold, AlertType defaultType);
 
     // Duplicate detection
     bool isDuplicate(const Alert& alert, int timeWindowSeconds = 30);
@@ -96,8 +116,16 @@ public:
     // Alert retrieval
     std::vector<Alert> getRecentAlerts(int maxCount = 100);
     std::vector<Alert> getAlertsByType(AlertType type, int maxCount = 100);
+    // Falls back to the journal for alerts older than the in-memory store;
+    // those come back with id 0
     std::vector<Alert> getAlertsSince(const QDateTime& since);
 
+    // Zero-copy access; records stay readable while the snapshot is held
+    AlertSnapshot snapshot() const;
+    AlertSnapshot snapshotLatest(int maxCount) const;
+    AlertSnapshot snapshotSince(const QDateTime& since) const;
+    bool readAlert(int id, AlertRecord& record) const;
+
     // Alert cleanup
     void cleanupOldAlerts(int maxAgeSeconds = 86400);  // 24 hours default
     void enforceMaxAlerts(int maxAlerts = 1000);
@@ -112,17 +140,39 @@ public:
     void setDuplicateTimeWindow(int seconds);
     void setMaxAlerts(int maxAlerts);
 
+    // Every stored alert is also queued to the journal; not owned
+    void setJournal(AlertJournal* journal);
+    AlertJournal* journal() const;
+
+    // Every stored alert is also published to the sinks; not owned
+    void setDispatcher(AlertDispatcher* dispatcher);
+    AlertDispatcher* dispatcher() const;
+
 private:
-    std::deque<Alert> alerts_;
+    AlertStore store_;
+
+    // Serializes writers and guards the indexes; readers only need the store
     mutable std::mutex alertsMutex_;
-    int nextAlertId_;
+
+    // Key -> id of the newest retained alert with that key; entries leave with their alert
+    std::unordered_map<uint64_t, int> fingerprintIndex_;
+    std::unordered_map<uint64_t, int> similarityIndex_;
     bool duplicateDetectionEnabled_;
     int duplicateTimeWindow_;
     int maxAlerts_;
+    AlertJournal* journal_;
+    AlertDispatcher* dispatcher_;
+
+    // Compiled once per keyword change and swapped whole, so classification takes no lock while scanning
+    std::shared_ptr<const KeywordMatcher> keywords_;
+
+    bool isDuplicateInternal(const Alert& alert, int timeWindowSeconds) const;
 
-    bool isDuplicateInternal(const Alert& alert);
-    bool isSimilarInternal(const Alert& alert);
-    void removeOldestAlerts(int removeCount);
+    // Fingerprint index
+    static uint64_t computeFingerprint(const Alert& alert);
+    static uint64_t computeSimilarityKey(const Alert& alert);
+    void indexAlert(int id, const Alert& alert);
+    void unindexAlert(const AlertRecord& record);
 };
 
 #endif // ALERTSYSTEM_H
\ No newline at end of file
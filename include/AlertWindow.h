@@ -2,9 +2,9 @@
 #define ALERTWINDOW_H
 
 #include <QMainWindow>
-#include <QListWidget>
-#include <QListWidgetItem>
+#include <QListView>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QLabel>
 #include <QStatusBar>
 #include <QVBoxLayout>
@@ -26,12 +26,17 @@
 #include <QSpinBox>
 #include <QComboBox>
 #include <QCheckBox>
+#include <QDateTimeEdit>
+#include <QProgressDialog>
 
 #include "AlertSystem.h"
+#include "AlertListModel.h"
+#include "AlertExporter.h"
 #include "DatabaseManager.h"
 
 // Forward declaration
 class ConfigManager;
+class QueryEngine;
 
 class AlertWindow : public QMainWindow {
     Q_OBJECT
@@ -40,16 +45,33 @@ public:
     explicit AlertWindow(QWidget *parent = nullptr);
     ~AlertWindow();
 
-    // Database management
+    // Database management; connecting happens in the background, with its
+    // progress in the status bar. False when the connect could not start.
     bool connectToDatabase(const DatabaseManager::ConnectionConfig& config);
     void disconnectFromDatabase();
     bool isDatabaseConnected() const;
 
+    // Connects, refreshes and follows connection progress through
+    // databaseManager instead of a manager of the window's own
+    void setDatabaseManager(DatabaseManager* databaseManager);
+
+    // Shows the alerts held by alertSystem instead of the window's own store
+    void setAlertSystem(AlertSystem* alertSystem);
+
+    // Shows the engine's query latency and queue figures in the status bar
+    void setQueryEngine(QueryEngine* queryEngine);
+
     // Alert display
     void updateAlertDisplay();
     void addAlertToUI(const Alert& alert);
     void clearAlerts();
 
+    // Alerts arriving between frames are shown together in one list update
+    void setMaxRefreshRate(int updatesPerSecond);
+    int getPendingAlertCount() const;
+    int getDroppedRenderCount() const;
+    int getFlushCount() const;
+
     // Status management
     void updateConnectionStatus(bool connected);
     void updateLastUpdateTime();
@@ -58,6 +80,10 @@ public:
     void setConfigManager(ConfigManager* configManager);
     ConfigManager* getConfigManager() const;
 
+signals:
+    // Once, after the window has been painted for the first time
+    void firstFrameShown();
+
 public slots:
     void onNewAlertAdded(const Alert& alert);
     void onConnectionStatusChanged(bool connected);
@@ -66,6 +92,8 @@ public slots:
     void onConfigLoaded();
     void onMonitoringStarted();
     void onMonitoringStopped();
+    void onConnectProgress(int opened, int total);
+    void onConnectFinished(bool connected);
 
 private slots:
     void startMonitoring();
@@ -75,19 +103,26 @@ private slots:
     void exportAlerts();
     void clearAllAlerts();
     void refreshConnection();
-    void onAlertItemDoubleClicked(QListWidgetItem* item);
+    void onAlertItemDoubleClicked(const QModelIndex& index);
     void onFilterChanged();
-    void showAlertDetails(QListWidgetItem* item);
+    void showAlertDetails(const QModelIndex& index);
+    void showHistory();
+    void flushPendingAlerts();
+    void onExportProgress(qint64 done, qint64 total);
+    void onExportFinished(qint64 exported, bool cancelled, const QString& error);
 
 protected:
     void contextMenuEvent(QContextMenuEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private:
     void setupUI();
     void setupMenuBar();
     void setupStatusBar();
     void setupCentralWidget();
+    void setupLeftPanel();
+    void setupRightPanel();
     void setupAlertList();
     void setupFilterPanel();
 
@@ -101,7 +136,8 @@ private:
     QWidget* rightPanel_;
 
     // Alert display
-    QListWidget* alertList_;
+    QListView* alertList_;
+    AlertListModel* alertModel_;
     QTextEdit* alertDetails_;
 
     // Filter panel
@@ -110,11 +146,13 @@ private:
     QCheckBox* showWarning_;
     QCheckBox* showInfo_;
     QLineEdit* searchBox_;
+    QTimer* searchDebounce_;
 
     // Status bar
     QLabel* connectionStatusLabel_;
     QLabel* lastUpdateLabel_;
     QLabel* alertCountLabel_;
+    QLabel* latencyLabel_;
     QProgressBar* connectionProgressBar_;
 
     // Menus and actions
@@ -129,21 +167,44 @@ private:
     QAction* exportAction_;
     QAction* clearAction_;
     QAction* refreshAction_;
+    QAction* historyAction_;
     QAction* aboutAction_;
     QAction* exitAction_;
 
     // System components
-    std::unique_ptr<AlertSystem> alertSystem_;
-    std::unique_ptr<DatabaseManager> databaseManager_;
+    std::unique_ptr<AlertSystem> ownedAlertSystem_;   // used until setAlertSystem
+    AlertSystem* alertSystem_;
+    std::unique_ptr<DatabaseManager> ownedDatabaseManager_;   // created on first use, without setDatabaseManager
+    DatabaseManager* databaseManager_;
     ConfigManager* configManager_;
+    QueryEngine* queryEngine_;
+
+    DatabaseManager* database();
 
     // State
     bool isMonitoring_;
     bool isConnected_;
+    bool firstFrameShown_;
+
+    // Coalesced alert updates
+    QTimer* flushTimer_;
+    QElapsedTimer sinceLastFlush_;
+    int frameIntervalMs_;
+    int pendingAlerts_;
+    int lastFlushSize_;
+    int flushCount_;
+
+    void scheduleFlush();
+
+    // Latency figures are sampled rather than pushed
+    QTimer* latencyTimer_;
+    void updateLatencyStatus();
+
+    // Background export; one at a time
+    AlertExporter* exporter_;
+    QProgressDialog* exportProgress_;
 
     // UI Helpers
-    QListWidgetItem* createAlertItem(const Alert& alert);
-    void updateAlertItem(QListWidgetItem* item, const Alert& alert);
     void updateFiltering();
     void updateStatusBar();
     QString getConnectionStatusText() const;
@@ -152,10 +213,9 @@ private:
 
     // Settings dialog
     void showSettingsDialog();
-    bool validateDatabaseConfig(const DatabaseManager::ConnectionConfig& config) const;
+    bool validateDatabaseConfig(const DatabaseManager::ConnectionConfig& config);
 
     // Alert filtering
-    bool shouldShowAlert(const Alert& alert) const;
     void applyFilters();
 };
 
@@ -206,6 +266,53 @@ private:
     DatabaseManager::ConnectionConfig config_;
 };
 
+// Export Options Dialog
+class ExportDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit ExportDialog(bool journalAvailable, QWidget *parent = nullptr);
+    ~ExportDialog();
+
+    // Everything but the file path
+    ExportRequest getRequest() const;
+    void setTypeFilter(bool showCritical, bool showWarning, bool showInfo);
+
+private:
+    void setupUI(bool journalAvailable);
+
+    QComboBox* formatCombo_;
+    QComboBox* sourceCombo_;
+    QCheckBox* criticalCheck_;
+    QCheckBox* warningCheck_;
+    QCheckBox* infoCheck_;
+    QCheckBox* limitRangeCheck_;
+    QDateTimeEdit* fromEdit_;
+    QDateTimeEdit* toEdit_;
+};
+
+// Alert History Dialog, browsing the on-disk journal
+class AlertHistoryDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit AlertHistoryDialog(AlertJournal* journal, QWidget *parent = nullptr);
+    ~AlertHistoryDialog();
+
+private slots:
+    void reload();
+    void showEntry(const QModelIndex& index);
+
+private:
+    void setupUI();
+
+    AlertJournal* journal_;
+    JournalHistoryModel* model_;
+    QListView* historyList_;
+    QTextEdit* entryDetails_;
+    QLabel* summaryLabel_;
+};
+
 // Alert Details Dialog
 class AlertDetailsDialog : public QDialog {
     Q_OBJECT
@@ -4,6 +4,8 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <functional>
+#include <QObject>
 #include <QVariant>
 #include <QString>
 #include <QSettings>
@@ -12,6 +14,8 @@
 #include <QTextStream>
 #include <QFile>
 #include <QDebug>
+#include <QSize>
+#include <QPoint>
 
 struct DatabaseConfig {
     std::string host = "localhost";
@@ -22,6 +26,8 @@ struct DatabaseConfig {
     int connectTimeout = 10;
     std::string sslMode = "prefer";
     std::string applicationName = "PostgreSQL-Monitor";
+    int poolSize = 5;               // pooled connections
+    int healthCheckInterval = 30;   // seconds an idle connection may sit before it is pinged
     bool useEnvironmentVariables = false;
     std::string configFilePath = "";
 
@@ -37,6 +43,21 @@ struct DatabaseConfig {
                " sslmode=" + sslMode +
                " application_name=" + applicationName;
     }
+
+    // Whether a pool opened with other could serve this config unchanged;
+    // the health check interval applies to a running pool, so it is not compared
+    bool sameConnection(const DatabaseConfig& other) const {
+        return host == other.host && port == other.port && database == other.database &&
+               username == other.username && password == other.password &&
+               connectTimeout == other.connectTimeout && sslMode == other.sslMode &&
+               applicationName == other.applicationName && poolSize == other.poolSize;
+    }
+};
+
+// A named database from the targets file; queries pick targets by name
+struct DatabaseTarget {
+    std::string name;
+    DatabaseConfig config;
 };
 
 struct AlertConfig {
@@ -47,12 +68,45 @@ struct AlertConfig {
     bool autoScroll = true;
     QString dateFormat = "hh:mm:ss";
     QString timeFormat = "Just now;X seconds ago;X minutes ago;X hours ago;MMM dd, yyyy hh:mm:ss";
+
+    // On-disk alert history
+    bool journalEnabled = true;
+    QString journalDirectory = "journal";
+    int journalSegmentSizeMb = 64;
+    int journalMaxSegments = 64;       // 0 = no limit
+    int journalRetentionDays = 30;     // 0 = no limit
+    int journalSyncIntervalMs = 1000;
+
+    // Outputs fed each stored alert, every one with its own queue and thread
+    QString webhookUrl;                // JSON batches are POSTed here; empty = off
+    int webhookTimeoutMs = 5000;
+    QString syslogHost;                // RFC 5424 over UDP; empty = off
+    int syslogPort = 514;
+    int syslogFacility = 16;           // local0
+    int metricsPort = 0;               // Prometheus /metrics; 0 = off
+    QString metricsAddress = "127.0.0.1";
+    int sinkQueueSize = 1000;          // alerts per sink; beyond this new ones are dropped
+    int sinkBatchSize = 50;
+    int sinkBatchDelayMs = 1000;
+    int sinkRetryMaxMs = 30000;        // backoff doubles up to this
+    int sinkMaxAttempts = 5;           // 0 = retry until shutdown
+
+    // Comma-separated; result text containing one raises the alert to that severity
+    QString criticalKeywords = "error,fail,critical,breach";
+    QString warningKeywords = "warning,alert,unusual";
 };
 
-struct QueryConfig {
+struct QueryEngineConfig {
     std::string queriesFilePath = "config/queries.conf";
+    std::string targetsFilePath = "config/database.conf";   // [Target:<name>] sections
+    std::string watermarksFilePath = "watermarks.state";    // last values of cursor queries
     int executionInterval = 1000;  // milliseconds
     int maxConcurrentQueries = 5;
+    int maxQueuedQueries = 100;
+    bool batchExecution = false;    // pipeline read-only queries on one connection
+    bool adaptiveScheduling = false;   // back quiet queries off, see queries.conf
+    int adaptiveMaxInterval = 60000;   // milliseconds
+    bool watchConfigFiles = true;      // reload the queries and targets files when they change
     bool startMonitoringOnStartup = false;
     bool enableQueryLogging = false;
 };
@@ -69,11 +123,14 @@ struct UIConfig {
     QString alertFontFamily = "Segoe UI, Arial, sans-serif";
     int alertFontSize = 10;
     bool darkTheme = false;
+    int maxRefreshRate = 30;    // alert list updates per second at most
 };
 
-class ConfigManager {
+class ConfigManager : public QObject {
+    Q_OBJECT
+
 public:
-    explicit ConfigManager();
+    explicit ConfigManager(QObject *parent = nullptr);
     ~ConfigManager();
 
     // Configuration file management
@@ -90,13 +147,18 @@ public:
                              const std::string& username, const std::string& password,
                              int timeout = 10, const std::string& sslMode = "prefer");
 
+    // Databases monitored besides the one above, read from [Target:<name>]
+    // sections; keys a target leaves out are taken from the [Database] section
+    bool loadDatabaseTargets(const QString& filePath);
+    std::vector<DatabaseTarget> getDatabaseTargets() const;
+
     // Alert configuration
     AlertConfig getAlertConfig() const;
     void setAlertConfig(const AlertConfig& config);
 
     // Query configuration
-    QueryConfig getQueryConfig() const;
-    void setQueryConfig(const QueryConfig& config);
+    QueryEngineConfig getQueryConfig() const;
+    void setQueryConfig(const QueryEngineConfig& config);
 
     // UI configuration
     UIConfig getUIConfig() const;
@@ -144,6 +206,9 @@ public:
     static std::vector<QString> getRecentConfigFiles();
     static void addToRecentConfigFiles(const QString& filePath);
 
+signals:
+    void configChanged();
+
 private:
     // Configuration parsing
     bool parseConfigFile(const QString& content);
@@ -157,6 +222,8 @@ private:
     bool parseQuerySection(const QStringList& lines, int& lineNumber);
     bool parseUISection(const QStringList& lines, int& lineNumber);
     bool parseGeneralSection(const QStringList& lines, int& lineNumber);
+    bool parseDatabaseKey(DatabaseConfig& config, const QString& key, const QString& value);
+    static bool isValidTargetName(const QString& name);
 
     // Section formatters
     QStringList formatDatabaseSection() const;
@@ -174,7 +241,7 @@ private:
     // Configuration defaults
     DatabaseConfig getDefaultDatabaseConfig() const;
     AlertConfig getDefaultAlertConfig() const;
-    QueryConfig getDefaultQueryConfig() const;
+    QueryEngineConfig getDefaultQueryConfig() const;
     UIConfig getDefaultUIConfig() const;
 
     // Configuration templates
@@ -182,8 +249,9 @@ private:
 
     // Member variables
     DatabaseConfig databaseConfig_;
+    std::vector<DatabaseTarget> databaseTargets_;
     AlertConfig alertConfig_;
-    QueryConfig queryConfig_;
+    QueryEngineConfig queryConfig_;
     UIConfig uiConfig_;
 
     QString currentConfigPath_;
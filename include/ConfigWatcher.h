@@ -0,0 +1,46 @@
+#ifndef CONFIGWATCHER_H
+#define CONFIGWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+// Reports configuration files that changed on disk, once their writes have
+// settled. Editors that save by writing a new file and renaming it over the
+// old one are followed through the rename: each file's directory is watched
+// too, so a replaced or recreated file is picked up again.
+class ConfigWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ConfigWatcher(QObject *parent = nullptr);
+
+    // A file that does not exist yet is reported once it is created
+    void watch(const QString& filePath);
+    QStringList watchedFiles() const;
+
+    // How long a file must go unwritten before it is reported
+    void setSettleDelay(int milliseconds);
+    int getSettleDelay() const;
+
+signals:
+    void fileChanged(const QString& filePath);
+
+private slots:
+    void onFileChanged(const QString& filePath);
+    void onDirectoryChanged(const QString& directory);
+    void onSettled();
+
+private:
+    void rewatch(const QString& filePath);
+
+    QFileSystemWatcher* watcher_;
+    QTimer* settleTimer_;
+    QStringList files_;         // absolute paths, as given to watch()
+    QSet<QString> changed_;     // reported when settleTimer_ fires
+};
+
+#endif // CONFIGWATCHER_H
@@ -0,0 +1,116 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <pqxx/pqxx>
+
+// A single pooled libpq connection with its own health state
+struct PooledConnection {
+    std::unique_ptr<pqxx::connection> connection;
+    std::chrono::steady_clock::time_point lastUsed;
+    std::chrono::steady_clock::time_point lastHealthCheck;
+    bool broken = false;
+    int index = 0;
+    int reconnectCount = 0;
+
+    // Statements prepared on this connection (name -> SQL)
+    std::map<std::string, std::string> preparedStatements;
+
+    // Last statement_timeout set on this session in ms, -1 if never set
+    long long statementTimeoutMs = -1;
+};
+
+class ConnectionPool;
+
+// RAII checkout of a pooled connection, returned to the pool on destruction
+class ConnectionLease {
+public:
+    ConnectionLease() = default;
+    ConnectionLease(ConnectionPool* pool, PooledConnection* connection);
+    ~ConnectionLease();
+
+    ConnectionLease(ConnectionLease&& other) noexcept;
+    ConnectionLease& operator=(ConnectionLease&& other) noexcept;
+    ConnectionLease(const ConnectionLease&) = delete;
+    ConnectionLease& operator=(const ConnectionLease&) = delete;
+
+    explicit operator bool() const { return connection_ != nullptr; }
+    pqxx::connection& operator*() const { return *connection_->connection; }
+    pqxx::connection* operator->() const { return connection_->connection.get(); }
+    PooledConnection* get() const { return connection_; }
+
+    // Broken connections are reconnected on their next checkout
+    void markBroken();
+    void release();
+
+private:
+    ConnectionPool* pool_ = nullptr;
+    PooledConnection* connection_ = nullptr;
+    bool broken_ = false;
+};
+
+class ConnectionPool {
+public:
+    // Runs on every connection right after it is opened or reopened, possibly
+    // on several connections at once while the pool opens
+    using ConnectionInitializer = std::function<void(PooledConnection&)>;
+
+    // Connections opened and initialized so far, out of the pool size; called
+    // on whichever thread opened the connection
+    using OpenProgress = std::function<void(int opened, int size)>;
+
+    ConnectionPool();
+    ~ConnectionPool();
+
+    void setConnectionInitializer(ConnectionInitializer initializer);
+
+    // Pool lifecycle
+    // The first connection opens alone, so an unreachable server fails once;
+    // the rest then open side by side
+    bool open(const std::string& connectionString, int size, std::string& error,
+              const OpenProgress& progress = OpenProgress());
+    void close();
+    bool isOpen() const;
+
+    // Connection checkout; returns an empty lease on timeout or failure
+    ConnectionLease acquire(std::chrono::milliseconds timeout, std::string& error);
+
+    // Health checking
+    void setHealthCheckInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getHealthCheckInterval() const;
+
+    // Status
+    int size() const;
+    int idleCount() const;
+    int healthyCount() const;
+
+private:
+    friend class ConnectionLease;
+
+    void release(PooledConnection* connection, bool broken);
+    bool ensureHealthy(PooledConnection& connection, std::string& error);
+    bool reconnectConnection(PooledConnection& connection, std::string& error);
+    void initializeConnection(PooledConnection& connection);
+    bool openConnection(PooledConnection& connection, const std::string& connectionString, std::string& error);
+
+    std::string connectionString_;
+    ConnectionInitializer initializer_;
+    std::vector<std::unique_ptr<PooledConnection>> connections_;
+    std::vector<PooledConnection*> idle_;
+    int leasedCount_;
+    bool closing_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable drained_;
+    std::chrono::milliseconds healthCheckInterval_;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -3,20 +3,42 @@
 
 #include <string>
 #include <memory>
+#include <map>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <pqxx/pqxx>
 #include <QObject>
+#include <QPointer>
+#include <QThread>
 #include <QTimer>
 #include <QDateTime>
 
-// Forward declaration
-class ConfigManager;
-struct DatabaseConfig;
+#include "ConnectionPool.h"
+#include "ConfigManager.h"
+
+// Outcome of one statement in a pipelined batch
+struct PreparedBatchResult {
+    std::string name;
+    bool success = false;
+    std::string errorMessage;
+    pqxx::result data;
+};
+
+// Where one execution spent its time; filled in when passed to an execute call
+struct QueryTiming {
+    std::chrono::microseconds connectionWait{0};   // waiting for a pooled connection
+    std::chrono::microseconds execution{0};        // preparing, running and fetching on the server
+};
 
 class DatabaseManager : public QObject {
     Q_OBJECT
 
 public:
+    using ConnectionConfig = DatabaseConfig;
+
     explicit DatabaseManager(ConfigManager* configManager = nullptr, QObject *parent = nullptr);
     ~DatabaseManager();
 
@@ -28,10 +50,41 @@ public:
     void disconnect();
     bool reconnect();
 
+    // As connect(), but the pool opens and prepares its statements on a thread
+    // of its own: connectProgress follows each pooled connection and
+    // connectFinished the outcome. False, with no connectFinished, when the
+    // configuration is invalid or a connect is already under way.
+    bool connectAsync(const DatabaseConfig& config);
+    bool connectAsync();   // Uses config from ConfigManager
+    bool isConnecting() const;
+
     // Query execution
     pqxx::result executeQuery(const std::string& query);
     pqxx::result executeQuery(const std::string& query, const std::vector<std::string>& params);
 
+    // Prepared statements, prepared once per pooled connection
+    void registerStatement(const std::string& name, const std::string& sql);
+    void unregisterStatement(const std::string& name);
+    bool hasStatement(const std::string& name) const;
+    // A non-zero timeout is enforced with statement_timeout and a client-side cancel
+    pqxx::result executePrepared(const std::string& name, const std::vector<std::optional<std::string>>& params = {},
+                                 std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+                                 QueryTiming* timing = nullptr);
+
+    // Runs several read-only prepared statements on one connection in a single round-trip
+    std::vector<PreparedBatchResult> executePreparedBatch(const std::vector<std::string>& names,
+                                                          std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+                                                          QueryTiming* timing = nullptr);
+
+    // Query deadlines
+    int cancelOverdueQueries();
+    int getCancelledQueryCount() const;
+
+    // Connection pool
+    ConnectionLease acquireConnection();
+    int getPoolSize() const;
+    int getIdleConnectionCount() const;
+
     // Connection health
     bool pingConnection();
     std::string getLastError() const;
@@ -39,6 +92,11 @@ public:
     // Configuration
     void setConnectionConfig(const DatabaseConfig& config);
     DatabaseConfig getConnectionConfig() const;
+
+    // Adopts config without disturbing a pool that can serve it: only a change
+    // of connection parameters reconnects, in the background as connectAsync
+    // does. True when it started reconnecting; connectFinished follows.
+    bool applyConnectionConfig(const DatabaseConfig& config);
     void setConfigManager(ConfigManager* configManager);
     ConfigManager* getConfigManager() const;
 
@@ -66,15 +124,37 @@ signals:
     void connectionStatusChanged(bool connected);
     void connectionError(const std::string& error);
     void reconnectionAttempt(int attemptCount);
+    void connectProgress(int opened, int total);
+    void connectFinished(bool connected);
     void configLoaded();
 
 private:
     // Core connection management
-    std::unique_ptr<pqxx::connection> connection_;
+    std::unique_ptr<ConnectionPool> connectionPool_;
     DatabaseConfig config_;
     mutable std::mutex connectionMutex_;
     std::string lastError_;
-    bool isConnected_;
+    std::atomic<bool> isConnected_;
+
+    // Registered prepared statements (name -> SQL)
+    std::map<std::string, std::string> statements_;
+    mutable std::mutex statementsMutex_;
+
+    // Executions with a deadline, keyed by a per-execution token
+    struct ActiveQuery {
+        PooledConnection* connection;
+        std::chrono::steady_clock::time_point deadline;
+        std::string name;
+        bool cancelled;
+    };
+
+    class DeadlineScope;
+
+    std::map<uint64_t, ActiveQuery> activeQueries_;
+    uint64_t nextQueryToken_;
+    std::mutex activeQueriesMutex_;
+    std::atomic<int> cancelledQueries_;
+    QTimer* deadlineTimer_;
 
     // Configuration management
     ConfigManager* configManager_;
@@ -85,6 +165,14 @@ private:
     bool autoReconnectEnabled_;
     int reconnectInterval_;
     int connectionAttemptCount_;
+    bool retryAfterConnect_;     // the connect under way is a reconnection attempt
+    bool restartAfterConnect_;   // the connect under way has connection parameters since replaced
+
+    // Background connects; a connect or disconnect made while one runs
+    // supersedes its outcome
+    QPointer<QThread> connectThread_;
+    uint64_t connectGeneration_;
+    bool connecting_;
 
     // Connection status tracking
     QDateTime connectionEstablishedTime_;
@@ -92,6 +180,13 @@ private:
 
     // Core methods
     bool createConnection();
+    void startConnect();
+    void finishConnect(bool connected, uint64_t generation);
+    void waitForConnect();
+    void prepareRegisteredStatements(PooledConnection& connection);
+    void ensurePrepared(PooledConnection& connection, const std::string& name);
+    void applyStatementTimeout(PooledConnection& connection, std::chrono::milliseconds timeout);
+    void handleQueryFailure(ConnectionLease& lease, const std::exception& e, const std::string& context);
     void setError(const std::string& error);
     std::string buildConnectionString() const;
     bool validateDatabaseConfig() const;
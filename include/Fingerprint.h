@@ -0,0 +1,42 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <pqxx/pqxx>
+
+// Streaming XXH64 hasher. Digests are for in-process comparison only and
+// are not stable across hosts of different endianness.
+class Fingerprint {
+public:
+    explicit Fingerprint(uint64_t seed = 0);
+
+    void update(const void* data, size_t length);
+    void updateValue(uint64_t value);
+
+    // Length-prefixed, so consecutive fields can't run into each other
+    void updateField(const char* data, size_t length);
+    void updateField(const std::string& value);
+
+    uint64_t digest() const;
+
+    // Every field of every row, with NULLs distinct from empty strings
+    static uint64_t ofResult(const pqxx::result& result);
+
+    // The same over only the given rows, as if they were the whole result
+    static uint64_t ofRows(const pqxx::result& result, const std::vector<pqxx::result::size_type>& rows);
+
+private:
+    void updateRow(const pqxx::row& row);
+    void consumeStripe(const unsigned char* stripe);
+
+    uint64_t seed_;
+    uint64_t accumulators_[4];
+    unsigned char buffer_[32];
+    size_t bufferSize_;
+    uint64_t totalLength_;
+};
+
+#endif // FINGERPRINT_H
@@ -0,0 +1,52 @@
+#ifndef HEADLESSMONITOR_H
+#define HEADLESSMONITOR_H
+
+#include <string>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class MonitorRuntime;
+struct Alert;
+
+enum class HeadlessOutput {
+    Text,       // one readable line per alert
+    JSONLines,  // the JSON Lines export format
+    None        // journal only
+};
+
+// Runs the monitor under QCoreApplication with no widgets. Alerts go to
+// stdout and the journal; status and errors go to stderr. Monitoring starts
+// as soon as the database is reachable and resumes after a reconnect.
+class HeadlessMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    HeadlessMonitor(MonitorRuntime* runtime, HeadlessOutput output, QObject *parent = nullptr);
+    ~HeadlessMonitor();
+
+    // Parses the command line, runs until SIGINT/SIGTERM and returns the exit code
+    static int exec(int argc, char *argv[]);
+
+    static bool parseOutput(const QString& name, HeadlessOutput& output);
+    static std::string formatTextLine(const Alert& alert);
+
+    int getPrintedCount() const;
+
+private slots:
+    void onAlertGenerated(const Alert& alert);
+    void onConnectionStatusChanged(bool connected);
+    void onQueryError(const std::string& queryId, const std::string& error);
+    void checkForShutdown();
+
+private:
+    static void installSignalHandlers();
+    void startMonitoring();
+
+    MonitorRuntime* runtime_;
+    HeadlessOutput output_;
+    QTimer* shutdownPoll_;
+    int printedCount_;
+};
+
+#endif // HEADLESSMONITOR_H
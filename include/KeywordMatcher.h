@@ -0,0 +1,59 @@
+#ifndef KEYWORDMATCHER_H
+#define KEYWORDMATCHER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Case-insensitive multi-keyword search (Aho-Corasick). Keywords are added
+// with a category from 0 to 31 and compiled once into a transition table,
+// after which one pass over the raw bytes finds every keyword at once: no
+// lowercased copies and no per-keyword scans. Only ASCII letters fold case.
+// A compiled matcher is read-only and safe to share between threads.
+class KeywordMatcher {
+public:
+    static constexpr int kMaxCategories = 32;
+
+    KeywordMatcher();
+
+    // Empty keywords and categories out of range are ignored
+    void add(const std::string& keyword, int category);
+    void compile();
+
+    bool isCompiled() const { return compiled_; }
+    bool empty() const { return keywords_.empty(); }
+    size_t stateCount() const { return stateCount_; }
+
+    // Bit c is set when a keyword of category c occurs in the bytes. The
+    // scan stops early once any category in stopOn has been found.
+    uint32_t scan(const char* data, size_t length, uint32_t stopOn = 0) const;
+    uint32_t scan(const std::string& text, uint32_t stopOn = 0) const {
+        return scan(text.data(), text.size(), stopOn);
+    }
+
+    // Comma-separated keyword list, trimmed, empty entries dropped
+    static std::vector<std::string> splitList(const std::string& list);
+
+private:
+    struct Keyword {
+        std::string text;   // lowercased
+        int category;
+    };
+
+    std::vector<Keyword> keywords_;
+
+    // Bytes that appear in no keyword share class 0 and always return to the root
+    uint8_t classOf_[256];
+    int classCount_;
+    size_t stateCount_;
+
+    // Transitions indexed by row offset (state * classCount_) plus byte class,
+    // holding the next state's row offset, which keeps the multiply off the
+    // per-byte dependency chain. Categories found sit at each row's start.
+    std::vector<uint32_t> scanTable_;
+    std::vector<uint32_t> scanOutputs_;
+    bool compiled_;
+};
+
+#endif // KEYWORDMATCHER_H
@@ -0,0 +1,68 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Percentiles of one histogram, in milliseconds
+struct LatencySummary {
+    uint64_t count = 0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double meanMs = 0.0;
+};
+
+// Point-in-time copy of a histogram's counters; snapshots of several
+// histograms can be added together before taking percentiles
+struct LatencySnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    uint64_t sumMicros = 0;
+    uint64_t maxMicros = 0;
+
+    void add(const LatencySnapshot& other);
+    uint64_t percentileMicros(double percentile) const;
+    LatencySummary summary() const;
+};
+
+// Log-linear histogram of durations in microseconds, laid out like
+// HdrHistogram: values below 2^kSubBucketBits get a bucket each, and every
+// power of two above that is split into 2^kSubBucketBits buckets, so a
+// reported percentile is within about 6% of the true value. record() is a
+// few relaxed atomic adds and never locks or allocates, so worker threads
+// call it on the hot path; a snapshot taken during a record() may miss it.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kMaxExponent = 36;   // larger values (over 19 hours) are clamped
+    static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 1) << kSubBucketBits;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::chrono::microseconds value);
+    void reset();
+
+    uint64_t count() const;
+    LatencySnapshot snapshot() const;
+    LatencySummary summary() const { return snapshot().summary(); }
+
+    // Bucket layout
+    static int bucketIndex(uint64_t micros);
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sumMicros_;
+    std::atomic<uint64_t> maxMicros_;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,53 @@
+#ifndef METRICSENDPOINT_H
+#define METRICSENDPOINT_H
+
+#include <string>
+#include <functional>
+#include <atomic>
+#include <QString>
+
+class AlertDispatcher;
+class AlertSystem;
+class QTcpServer;
+class QTcpSocket;
+class QThread;
+class QueryEngine;
+
+// Serves GET /metrics in the Prometheus text format from a thread of its
+// own, so a scrape never waits on the GUI thread and a slow scraper holds up
+// nothing but itself. The page is rendered afresh for every scrape.
+class MetricsEndpoint {
+public:
+    // Called on the endpoint's thread
+    using Renderer = std::function<std::string()>;
+
+    explicit MetricsEndpoint(Renderer renderer);
+    ~MetricsEndpoint();
+
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    // Port 0 picks a free one; see port()
+    bool start(const QString& address, int port, std::string& error);
+    void stop();
+    bool isRunning() const;
+
+    int port() const { return port_; }
+    int getScrapeCount() const { return scrapes_; }
+
+    // Engine statistics, stored alerts and the sinks' delivery counters; any
+    // of the three may be null. Every getter used is safe off the GUI thread.
+    static std::string renderMetrics(const QueryEngine* engine, const AlertSystem* alertSystem,
+                                     const AlertDispatcher* dispatcher);
+
+private:
+    void serve(QTcpSocket* socket);
+
+    Renderer renderer_;
+    QThread* thread_;
+    QTcpServer* server_;    // lives on thread_
+    int port_;
+    std::atomic<int> scrapes_;
+};
+
+#endif // METRICSENDPOINT_H
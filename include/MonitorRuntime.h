@@ -0,0 +1,111 @@
+#ifndef MONITORRUNTIME_H
+#define MONITORRUNTIME_H
+
+#include <memory>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <QString>
+
+#include "ConfigManager.h"
+
+class AlertDispatcher;
+class AlertJournal;
+class AlertSystem;
+class ConfigWatcher;
+class DatabaseManager;
+class MetricsEndpoint;
+class QueryEngine;
+
+// The monitor minus its front end: configuration, the alert journal, sinks
+// and store, the database connection and the query engine. The window and the
+// headless daemon both start through this, so they monitor the same way.
+class MonitorRuntime {
+public:
+    // Startup messages go to log; the daemon keeps stdout for alerts
+    explicit MonitorRuntime(std::ostream& log = std::cout);
+    ~MonitorRuntime();
+
+    MonitorRuntime(const MonitorRuntime&) = delete;
+    MonitorRuntime& operator=(const MonitorRuntime&) = delete;
+
+    // Loads configFilePath, or else the first config in the usual places;
+    // with none found the defaults are written out. False when defaults are used.
+    bool loadConfig(const QString& configFilePath);
+
+    // Creates the components from the loaded configuration and loads the
+    // queries; the alert journal is opened alongside
+    void start();
+
+    // Connects the default database and every target. True when the default
+    // connected; auto-reconnect keeps trying whatever did not.
+    bool connectDatabase();
+
+    // The same without waiting: every pool opens in the background and each
+    // manager reports with connectFinished. False when the default database
+    // could not start connecting.
+    bool connectDatabaseAsync();
+    int connectedTargetCount() const;   // extra targets only
+
+    // Re-reads the targets file while monitoring runs: new targets are added
+    // and connected, removed ones stop being queried, and changed ones
+    // reconnect only when a connection parameter changed
+    void reloadTargets();
+
+    // Stops monitoring, gives the sinks a moment to deliver what is queued and
+    // waits for the journal and query watermarks to reach the disk
+    void shutdown();
+
+    // Components; null before start()
+    ConfigManager* configManager() const { return configManager_.get(); }
+    AlertJournal* journal() const { return journal_.get(); }
+    AlertDispatcher* dispatcher() const { return dispatcher_.get(); }     // null without sinks
+    AlertSystem* alertSystem() const { return alertSystem_.get(); }
+    DatabaseManager* databaseManager() const { return databaseManager_.get(); }
+    QueryEngine* queryEngine() const { return queryEngine_.get(); }
+    ConfigWatcher* configWatcher() const { return configWatcher_.get(); }   // null unless watch_config_files
+    MetricsEndpoint* metricsEndpoint() const { return metrics_.get(); }     // null unless metrics_port
+
+    bool isConfigLoaded() const { return configLoaded_; }
+    QString configFilePath() const;   // the file loaded, or where defaults are saved
+
+    void printStartupInfo() const;
+
+    static bool loadDefaultQueries(QueryEngine* queryEngine);
+
+private:
+    bool openJournal(const AlertConfig& config, std::string& error);
+    void openSinks(const AlertConfig& config);
+    void startMetrics(const AlertConfig& config);
+    void openTargets(const QueryEngineConfig& config);
+    void loadQueries(const QueryEngineConfig& config);
+    void watchConfigFiles(const QueryEngineConfig& config);
+
+    struct Target {
+        std::string name;
+        std::unique_ptr<DatabaseManager> manager;
+    };
+
+    void addTarget(const DatabaseTarget& target);
+    bool connectTarget(const Target& target);
+    void connectTargetAsync(const Target& target);
+
+    std::ostream& log_;
+
+    // Declared in dependency order, so they are destroyed engine first
+    std::unique_ptr<ConfigManager> configManager_;
+    std::unique_ptr<AlertJournal> journal_;
+    std::unique_ptr<AlertDispatcher> dispatcher_;
+    std::unique_ptr<AlertSystem> alertSystem_;
+    std::unique_ptr<DatabaseManager> databaseManager_;
+    std::vector<Target> targets_;
+    std::vector<std::unique_ptr<DatabaseManager>> retiredTargets_;   // removed, but runs may still hold them
+    std::unique_ptr<QueryEngine> queryEngine_;
+    std::unique_ptr<ConfigWatcher> configWatcher_;
+    std::unique_ptr<MetricsEndpoint> metrics_;
+
+    QString configFilePath_;
+    bool configLoaded_;
+};
+
+#endif // MONITORRUNTIME_H
@@ -0,0 +1,59 @@
+#ifndef NOTIFICATIONLISTENER_H
+#define NOTIFICATIONLISTENER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <string>
+
+// Holds one dedicated connection that LISTENs on a set of channels and
+// signals each notification as it arrives. The connection lives on its own
+// thread, which blocks on the server socket rather than polling, and is
+// reopened with backoff when it breaks. Pooled connections are never used
+// for this, so LISTEN state cannot leak into query runs.
+class NotificationListener : public QObject {
+    Q_OBJECT
+
+public:
+    explicit NotificationListener(const std::string& connectionString, QObject *parent = nullptr);
+    ~NotificationListener();
+
+    // Takes effect on the running connection within one wait slice
+    void setChannels(const std::set<std::string>& channels);
+    std::set<std::string> getChannels() const;
+
+    void start();
+    void stop();
+    bool isRunning() const;
+    bool isConnected() const;
+
+    int64_t getReceivedCount() const;
+    std::string getLastError() const;
+
+signals:
+    // Emitted on the listener thread; connect with the default (queued) connection
+    void notificationReceived(const std::string& channel, const std::string& payload, int backendPid);
+    void connectionStatusChanged(bool connected);
+
+private:
+    void run();
+    void setConnected(bool connected);
+    void setError(const std::string& error);
+    void sleepUnlessStopping(int milliseconds);
+
+    std::string connectionString_;
+    QThread* thread_;
+    std::atomic<bool> stopping_;
+    std::atomic<bool> connected_;
+    std::atomic<int64_t> received_;
+
+    mutable QMutex mutex_;
+    std::set<std::string> channels_;
+    bool channelsChanged_;
+    std::string lastError_;
+};
+
+#endif // NOTIFICATIONLISTENER_H
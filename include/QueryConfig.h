@@ -0,0 +1,101 @@
+#ifndef QUERYCONFIG_H
+#define QUERYCONFIG_H
+
+#include <string>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+#include "AlertSystem.h"
+#include "SnapshotRule.h"
+
+// A query's id interned in the engine's string table. It never changes while
+// the engine lives and is never given to another id, so a handle carried by a
+// run still names the same query after the table has been replaced.
+using QueryHandle = uint32_t;
+const QueryHandle InvalidQueryHandle = 0xFFFFFFFFu;
+
+struct QueryConfig {
+    std::string id;
+    std::string name;
+    std::string sql;
+    AlertType alertType;
+    int threshold;
+    bool enabled;
+    int timeoutSeconds;
+
+    // Scheduling (milliseconds); interval 0 uses the engine interval, phase -1 is derived from the id
+    int intervalMs;
+    int jitterMs;
+    int phaseMs;
+
+    // Databases to run against: empty for the default target, a comma-separated
+    // list of target names, or "*" for every target
+    std::string target;
+
+    // Set by listen=: the query raises an alert per NOTIFY on this channel
+    // instead of running SQL on a schedule
+    std::string channel;
+
+    bool isListener() const { return !channel.empty(); }
+
+    // Set by cursor=: the last row's value in this column is bound as $1 on the
+    // next run, so the query reads only rows added since. cursorStart seeds the
+    // first run; without it $1 is NULL.
+    std::string cursorColumn;
+    std::string cursorStart;
+
+    bool hasCursor() const { return !cursorColumn.empty(); }
+
+    // Set by aggregate=: count, or sum, min, max or avg of a column. The server
+    // folds the rows into one value and only that row comes back; the alert is
+    // raised when it reaches warningLevel or criticalLevel. Without levels,
+    // threshold and twice threshold are used, and without those any value
+    // above zero alerts.
+    std::string aggregate;
+    std::optional<double> warningLevel;
+    std::optional<double> criticalLevel;
+
+    bool isAggregate() const { return !aggregate.empty(); }
+
+    // Set by [Source:<name>] sections: a snapshot query whose rows are shared by
+    // every rule naming it in source=, so one scan serves them all. A source
+    // raises no alerts of its own beyond its failures.
+    bool snapshot;
+
+    bool isSource() const { return snapshot; }
+
+    // Set by source=: the query runs no SQL. Each snapshot of the source is
+    // filtered by where= on the worker that fetched it; message= formats the
+    // first matching row and aggregate= folds the matches on the client. An
+    // interval longer than the source's skips snapshots in between.
+    std::string source;
+    std::string filter;
+    std::string message;
+    std::shared_ptr<const SnapshotRule> rule;   // compiled from the three when loaded
+
+    bool isRule() const { return !source.empty(); }
+
+    // Adaptive polling: the interval doubles after every run whose result is empty
+    // or unchanged, up to maxIntervalMs, and drops back to minIntervalMs when a run
+    // raises an alert. Unset adaptive follows the engine's adaptive scheduling;
+    // bounds of 0 mean the query's interval and the engine maximum.
+    std::optional<bool> adaptive;
+    int minIntervalMs;
+    int maxIntervalMs;
+
+    // Set by the engine when the query is loaded; see QueryHandle
+    QueryHandle handle;
+
+    QueryConfig() : alertType(AlertType::INFO), threshold(0), enabled(true), timeoutSeconds(5),
+                    intervalMs(0), jitterMs(0), phaseMs(-1), snapshot(false), minIntervalMs(0), maxIntervalMs(0),
+                    handle(InvalidQueryHandle) {}
+
+    QueryConfig(const std::string& id, const std::string& name, const std::string& sql,
+                AlertType type = AlertType::INFO, int threshold = 0)
+        : id(id), name(name), sql(sql), alertType(type), threshold(threshold),
+          enabled(true), timeoutSeconds(5), intervalMs(0), jitterMs(0), phaseMs(-1),
+          snapshot(false), minIntervalMs(0), maxIntervalMs(0), handle(InvalidQueryHandle) {}
+};
+
+#endif // QUERYCONFIG_H
@@ -5,7 +5,10 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <deque>
+#include <set>
 #include <chrono>
+#include <optional>
 #include <QTimer>
 #include <QObject>
 #include <QThread>
@@ -15,38 +18,80 @@
 
 #include "DatabaseManager.h"
 #include "AlertSystem.h"
+#include "QueryScheduler.h"
+#include "WatermarkStore.h"
+#include "LatencyHistogram.h"
+#include "ResultSummary.h"
+#include "SnapshotRule.h"
+#include "QueryConfig.h"
+#include "QueryTable.h"
+
+class QueryWorkerPool;
+class NotificationListener;
+
+// Latency histograms of one run key. Workers record into them directly,
+// without taking any engine lock.
+struct QueryLatency {
+    LatencyHistogram connectionWait;   // waiting for a pooled connection
+    LatencyHistogram execution;        // server round-trip
+    LatencyHistogram processing;       // fingerprinting, alert generation and bookkeeping
+};
 
-struct QueryConfig {
-    std::string id;
-    std::string name;
-    std::string sql;
-    AlertType alertType;
-    int threshold;
-    bool enabled;
-    int timeoutSeconds;
-
-    QueryConfig() : alertType(AlertType::INFO), threshold(0), enabled(true), timeoutSeconds(5) {}
-
-    QueryConfig(const std::string& id, const std::string& name, const std::string& sql,
-                AlertType type = AlertType::INFO, int threshold = 0)
-        : id(id), name(name), sql(sql), alertType(type), threshold(threshold),
-          enabled(true), timeoutSeconds(5) {}
+struct QueryLatencyStats {
+    LatencySummary connectionWait;
+    LatencySummary execution;
+    LatencySummary processing;
 };
 
 struct QueryResult {
     std::string queryId;
     std::string queryName;
+    QueryHandle handle;         // the engine finds the query by this, without a lock
+    std::string target;         // the database target the query ran against
     bool success;
     std::string errorMessage;
-    pqxx::result data;
+    ResultSummary summary;      // taken from the rows on the worker thread; the rows stay there
     QDateTime timestamp;
     std::chrono::milliseconds executionTime;
+    std::optional<std::string> watermark;   // cursor column of the last row, for cursor queries
+
+    // Where the run spent its time; processingTime is the worker's share only
+    QueryTiming timing;
+    std::chrono::microseconds processingTime{0};
+    std::shared_ptr<QueryLatency> latency;
 
-    QueryResult() : success(false), executionTime(0) {}
+    QueryResult() : handle(InvalidQueryHandle), success(false), executionTime(0) {}
 
     QueryResult(const std::string& id, const std::string& name)
-        : queryId(id), queryName(name), success(false), executionTime(0),
+        : queryId(id), queryName(name), handle(InvalidQueryHandle), success(false), executionTime(0),
           timestamp(QDateTime::currentDateTime()) {}
+
+    explicit QueryResult(const QueryConfig& query)
+        : queryId(query.id), queryName(query.name), handle(query.handle), success(false),
+          timestamp(QDateTime::currentDateTime()), executionTime(0) {}
+};
+
+// Unit of work for the worker pool; more than one query runs as a pipelined batch.
+// Every query in a job runs against the same target.
+struct QueryJob {
+    std::vector<QueryConfig> queries;
+    std::string target;
+    DatabaseManager* database = nullptr;
+    std::optional<std::string> watermark;   // $1 of a cursor query; cursor queries never batch
+
+    // Rules evaluated against the rows of the job's one query, a source; their
+    // results follow the source's, and their histograms follow its in latencies
+    std::vector<QueryConfig> rules;
+
+    // Histograms of each query, parallel to queries, and when the job was queued
+    std::vector<std::shared_ptr<QueryLatency>> latencies;
+    std::chrono::steady_clock::time_point enqueuedAt;
+
+    QueryJob() = default;
+    QueryJob(const QueryConfig& query, const std::string& target, DatabaseManager* database)
+        : queries{query}, target(target), database(database) {}
+    QueryJob(std::vector<QueryConfig> batch, const std::string& target, DatabaseManager* database)
+        : queries(std::move(batch)), target(target), database(database) {}
 };
 
 class QueryEngine : public QObject {
@@ -56,17 +101,44 @@ public:
     explicit QueryEngine(DatabaseManager* dbManager, AlertSystem* alertSystem, QObject *parent = nullptr);
     ~QueryEngine();
 
-    // Query configuration
+    // Query configuration. Loading replaces the queries with those of the
+    // file, but only re-prepares queries whose statement changed and only
+    // reschedules those whose schedule changed; the rest run on undisturbed.
     bool loadQueriesFromFile(const std::string& filePath);
     bool loadQueriesFromString(const std::string& configData);
+
+    // Reads and parses filePath on a thread of its own, then loads it as above
+    // and emits queriesReloaded. A file that cannot be read or holds no queries
+    // leaves the running ones alone. A reload asked for while one is parsing
+    // runs after it.
+    void reloadQueriesFromFile(const std::string& filePath);
     void addQuery(const QueryConfig& query);
     void removeQuery(const std::string& queryId);
     void updateQuery(const QueryConfig& query);
 
-    // Query management
+    // Query management. Reads take no lock; the query returned is shared, so
+    // it stays valid after the query is removed or replaced.
     void enableQuery(const std::string& queryId, bool enabled);
-    QueryConfig* getQuery(const std::string& queryId);
+    std::shared_ptr<const QueryConfig> getQuery(const std::string& queryId) const;
     std::vector<QueryConfig> getAllQueries() const;
+    std::shared_ptr<const QueryTable> getQueryTable() const;
+
+    // Database targets. The manager given to the constructor is the default
+    // target; the engine owns none of them, and a removed manager must outlive
+    // runs already queued against it.
+    static const char* const DEFAULT_TARGET;
+    void addTarget(const std::string& name, DatabaseManager* dbManager);
+    void removeTarget(const std::string& name);
+    DatabaseManager* getTarget(const std::string& name) const;
+    std::vector<std::string> getTargetNames() const;
+
+    // Scheduler, in-flight and statistics key: the query id on the default
+    // target, "id@target" elsewhere
+    static std::string runKey(const std::string& queryId, const std::string& target);
+
+    // The statement prepared for a query: its sql, or for an aggregate query
+    // SELECT <aggregate> AS value FROM (sql) AS monitored. False on a bad aggregate.
+    static bool statementSql(const QueryConfig& query, std::string& sql, std::string& error);
 
     // Monitoring control
     void startMonitoring();
@@ -80,13 +152,57 @@ public:
     void setMaxConcurrentQueries(int maxQueries);
     int getMaxConcurrentQueries() const;
 
+    void setMaxQueuedQueries(int maxQueued);
+    int getMaxQueuedQueries() const;
+
+    void setBatchExecution(bool enabled);
+    bool isBatchExecutionEnabled() const;
+
+    // Adaptive polling for queries that don't set adaptive= themselves, and the
+    // longest interval a quiet query backs off to when it sets no max_interval
+    void setAdaptiveScheduling(bool enabled);
+    bool isAdaptiveSchedulingEnabled() const;
+    void setAdaptiveMaxInterval(int milliseconds);
+    int getAdaptiveMaxInterval() const;
+
+    // The interval a run key is polled at now, which differs from its
+    // configured one while adaptive polling has backed it off; 0 when not scheduled
+    int getCurrentInterval(const std::string& runKey) const;
+
+    // Watermarks of cursor queries, persisted in filePath across restarts
+    bool setWatermarkFile(const std::string& filePath);
+    bool saveWatermarks();
+    std::optional<std::string> getWatermark(const std::string& runKey) const;
+    void resetWatermark(const std::string& runKey);
+
     // Statistics
     int getExecutedQueriesCount() const;
     int getFailedQueriesCount() const;
+    int getDroppedQueriesCount() const;
+    int getSkippedQueriesCount() const;
+    int getCancelledQueriesCount() const;
+    int getTickOverrunCount() const;
+    int getMissedRunCount() const;
+    int getQueueDepth() const;
+    int getActiveWorkerCount() const;
+    int getNotificationCount() const;
     QDateTime getLastExecutionTime() const;
     std::chrono::milliseconds getAverageExecutionTime() const;
     std::map<std::string, int> getQueryExecutionCounts() const;
 
+    // Latency percentiles by run key, and engine-wide: execution over every
+    // query, how late the scheduler fired runs, and how long they then waited
+    // for a worker
+    std::map<std::string, QueryLatencyStats> getQueryLatencies() const;
+    LatencySummary getOverallLatency() const;
+    LatencySummary getSchedulerLag() const;
+    LatencySummary getQueueWait() const;
+    int getMaxQueueDepth() const;
+    void resetLatencyStatistics();
+
+    // Table shared with AlertSystem for alert titles and query sources
+    std::shared_ptr<StringInterner> stringTable() const { return strings_; }
+
 public slots:
     void executeAllQueries();
     void executeQuery(const std::string& queryId);
@@ -98,26 +214,98 @@ signals:
     void monitoringStarted();
     void monitoringStopped();
     void queryError(const std::string& queryId, const std::string& error);
+    void queriesReloaded(int added, int changed, int removed);
+    void tickOverrun(int pendingQueries);
 
 private slots:
     void onTimerTimeout();
     void onQueryCompleted(const QueryResult& result);
+    void onNotification(const std::string& target, const std::string& channel,
+                        const std::string& payload, int backendPid);
+    void onWatermarkTimer();
 
 private:
-    // Configuration parsing
-    bool parseConfigFile(const std::string& content);
-    AlertType parseAlertType(const std::string& typeStr) const;
-    std::string trimString(const std::string& str) const;
-
-    // Query execution
+    // Configuration parsing; static, so a reload parses off the engine's thread
+    static bool parseConfigFile(const std::string& content, std::map<std::string, QueryConfig>& queries);
+    void registerStatement(const QueryConfig& query);
+    void unregisterStatement(const std::string& queryId);
+
+    // Targets (callers hold queriesMutex_)
+    std::vector<std::string> targetsOf(const QueryConfig& query) const;
+    bool splitRunKey(const std::string& key, std::string& queryId, std::string& target) const;
+    bool anyTargetConnected() const;
+
+    // One listener connection per target with listen queries (callers hold queriesMutex_)
+    void syncListeners();
+    void stopListeners();
+
+    // Shared sources: the enabled rules of a source, all of them or only those
+    // whose interval has come round again on target (callers hold queriesMutex_)
+    static bool compileRule(QueryConfig& query, std::string& error);
+    std::vector<QueryConfig> rulesOf(const QueryConfig& source) const;
+
+    // The published query table. Changes build a new one and publish it under
+    // queriesMutex_; readers only load it.
+    QueryTable::Entry entryOf(QueryConfig query) const;
+    void publishQueries(std::shared_ptr<const QueryTable> queries);
+    std::vector<QueryConfig> rulesDue(const QueryConfig& source, const std::string& target,
+                                      QueryScheduler::Clock::time_point now);
+    static AlertType parseAlertType(const std::string& typeStr);
+    static std::string trimString(const std::string& str);
+    static bool isReadOnlySql(const std::string& sql);
+    static int parseDuration(const std::string& value, int defaultMs);
+
+    // Scheduling (callers hold queriesMutex_)
+    void scheduleQuery(const QueryConfig& query, QueryScheduler::Clock::time_point now);
+    void scheduleRun(const QueryConfig& query, const std::string& target, QueryScheduler::Clock::time_point now);
+    void unscheduleQuery(const std::string& queryId);
+    void rescheduleAll();
+    void armTimer();
+
+    // Swaps in a parsed query table, redoing only what differs (callers hold queriesMutex_)
+    struct QueryTableChanges {
+        int added = 0;
+        int changed = 0;
+        int removed = 0;
+    };
+    QueryTableChanges applyQueries(std::map<std::string, QueryConfig> queries);
+
+    // Back on the engine's thread with what the reload thread parsed
+    void finishReload(std::map<std::string, QueryConfig> queries, const std::string& error);
+    void waitForReload();
+
+    // Adaptive polling (callers hold queriesMutex_)
+    bool isAdaptive(const QueryConfig& query) const;
+    int baseInterval(const QueryConfig& query) const;
+    void adaptInterval(const std::string& key, const QueryResult& result, bool alerted);
+
+    // Query execution; one run is a query against one target
+    struct QueryRun {
+        QueryConfig query;
+        std::string target;
+        DatabaseManager* database;
+        std::vector<QueryConfig> rules;     // evaluated on the rows when query is a source
+    };
+    std::vector<QueryRun> runsOf(const QueryConfig& query) const;
+    void submitRuns(const std::vector<QueryRun>& runs);
+    void submitRun(const QueryRun& run);
+
+    // Overlap protection: at most one run per run key is queued or executing
+    std::shared_ptr<QueryLatency> latencyOf(const std::string& runKey);
+    bool markInFlight(const std::string& runKey);
+    void clearInFlight(const std::string& runKey);
+    void clearInFlight();
     QueryResult executeQueryInternal(const QueryConfig& query);
-    void processQueryResult(const QueryResult& result);
+    bool processQueryResult(const QueryConfig& query, const QueryResult& result);
     void generateAlerts(const QueryResult& result);
 
-    // Alert generation
-    void generateDataAlert(const QueryResult& result);
-    void generateErrorAlert(const QueryResult& result);
-    std::string formatAlertMessage(const QueryConfig& query, const pqxx::result& result);
+    // Alert generation; true when an alert was raised
+    bool generateDataAlert(const QueryConfig& query, const QueryResult& result);
+    bool generateErrorAlert(const QueryConfig& query, const QueryResult& result);
+    bool generateAggregateAlert(const QueryConfig& query, const QueryResult& result);
+    void generateNotificationAlert(const QueryConfig& query, const std::string& target,
+                                   const std::string& payload, int backendPid);
+    std::string formatAlertMessage(const QueryConfig& query, const ResultSummary& summary);
 
     // Thread safety
     void lockQueries();
@@ -126,30 +314,59 @@ private:
     // Members
     DatabaseManager* databaseManager_;
     AlertSystem* alertSystem_;
-    std::map<std::string, QueryConfig> queries_;
+    std::shared_ptr<StringInterner> strings_;
+    std::shared_ptr<const QueryTable> queries_;     // loaded and stored atomically
+    std::map<std::string, DatabaseManager*> targets_;
+    std::map<std::string, NotificationListener*> listeners_;
+    std::unique_ptr<WatermarkStore> watermarks_;
+    QTimer* watermarkTimer_;
     mutable QMutex queriesMutex_;
 
+    // Fingerprint of each adaptive run key's last result, guarded by queriesMutex_
+    std::map<std::string, uint64_t> lastFingerprints_;
+
+    // When each rule with its own interval last rode on a snapshot, by run key
+    std::map<std::string, std::chrono::steady_clock::time_point> ruleRuns_;
+
     QTimer* timer_;
+    QueryScheduler scheduler_;
     bool isMonitoring_;
     int interval_;
     int maxConcurrentQueries_;
+    int maxQueuedQueries_;
+    bool batchExecution_;
+    bool adaptiveScheduling_;
+    int adaptiveMaxInterval_;
+    QueryWorkerPool* workerPool_;
+    std::set<std::string> inFlight_;
+    mutable QMutex inFlightMutex_;
+
+    // The file reload parsing now, and the one asked for meanwhile
+    QThread* reloadThread_;
+    std::string pendingReload_;
 
     // Statistics
     int totalExecutions_;
     int totalFailures_;
+    int droppedExecutions_;
+    int skippedExecutions_;
+    int tickOverruns_;
+    int notificationsReceived_;
     QDateTime lastExecutionTime_;
     std::chrono::milliseconds totalExecutionTime_;
     std::map<std::string, int> queryExecutionCounts_;
+    std::map<std::string, std::shared_ptr<QueryLatency>> latencies_;
+    LatencyHistogram schedulerLag_;
     mutable QMutex statsMutex_;
 
     // Duplicate detection cache
     struct QueryHash {
-        std::string queryId;
-        std::string dataHash;
+        std::string runKey;
+        uint64_t fingerprint;
         QDateTime timestamp;
 
-        QueryHash(const std::string& id, const std::string& hash)
-            : queryId(id), dataHash(hash), timestamp(QDateTime::currentDateTime()) {}
+        QueryHash(const std::string& key, uint64_t fingerprint)
+            : runKey(key), fingerprint(fingerprint), timestamp(QDateTime::currentDateTime()) {}
     };
 
     std::vector<QueryHash> queryHistory_;
@@ -157,34 +374,85 @@ private:
     static const int MAX_QUERY_HISTORY = 100;
 
     // Helper methods
-    std::string calculateResultHash(const pqxx::result& result) const;
-    bool isRecentDuplicate(const std::string& queryId, const std::string& dataHash, int timeWindowSeconds = 5) const;
+    bool isRecentDuplicate(const std::string& runKey, uint64_t fingerprint, int timeWindowSeconds = 5) const;
     void cleanupQueryHistory();
     void updateStatistics(const QueryResult& result);
 };
 
-// Query worker for async execution
+// Long-lived query worker, one per pool thread; each job names its database
 class QueryWorker : public QObject {
     Q_OBJECT
 
 public:
-    explicit QueryWorker(DatabaseManager* dbManager, QObject *parent = nullptr);
+    explicit QueryWorker(QueryWorkerPool* pool, QObject *parent = nullptr);
     ~QueryWorker();
 
-    void setQuery(const QueryConfig& query);
-    void stop();
+    // rows, when given, receives the rows so the caller can go on reading them on this thread
+    QueryResult execute(DatabaseManager* database, const QueryConfig& query,
+                        const std::optional<std::string>& watermark = std::nullopt,
+                        pqxx::result* rows = nullptr);
+    std::vector<QueryResult> executeBatch(DatabaseManager* database, const std::vector<QueryConfig>& queries);
+    std::vector<QueryResult> executeSource(DatabaseManager* database, const QueryConfig& source,
+                                           const std::vector<QueryConfig>& rules,
+                                           const std::optional<std::string>& watermark);
 
 public slots:
-    void execute();
+    void run();
 
 signals:
     void completed(const QueryResult& result);
 
 private:
-    DatabaseManager* databaseManager_;
-    QueryConfig query_;
-    bool shouldStop_;
-    QMutex queryMutex_;
+    QueryWorkerPool* pool_;
+};
+
+// Fixed-size pool of query workers fed from a bounded queue
+class QueryWorkerPool : public QObject {
+    Q_OBJECT
+
+public:
+    explicit QueryWorkerPool(QObject *parent = nullptr);
+    ~QueryWorkerPool();
+
+    // Pool lifecycle
+    void start(int workerCount);
+    void stop();
+    bool isRunning() const;
+
+    // Returns false when the queue is full (backpressure)
+    bool submit(QueryJob job);
+
+    // Called from worker threads
+    bool takeNext(QueryJob& job);
+    void markFinished();
+
+    // Configuration and status
+    void setMaxQueueSize(int maxQueueSize);
+    int getMaxQueueSize() const;
+    int getWorkerCount() const;
+    int getQueueDepth() const;
+    int getActiveCount() const;
+
+    // Time jobs spent queued, and the deepest the queue has been since the last reset
+    LatencySummary getQueueWait() const;
+    int getMaxQueueDepth() const;
+    void resetStatistics();
+
+signals:
+    void completed(const QueryResult& result);
+
+private:
+    std::vector<QThread*> threads_;
+    std::vector<QueryWorker*> workers_;
+
+    std::deque<QueryJob> pending_;
+    mutable QMutex queueMutex_;
+    QWaitCondition queueNotEmpty_;
+    int maxQueueSize_;
+    int activeCount_;
+    int maxQueueDepth_;
+    bool stopping_;
+    LatencyHistogram queueWait_;
 };
 
 #endif // QUERYENGINE_H
\ No newline at end of file
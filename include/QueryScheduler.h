@@ -0,0 +1,76 @@
+#ifndef QUERYSCHEDULER_H
+#define QUERYSCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <chrono>
+#include <random>
+#include <cstdint>
+
+// Per-query schedule; a negative phase is derived from the query id
+struct QuerySchedule {
+    std::chrono::milliseconds interval{1000};
+    std::chrono::milliseconds jitter{0};
+    std::chrono::milliseconds phase{-1};
+};
+
+// Min-heap of next due times, one entry per scheduled query.
+// Not thread-safe; callers serialize access.
+class QueryScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    QueryScheduler();
+
+    // Scheduling; (re)scheduling a query replaces its previous entry
+    void schedule(const std::string& queryId, const QuerySchedule& schedule, Clock::time_point now);
+    void unschedule(const std::string& queryId);
+    void clear();
+    bool isScheduled(const std::string& queryId) const;
+
+    // Changes a scheduled query's interval; the queued run moves to one new interval
+    // after the previous slot, or to now if that has passed. False when the query
+    // is not scheduled.
+    bool setInterval(const std::string& queryId, std::chrono::milliseconds interval, Clock::time_point now);
+    std::chrono::milliseconds getInterval(const std::string& queryId) const;
+
+    // Pops every query due at or before now and queues its next run;
+    // lateness, when given, receives how far past its due time each one was
+    std::vector<std::string> takeDue(Clock::time_point now, std::vector<Clock::duration>* lateness = nullptr);
+
+    // Earliest due time, or Clock::time_point::max() when nothing is scheduled
+    Clock::time_point nextDueTime() const;
+
+    // Status
+    size_t size() const;
+    int getMissedRunCount() const;
+
+private:
+    struct Entry {
+        Clock::time_point due;
+        std::string queryId;
+        uint64_t generation;
+
+        bool operator>(const Entry& other) const { return due > other.due; }
+    };
+
+    struct State {
+        QuerySchedule schedule;
+        Clock::time_point slot;     // nominal start of the current period
+        uint64_t generation;
+    };
+
+    void push(const std::string& queryId, State& state);
+    void dropStaleEntries();
+    std::chrono::milliseconds derivePhase(const std::string& queryId, std::chrono::milliseconds interval) const;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap_;
+    std::map<std::string, State> states_;
+    uint64_t nextGeneration_;
+    int missedRuns_;
+    std::mt19937 rng_;
+};
+
+#endif // QUERYSCHEDULER_H
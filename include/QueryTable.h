@@ -0,0 +1,63 @@
+#ifndef QUERYTABLE_H
+#define QUERYTABLE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "QueryConfig.h"
+
+// The engine's queries as one immutable value. A change builds a new table
+// and publishes it whole, so a reader holding a table is never disturbed by
+// one and never takes a lock; the queries it returns stay valid for as long
+// as the reader keeps the table (or the entry) alive.
+//
+// Lookups by handle probe a flat open-addressed index; lookups by id binary
+// search the entries, which are kept in id order. Each source's enabled
+// rules are listed once, when the table is built.
+class QueryTable {
+public:
+    using Entry = std::shared_ptr<const QueryConfig>;
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    QueryTable() = default;
+
+    // Entries with distinct ids and handles; a later duplicate id replaces an earlier one
+    explicit QueryTable(std::vector<Entry> entries);
+
+    // Null when the table has no such query
+    const QueryConfig* find(QueryHandle handle) const;
+    const QueryConfig* find(const std::string& id) const;
+    Entry entry(const std::string& id) const;
+
+    // Enabled rules whose source= names source, in id order
+    const std::vector<Entry>& rulesOf(const QueryConfig& source) const;
+
+    // A copy of this table with query added or replaced, or with id removed;
+    // every other entry is shared with this table, not copied
+    std::shared_ptr<const QueryTable> with(Entry query) const;
+    std::shared_ptr<const QueryTable> without(const std::string& id) const;
+
+    // In id order
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+private:
+    struct Slot {
+        QueryHandle handle = InvalidQueryHandle;
+        uint32_t index = 0;     // into entries_
+    };
+
+    size_t indexOf(const std::string& id) const;    // entries_.size() when absent
+    size_t indexOf(QueryHandle handle) const;
+    size_t slotOf(QueryHandle handle) const;
+
+    std::vector<Entry> entries_;
+    std::vector<Slot> slots_;       // power-of-two size, at most half full
+    std::vector<std::vector<Entry>> rules_;   // parallel to entries_; empty unless a source
+};
+
+#endif // QUERYTABLE_H
@@ -0,0 +1,28 @@
+#ifndef RESULTSUMMARY_H
+#define RESULTSUMMARY_H
+
+#include <string>
+#include <optional>
+#include <cstdint>
+#include <pqxx/pqxx>
+
+// What alert generation reads from a query's rows. Workers take it from the
+// pqxx::result they received, so the rows themselves never leave the worker
+// thread; only this is moved across with the QueryResult.
+struct ResultSummary {
+    uint64_t rows = 0;
+    uint64_t columns = 0;
+    uint64_t fingerprint = 0;               // Fingerprint::ofResult of the rows
+
+    std::optional<std::string> firstValue;  // first column of the first row; unset when NULL
+    std::optional<int> firstCount;          // firstValue read as an integer, as std::stoi would
+
+    bool empty() const { return rows == 0; }
+
+    static ResultSummary of(const pqxx::result& result);
+
+    // Leading integer of value with std::stoi's rules, without the exceptions
+    static std::optional<int> parseCount(const std::string& value);
+};
+
+#endif // RESULTSUMMARY_H
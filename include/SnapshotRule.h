@@ -0,0 +1,103 @@
+#ifndef SNAPSHOTRULE_H
+#define SNAPSHOTRULE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <pqxx/pqxx>
+
+#include "ResultSummary.h"
+
+// A rule evaluated on the client against the rows of a shared source
+// snapshot, in place of a query of its own. It keeps the rows that match
+// its filter and summarises them as the query would have:
+//
+//   where=state = 'active' AND query_seconds > 30 AND query NOT ILIKE '%vacuum%'
+//   message=Long running query from {client_addr}: {query_seconds} s
+//   aggregate=count
+//
+// The filter is compiled once into a postfix program; evaluating it
+// converts nothing but the cells it compares, never throws, and keeps no
+// state, so one compiled rule is shared by every worker.
+class SnapshotRule {
+public:
+    // Null on a malformed rule, with error set
+    static std::shared_ptr<const SnapshotRule> compile(const std::string& where, const std::string& message,
+                                                       const std::string& aggregate, std::string& error);
+
+    // Splits count, count(*) or function(column) and checks the column is a
+    // plain or double-quoted name; the column keeps its quotes
+    static bool parseAggregate(const std::string& spec, std::string& function, std::string& column,
+                               std::string& error);
+
+    // The summary of the snapshot's matching rows: the first one's message
+    // (or first column) as firstValue, or the aggregate as a single row.
+    // False, with error set, when the snapshot lacks a column the rule names.
+    bool evaluate(const pqxx::result& snapshot, ResultSummary& summary, std::string& error) const;
+
+    // Columns the rule reads, in order of first use
+    const std::vector<std::string>& columns() const { return columns_; }
+
+private:
+    enum class Op : uint8_t { Compare, IsNull, Like, And, Or, Not };
+    enum class Comparison : uint8_t { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+    // A column (index into columns_) or a literal; numeric literals are parsed once here
+    struct Operand {
+        int column = -1;
+        std::string text;
+        double number = 0.0;
+        bool numeric = false;
+    };
+
+    // LIKE patterns, split into literal bytes, '_' and '%'
+    struct PatternToken {
+        enum Kind : uint8_t { Byte, AnyByte, AnyRun } kind;
+        char byte;
+    };
+
+    struct Instruction {
+        Op op;
+        Comparison comparison = Comparison::Equal;
+        bool caseInsensitive = false;
+        Operand left;
+        Operand right;
+        std::vector<PatternToken> pattern;
+    };
+
+    // message= pieces: literal text, or the column at index column
+    struct Segment {
+        std::string text;
+        int column = -1;
+    };
+
+    enum class Aggregate : uint8_t { None, Count, CountColumn, Sum, Min, Max, Avg };
+
+    class Parser;
+    friend class Parser;
+
+    SnapshotRule() = default;
+
+    int columnIndex(const std::string& name);
+    bool compileMessage(const std::string& message, std::string& error);
+
+    bool matches(const pqxx::row& row, const std::vector<pqxx::row::size_type>& columns,
+                 std::vector<char>& stack) const;
+    bool compare(const Instruction& instruction, const pqxx::row& row,
+                 const std::vector<pqxx::row::size_type>& columns) const;
+    static bool like(const char* data, size_t length, const std::vector<PatternToken>& pattern,
+                     bool caseInsensitive);
+    std::string render(const pqxx::row& row, const std::vector<pqxx::row::size_type>& columns) const;
+    void aggregateOver(const pqxx::result& snapshot, const std::vector<pqxx::result::size_type>& rows,
+                       const std::vector<pqxx::row::size_type>& columns, ResultSummary& summary) const;
+
+    std::vector<std::string> columns_;
+    std::vector<Instruction> program_;
+    size_t stackDepth_ = 0;
+    std::vector<Segment> message_;
+    Aggregate aggregate_ = Aggregate::None;
+    int aggregateColumn_ = -1;
+};
+
+#endif // SNAPSHOTRULE_H
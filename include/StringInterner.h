@@ -0,0 +1,94 @@
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+
+class StringInterner;
+
+// Compact handle to an interned string. Handles from the same table compare
+// by pointer; the table must outlive every handle taken from it.
+class InternedString {
+public:
+    InternedString() = default;
+
+    uint32_t id() const { return id_; }
+    const StringInterner* table() const { return table_; }
+    bool isNull() const { return value_ == nullptr; }
+
+    std::string_view view() const { return value_ ? std::string_view(*value_) : std::string_view(); }
+    const std::string& str() const { return value_ ? *value_ : emptyString(); }
+    const char* c_str() const { return str().c_str(); }
+    const char* data() const { return str().data(); }
+    size_t size() const { return value_ ? value_->size() : 0; }
+    bool empty() const { return size() == 0; }
+
+    // Identity of the string's text, usable as a cache key
+    const void* key() const { return value_; }
+
+    friend bool operator==(const InternedString& a, const InternedString& b) {
+        if (a.table_ == b.table_ && a.table_) {
+            return a.value_ == b.value_;
+        }
+        return a.view() == b.view();
+    }
+    friend bool operator!=(const InternedString& a, const InternedString& b) { return !(a == b); }
+    friend bool operator==(const InternedString& a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(const InternedString& a, std::string_view b) { return a.view() != b; }
+
+private:
+    friend class StringInterner;
+
+    InternedString(const std::string* value, uint32_t id, const StringInterner* table)
+        : value_(value), id_(id), table_(table) {}
+
+    static const std::string& emptyString() {
+        static const std::string empty;
+        return empty;
+    }
+
+    const std::string* value_ = nullptr;
+    uint32_t id_ = 0xFFFFFFFFu;
+    const StringInterner* table_ = nullptr;
+};
+
+// Append-only table of distinct strings. Ids and views stay valid for the
+// interner's lifetime; nothing is ever removed.
+class StringInterner {
+public:
+    static const uint32_t InvalidId = 0xFFFFFFFFu;
+
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Returns the existing id for value or assigns a new one
+    uint32_t intern(std::string_view value);
+
+    // Returns InvalidId when value has never been interned
+    uint32_t find(std::string_view value) const;
+
+    // Interns value and returns a handle to it
+    InternedString handle(std::string_view value);
+
+    // Handle for an id from this table; null for unknown ids
+    InternedString handleOf(uint32_t id) const;
+
+    // Returns a handle from this table, re-interning only if it came from another
+    InternedString adopt(const InternedString& value);
+
+    std::string_view view(uint32_t id) const;
+    size_t size() const;
+
+private:
+    // std::deque never relocates elements, so views into them stay valid
+    std::deque<std::string> strings_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+    mutable std::shared_mutex mutex_;
+};
+
+#endif // STRINGINTERNER_H
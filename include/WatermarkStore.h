@@ -0,0 +1,48 @@
+#ifndef WATERMARKSTORE_H
+#define WATERMARKSTORE_H
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// Last cursor value each watermark query has seen, keyed by run key and kept
+// in a small text file so incremental queries resume where they stopped.
+// A value is only returned for the cursor column it was recorded for, so
+// changing a query's cursor starts it afresh. Saves replace the file
+// atomically; a crash loses at most the values since the last save.
+class WatermarkStore {
+public:
+    explicit WatermarkStore(const std::string& filePath = "");
+
+    // A missing file is an empty store, not an error
+    bool load();
+    bool save();   // writes only when something changed since the last save
+
+    std::optional<std::string> get(const std::string& runKey, const std::string& column) const;
+    void set(const std::string& runKey, const std::string& column, const std::string& value);
+    void remove(const std::string& runKey);
+
+    bool isDirty() const;
+    size_t size() const;
+    const std::string& filePath() const { return filePath_; }
+    std::string getLastError() const;
+
+    // One line of the file: key, column and value, tab-separated and escaped
+    static std::string formatLine(const std::string& runKey, const std::string& column, const std::string& value);
+    static bool parseLine(const std::string& line, std::string& runKey, std::string& column, std::string& value);
+
+private:
+    struct Entry {
+        std::string column;
+        std::string value;
+    };
+
+    std::string filePath_;
+    std::map<std::string, Entry> entries_;
+    bool dirty_;
+    std::string lastError_;
+    mutable std::mutex mutex_;
+};
+
+#endif // WATERMARKSTORE_H
@@ -0,0 +1,258 @@
+#include "AlertDispatcher.h"
+#include "AlertSystem.h"
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+
+// One sink's queue and the thread that drains it
+struct AlertDispatcher::Lane {
+    std::unique_ptr<AlertSink> sink;
+    AlertSinkOptions options;
+
+    std::deque<SinkAlert> queue;
+    bool stopping = false;
+    std::chrono::steady_clock::time_point drainDeadline;
+    std::string lastError;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+
+    QThread* thread = nullptr;
+    std::atomic<bool> open{false};
+    std::atomic<int> delivered{0};
+    std::atomic<int> dropped{0};
+    std::atomic<int> failures{0};
+};
+
+namespace {
+std::chrono::milliseconds retryDelay(const AlertSinkOptions& options, int attempts) {
+    int64_t delay = static_cast<int64_t>(std::max(1, options.retryInitialMs)) << std::min(attempts - 1, 20);
+    return std::chrono::milliseconds(std::min<int64_t>(delay, std::max(options.retryInitialMs, options.retryMaxMs)));
+}
+}
+
+AlertDispatcher::AlertDispatcher()
+    : running_(false)
+{
+    for (auto& count : published_) {
+        count = 0;
+    }
+}
+
+AlertDispatcher::~AlertDispatcher() {
+    stop(0);
+}
+
+void AlertDispatcher::addSink(std::unique_ptr<AlertSink> sink, const AlertSinkOptions& options) {
+    if (running_) {
+        qWarning() << "Alert sink added after the dispatcher started:" << sink->name().c_str();
+        return;
+    }
+
+    auto lane = std::make_unique<Lane>();
+    lane->sink = std::move(sink);
+    lane->options = options;
+    lane->options.queueCapacity = std::max<size_t>(1, options.queueCapacity);
+    lane->options.batchSize = std::max<size_t>(1, options.batchSize);
+    lanes_.push_back(std::move(lane));
+}
+
+void AlertDispatcher::start() {
+    if (running_ || lanes_.empty()) {
+        return;
+    }
+
+    for (auto& lane : lanes_) {
+        Lane* running = lane.get();
+        running->stopping = false;
+        running->thread = QThread::create([this, running]() {
+            runLane(*running);
+        });
+        running->thread->setObjectName(QString::fromStdString("AlertSink:" + running->sink->name()));
+        running->thread->start();
+    }
+    running_ = true;
+}
+
+void AlertDispatcher::stop(int drainTimeoutMs) {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(0, drainTimeoutMs));
+    for (auto& lane : lanes_) {
+        {
+            std::lock_guard<std::mutex> lock(lane->mutex);
+            lane->stopping = true;
+            lane->drainDeadline = deadline;
+        }
+        lane->changed.notify_all();
+    }
+
+    // Every sink drains against the same deadline, not one after another
+    for (auto& lane : lanes_) {
+        lane->thread->wait();
+        delete lane->thread;
+        lane->thread = nullptr;
+    }
+}
+
+bool AlertDispatcher::publish(const Alert& alert, int64_t timestampMs) {
+    if (!running_) {
+        return false;
+    }
+
+    SinkAlert copy;
+    copy.id = alert.id;
+    copy.type = alert.type;
+    copy.timestampMs = timestampMs;
+    copy.title = alert.title.str();
+    copy.querySource = alert.querySource.str();
+    copy.message = alert.message;
+
+    int type = static_cast<int>(alert.type);
+    if (type >= 0 && type < 3) {
+        published_[type]++;
+    }
+
+    bool queuedForAll = true;
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        Lane& lane = *lanes_[i];
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(lane.mutex);
+            if (lane.queue.size() >= lane.options.queueCapacity) {
+                lane.dropped++;
+                queuedForAll = false;
+                continue;
+            }
+            if (i + 1 == lanes_.size()) {
+                lane.queue.push_back(std::move(copy));
+            } else {
+                lane.queue.push_back(copy);
+            }
+
+            // The first alert starts the batch delay; a full batch ends it
+            wake = lane.queue.size() == 1 || lane.queue.size() >= lane.options.batchSize;
+        }
+        if (wake) {
+            lane.changed.notify_one();
+        }
+    }
+    return queuedForAll;
+}
+
+int AlertDispatcher::getPublishedCount(AlertType type) const {
+    int index = static_cast<int>(type);
+    return index >= 0 && index < 3 ? published_[index].load() : 0;
+}
+
+std::vector<AlertSinkStats> AlertDispatcher::getStats() const {
+    std::vector<AlertSinkStats> stats;
+    stats.reserve(lanes_.size());
+    for (const auto& lane : lanes_) {
+        AlertSinkStats sink;
+        sink.name = lane->sink->name();
+        sink.open = lane->open;
+        sink.delivered = lane->delivered;
+        sink.dropped = lane->dropped;
+        sink.failures = lane->failures;
+        {
+            std::lock_guard<std::mutex> lock(lane->mutex);
+            sink.pending = static_cast<int>(lane->queue.size());
+            sink.lastError = lane->lastError;
+        }
+        stats.push_back(sink);
+    }
+    return stats;
+}
+
+void AlertDispatcher::runLane(Lane& lane) {
+    const AlertSinkOptions& options = lane.options;
+    const std::string name = lane.sink->name();
+    std::vector<SinkAlert> batch;
+    int attempts = 0;   // failed tries at the batch in hand; zero exactly when there is none
+
+    auto fail = [&lane, &name](const std::string& error) {
+        lane.failures++;
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        if (lane.lastError != error) {
+            qWarning() << "Alert sink" << name.c_str() << "failed:" << error.c_str();
+        }
+        lane.lastError = error;
+    };
+
+    std::string error;
+    bool opened = lane.sink->open(error);
+    if (!opened) {
+        fail(error);
+    }
+    lane.open = opened;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            if (attempts > 0) {
+                lane.changed.wait_for(lock, retryDelay(options, attempts), [&lane] { return lane.stopping; });
+            } else {
+                lane.changed.wait(lock, [&lane] { return lane.stopping || !lane.queue.empty(); });
+                lane.changed.wait_for(lock, std::chrono::milliseconds(options.batchDelayMs), [&lane, &options] {
+                    return lane.stopping || lane.queue.size() >= options.batchSize;
+                });
+            }
+
+            if (lane.stopping && (attempts > 0 || std::chrono::steady_clock::now() >= lane.drainDeadline)) {
+                int left = static_cast<int>(lane.queue.size() + batch.size());
+                if (left > 0) {
+                    lane.dropped += left;
+                    qWarning() << "Alert sink" << name.c_str() << "stopped with" << left << "alerts undelivered";
+                }
+                lane.queue.clear();
+                break;
+            }
+
+            if (batch.empty()) {
+                size_t count = std::min(options.batchSize, lane.queue.size());
+                batch.assign(std::make_move_iterator(lane.queue.begin()),
+                             std::make_move_iterator(lane.queue.begin() + count));
+                lane.queue.erase(lane.queue.begin(), lane.queue.begin() + count);
+            }
+        }
+
+        if (batch.empty()) {
+            break;   // stopping, with nothing left
+        }
+
+        error.clear();
+        if (!opened) {
+            opened = lane.sink->open(error);
+            lane.open = opened;
+        }
+
+        AlertSink::Delivery delivery = opened ? lane.sink->deliver(batch, error) : AlertSink::Delivery::Retry;
+        if (delivery == AlertSink::Delivery::Delivered) {
+            lane.delivered += static_cast<int>(batch.size());
+            batch.clear();
+            attempts = 0;
+            continue;
+        }
+
+        fail(error);
+        attempts++;
+        if (delivery == AlertSink::Delivery::Rejected || (options.maxAttempts > 0 && attempts >= options.maxAttempts)) {
+            lane.dropped += static_cast<int>(batch.size());
+            batch.clear();
+            attempts = 0;
+        }
+    }
+
+    if (opened) {
+        lane.sink->close();
+    }
+    lane.open = false;
+}
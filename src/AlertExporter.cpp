@@ -0,0 +1,580 @@
+#include "AlertExporter.h"
+#include "AlertSystem.h"
+#include "AlertJournal.h"
+#include "AlertSearchIndex.h"
+#include <QFile>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+
+// Columnar layout, in host byte order:
+//   file:    "PGMCOL1\0"  group*  footer  u64 footerOffset  "PGMCOL1\0"
+//   group:   u32 rows  i64 timestampMs[rows]  u64 id[rows]  u8 type[rows]
+//            dict(title)  dict(querySource)  strings(message)  strings(rawResult)
+//   strings: u32 offsets[count + 1]  bytes
+//   dict:    u32 count  strings(entries)  u32 code[rows]
+//   footer:  u32 version  u64 rows  u32 groups  { u64 offset  u32 rows  i64 minTs  i64 maxTs }[groups]
+// Journal exports use the journal sequence as the id.
+
+namespace {
+const size_t kChunkRows = 1024;
+const size_t kFlushBytes = 1024 * 1024;
+const size_t kGroupRows = 4096;
+const size_t kGroupBytes = 64 * 1024 * 1024;
+const char kColumnarMagic[8] = {'P', 'G', 'M', 'C', 'O', 'L', '1', '\0'};
+const int kProgressIntervalMs = 100;
+
+// One alert from either source; the views are valid until the next row
+struct ExportRow {
+    uint64_t id = 0;
+    int64_t timestampMs = 0;
+    AlertType type = AlertType::INFO;
+    std::string_view title;
+    std::string_view querySource;
+    std::string_view message;
+    std::string_view rawResult;
+};
+
+// ISO 8601 in UTC with milliseconds, without going through QDateTime per row
+void appendTimestamp(std::string& out, int64_t timestampMs) {
+    int64_t seconds = timestampMs / 1000;
+    int millis = static_cast<int>(timestampMs % 1000);
+    if (millis < 0) {
+        millis += 1000;
+        seconds--;
+    }
+    int64_t days = seconds / 86400;
+    int64_t secondOfDay = seconds % 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        days--;
+    }
+
+    // Days since the epoch to a civil date
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    int day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    int month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%04lld-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                               static_cast<long long>(year), month, day,
+                               static_cast<int>(secondOfDay / 3600),
+                               static_cast<int>(secondOfDay / 60 % 60),
+                               static_cast<int>(secondOfDay % 60), millis);
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+class ExportWriter {
+public:
+    explicit ExportWriter(QFile& file) : file_(file), failed_(false) {}
+    virtual ~ExportWriter() = default;
+
+    virtual void begin() {}
+    virtual void add(const ExportRow& row) = 0;
+    virtual void finish() {}
+
+    // Writes out the buffer once it is large enough, or always when forced
+    bool flush(bool force = false) {
+        if (failed_ || buffer_.empty() || (!force && buffer_.size() < kFlushBytes)) {
+            return !failed_;
+        }
+        qint64 length = static_cast<qint64>(buffer_.size());
+        failed_ = file_.write(buffer_.data(), length) != length;
+        written_ += buffer_.size();
+        buffer_.clear();
+        return !failed_;
+    }
+
+    bool failed() const { return failed_; }
+
+protected:
+    uint64_t position() const { return written_ + buffer_.size(); }
+
+    template <typename T>
+    void appendValue(T value) {
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    QFile& file_;
+    std::string buffer_;
+    uint64_t written_ = 0;
+    bool failed_;
+};
+
+class CsvWriter : public ExportWriter {
+public:
+    using ExportWriter::ExportWriter;
+
+    void begin() override {
+        buffer_ += "id,timestamp,type,title,query_source,message,raw_result\r\n";
+    }
+
+    void add(const ExportRow& row) override {
+        buffer_ += std::to_string(row.id);
+        buffer_ += ',';
+        appendTimestamp(buffer_, row.timestampMs);
+        buffer_ += ',';
+        buffer_ += Alert::typeToString(row.type);
+        buffer_ += ',';
+        appendField(row.title);
+        buffer_ += ',';
+        appendField(row.querySource);
+        buffer_ += ',';
+        appendField(row.message);
+        buffer_ += ',';
+        appendField(row.rawResult);
+        buffer_ += "\r\n";
+    }
+
+private:
+    // RFC 4180: quote fields holding separators, quotes or line breaks
+    void appendField(std::string_view value) {
+        if (value.find_first_of(",\"\r\n") == std::string_view::npos) {
+            buffer_ += value;
+            return;
+        }
+        buffer_ += '"';
+        for (char c : value) {
+            if (c == '"') {
+                buffer_ += '"';
+            }
+            buffer_ += c;
+        }
+        buffer_ += '"';
+    }
+};
+
+void appendJsonString(std::string& out, std::string_view value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void appendJsonLine(std::string& out, const ExportRow& row) {
+    out += "{\"id\":";
+    out += std::to_string(row.id);
+    out += ",\"timestamp\":\"";
+    appendTimestamp(out, row.timestampMs);
+    out += "\",\"timestamp_ms\":";
+    out += std::to_string(row.timestampMs);
+    out += ",\"type\":\"";
+    out += Alert::typeToString(row.type);
+    out += "\",\"title\":";
+    appendJsonString(out, row.title);
+    out += ",\"query_source\":";
+    appendJsonString(out, row.querySource);
+    out += ",\"message\":";
+    appendJsonString(out, row.message);
+    out += ",\"raw_result\":";
+    appendJsonString(out, row.rawResult);
+    out += "}\n";
+}
+
+class JsonLinesWriter : public ExportWriter {
+public:
+    using ExportWriter::ExportWriter;
+
+    void add(const ExportRow& row) override {
+        appendJsonLine(buffer_, row);
+    }
+};
+
+class ColumnarWriter : public ExportWriter {
+public:
+    using ExportWriter::ExportWriter;
+
+    void begin() override {
+        buffer_.append(kColumnarMagic, sizeof(kColumnarMagic));
+    }
+
+    void add(const ExportRow& row) override {
+        timestamps_.push_back(row.timestampMs);
+        ids_.push_back(row.id);
+        types_.push_back(static_cast<uint8_t>(row.type));
+        titleCodes_.push_back(titles_.code(row.title));
+        sourceCodes_.push_back(sources_.code(row.querySource));
+        messages_.add(row.message);
+        rawResults_.add(row.rawResult);
+        groupBytes_ += row.message.size() + row.rawResult.size();
+
+        if (ids_.size() >= kGroupRows || groupBytes_ >= kGroupBytes) {
+            writeGroup();
+        }
+    }
+
+    void finish() override {
+        writeGroup();
+
+        uint64_t footerOffset = position();
+        appendValue<uint32_t>(1);
+        appendValue<uint64_t>(totalRows_);
+        appendValue<uint32_t>(static_cast<uint32_t>(groups_.size()));
+        for (const GroupInfo& group : groups_) {
+            appendValue<uint64_t>(group.offset);
+            appendValue<uint32_t>(group.rows);
+            appendValue<int64_t>(group.minTimestamp);
+            appendValue<int64_t>(group.maxTimestamp);
+        }
+        appendValue<uint64_t>(footerOffset);
+        buffer_.append(kColumnarMagic, sizeof(kColumnarMagic));
+    }
+
+private:
+    struct StringColumn {
+        std::vector<uint32_t> offsets{0};
+        std::string bytes;
+
+        void add(std::string_view value) {
+            bytes += value;
+            offsets.push_back(static_cast<uint32_t>(bytes.size()));
+        }
+        void clear() {
+            offsets.assign(1, 0);
+            bytes.clear();
+        }
+    };
+
+    struct DictColumn {
+        std::map<std::string, uint32_t, std::less<>> codes;
+        StringColumn entries;
+
+        uint32_t code(std::string_view value) {
+            auto it = codes.find(value);
+            if (it != codes.end()) {
+                return it->second;
+            }
+            uint32_t next = static_cast<uint32_t>(codes.size());
+            codes.emplace(std::string(value), next);
+            entries.add(value);
+            return next;
+        }
+        void clear() {
+            codes.clear();
+            entries.clear();
+        }
+    };
+
+    struct GroupInfo {
+        uint64_t offset;
+        uint32_t rows;
+        int64_t minTimestamp;
+        int64_t maxTimestamp;
+    };
+
+    template <typename T>
+    void appendArray(const std::vector<T>& values) {
+        buffer_.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void appendStrings(const StringColumn& column) {
+        appendArray(column.offsets);
+        buffer_ += column.bytes;
+    }
+
+    void appendDict(const DictColumn& column, const std::vector<uint32_t>& codes) {
+        appendValue<uint32_t>(static_cast<uint32_t>(column.codes.size()));
+        appendStrings(column.entries);
+        appendArray(codes);
+    }
+
+    void writeGroup() {
+        if (ids_.empty()) {
+            return;
+        }
+
+        GroupInfo info;
+        info.offset = position();
+        info.rows = static_cast<uint32_t>(ids_.size());
+        info.minTimestamp = *std::min_element(timestamps_.begin(), timestamps_.end());
+        info.maxTimestamp = *std::max_element(timestamps_.begin(), timestamps_.end());
+        groups_.push_back(info);
+        totalRows_ += info.rows;
+
+        appendValue<uint32_t>(info.rows);
+        appendArray(timestamps_);
+        appendArray(ids_);
+        appendArray(types_);
+        appendDict(titles_, titleCodes_);
+        appendDict(sources_, sourceCodes_);
+        appendStrings(messages_);
+        appendStrings(rawResults_);
+
+        timestamps_.clear();
+        ids_.clear();
+        types_.clear();
+        titleCodes_.clear();
+        sourceCodes_.clear();
+        titles_.clear();
+        sources_.clear();
+        messages_.clear();
+        rawResults_.clear();
+        groupBytes_ = 0;
+    }
+
+    std::vector<int64_t> timestamps_;
+    std::vector<uint64_t> ids_;
+    std::vector<uint8_t> types_;
+    std::vector<uint32_t> titleCodes_;
+    std::vector<uint32_t> sourceCodes_;
+    DictColumn titles_;
+    DictColumn sources_;
+    StringColumn messages_;
+    StringColumn rawResults_;
+    size_t groupBytes_ = 0;
+
+    std::vector<GroupInfo> groups_;
+    uint64_t totalRows_ = 0;
+};
+
+std::unique_ptr<ExportWriter> createWriter(ExportFormat format, QFile& file) {
+    switch (format) {
+        case ExportFormat::JSONLines:
+            return std::make_unique<JsonLinesWriter>(file);
+        case ExportFormat::Columnar:
+            return std::make_unique<ColumnarWriter>(file);
+        case ExportFormat::CSV:
+        default:
+            return std::make_unique<CsvWriter>(file);
+    }
+}
+}
+
+AlertExporter::AlertExporter(AlertSystem* alertSystem, QObject *parent)
+    : QObject(parent)
+    , alertSystem_(alertSystem)
+    , thread_(nullptr)
+    , cancelled_(false)
+{
+}
+
+AlertExporter::~AlertExporter() {
+    cancel();
+    wait();
+}
+
+bool AlertExporter::start(const ExportRequest& request) {
+    if (isRunning()) {
+        return false;
+    }
+    wait();
+
+    cancelled_ = false;
+    thread_ = QThread::create([this, request]() {
+        // Throttled: signals cross to the GUI thread, so not one per chunk
+        QElapsedTimer sinceProgress;
+        sinceProgress.start();
+        ExportResult result = run(alertSystem_, request, cancelled_,
+                                  [this, &sinceProgress](int64_t done, int64_t total) {
+            if (done == total || sinceProgress.elapsed() >= kProgressIntervalMs) {
+                sinceProgress.restart();
+                emit progress(done, total);
+            }
+        });
+        emit finished(result.exported, result.cancelled, result.error);
+    });
+    thread_->setObjectName("AlertExporter");
+    thread_->start();
+    return true;
+}
+
+void AlertExporter::cancel() {
+    cancelled_ = true;
+}
+
+bool AlertExporter::isRunning() const {
+    return thread_ && thread_->isRunning();
+}
+
+void AlertExporter::wait() {
+    if (thread_) {
+        thread_->wait();
+        delete thread_;
+        thread_ = nullptr;
+    }
+}
+
+ExportResult AlertExporter::run(AlertSystem* alertSystem, const ExportRequest& request,
+                                const std::atomic<bool>& cancelled, const ProgressCallback& progress) {
+    ExportResult result;
+    if (!alertSystem) {
+        result.error = "No alert system to export from";
+        return result;
+    }
+
+    AlertJournal* journal = request.source == ExportSource::Journal ? alertSystem->journal() : nullptr;
+    if (request.source == ExportSource::Journal && !journal) {
+        result.error = "The alert journal is disabled";
+        return result;
+    }
+
+    QFile file(request.filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        result.error = "Could not open " + request.filePath + " for writing";
+        return result;
+    }
+
+    std::unique_ptr<ExportWriter> writer = createWriter(request.format, file);
+    writer->begin();
+
+    const int64_t toMs = request.toMs > 0 ? request.toMs : std::numeric_limits<int64_t>::max();
+    auto accept = [&](AlertType type, int64_t timestampMs) {
+        return (request.typeMask & AlertSearchIndex::typeBit(type)) != 0 &&
+               timestampMs >= request.fromMs;
+    };
+
+    int64_t done = 0;
+
+    if (journal) {
+        uint64_t from = journal->findSequenceAt(request.fromMs);
+        uint64_t to = request.toMs > 0 ? journal->findSequenceAt(request.toMs) : journal->endSequence();
+        int64_t total = static_cast<int64_t>(to > from ? to - from : 0);
+
+        // Rows are formatted inside the visitor, but the file is written outside the journal's lock
+        ExportRow row;
+        for (uint64_t chunk = from; chunk < to && !cancelled && !writer->failed(); chunk += kChunkRows) {
+            uint64_t chunkEnd = std::min<uint64_t>(to, chunk + kChunkRows);
+            done += static_cast<int64_t>(journal->read(chunk, chunkEnd, [&](const JournalEntry& entry) {
+                if (accept(entry.type, entry.timestampMs) && entry.timestampMs < toMs) {
+                    row.id = entry.sequence;
+                    row.timestampMs = entry.timestampMs;
+                    row.type = entry.type;
+                    row.title = entry.title;
+                    row.querySource = entry.querySource;
+                    row.message = entry.message;
+                    row.rawResult = entry.rawResult;
+                    writer->add(row);
+                    result.exported++;
+                }
+                return true;
+            }));
+            writer->flush();
+            if (progress) {
+                progress(done, total);
+            }
+        }
+    } else {
+        // Held for the whole export so the payloads stay readable
+        AlertSnapshot view = alertSystem->snapshotSince(QDateTime::fromMSecsSinceEpoch(request.fromMs));
+        int64_t total = static_cast<int64_t>(view.size());
+
+        AlertRecord record;
+        ExportRow row;
+        bool reachedEnd = false;
+        for (uint64_t id = view.firstId(); id < view.endId() && !cancelled && !writer->failed() && !reachedEnd;) {
+            uint64_t chunkEnd = std::min<uint64_t>(view.endId(), id + kChunkRows);
+            for (; id < chunkEnd; ++id) {
+                done++;
+                if (!view.read(id, record)) {
+                    result.skipped++;
+                    continue;
+                }
+                if (record.timestampMs >= toMs) {
+                    reachedEnd = true;
+                    break;
+                }
+                if (!accept(record.type, record.timestampMs)) {
+                    continue;
+                }
+                row.id = record.id;
+                row.timestampMs = record.timestampMs;
+                row.type = record.type;
+                row.title = record.title.view();
+                row.querySource = record.querySource.view();
+                row.message = record.message;
+                row.rawResult = record.rawResult;
+                writer->add(row);
+                result.exported++;
+            }
+            writer->flush();
+            if (progress) {
+                progress(reachedEnd ? total : done, total);
+            }
+        }
+    }
+
+    if (!cancelled) {
+        writer->finish();
+        writer->flush(true);
+    }
+
+    if (cancelled || writer->failed() || !file.flush()) {
+        result.cancelled = cancelled;
+        if (!cancelled) {
+            result.error = "Write failed: " + file.errorString();
+        }
+        file.close();
+        file.remove();
+        return result;
+    }
+
+    file.close();
+    qDebug() << "Exported" << result.exported << "alerts to" << request.filePath;
+    return result;
+}
+
+QString AlertExporter::formatName(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::JSONLines:
+            return "JSON Lines";
+        case ExportFormat::Columnar:
+            return "Columnar";
+        case ExportFormat::CSV:
+        default:
+            return "CSV";
+    }
+}
+
+QString AlertExporter::fileExtension(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::JSONLines:
+            return "jsonl";
+        case ExportFormat::Columnar:
+            return "pgcol";
+        case ExportFormat::CSV:
+        default:
+            return "csv";
+    }
+}
+
+std::string AlertExporter::toJsonLine(const Alert& alert) {
+    ExportRow row;
+    row.id = static_cast<uint64_t>(alert.id);
+    row.timestampMs = alert.timestamp.toMSecsSinceEpoch();
+    row.type = alert.type;
+    row.title = alert.title.view();
+    row.querySource = alert.querySource.view();
+    row.message = alert.message;
+    row.rawResult = alert.rawResult;
+
+    std::string line;
+    appendJsonLine(line, row);
+    return line;
+}
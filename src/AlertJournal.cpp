@@ -0,0 +1,733 @@
+#include "AlertJournal.h"
+#include "AlertSystem.h"
+#include "Fingerprint.h"
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Segment file layout, in host byte order:
+//   header:  "PGMJRNL1" u64 firstSequence
+//   record:  u32 length  u32 checksum  u64 sequence  i64 timestampMs  u32 type
+//            u32 titleLength  u32 sourceLength  u32 messageLength  u32 rawLength
+//            title  source  message  rawResult
+// The checksum covers everything after itself. Segments are preallocated and
+// the unused tail is zero, so a zero length marks the end of the records.
+struct JournalSegment {
+    QString path;
+    uint64_t firstSequence = 0;
+    uint64_t endSequence = 0;
+    int64_t firstTimestamp = 0;
+    int64_t lastTimestamp = 0;
+    qint64 size = 0;                    // header plus complete records
+    QFile file;                         // read-only, owns the mapping
+    const uchar* data = nullptr;
+    qint64 mappedSize = 0;
+    std::vector<uint32_t> offsets;      // record start, indexed by sequence - firstSequence
+};
+
+namespace {
+const char kFileMagic[8] = {'P', 'G', 'M', 'J', 'R', 'N', 'L', '1'};
+const qint64 kFileHeaderSize = 16;
+const size_t kRecordHeaderSize = 44;
+const int64_t kMinSegmentBytes = 1024 * 1024;
+const int64_t kMaxSegmentBytes = 1024LL * 1024 * 1024;     // offsets are 32-bit
+const int64_t kRetentionCheckMs = 60 * 1000;
+const int64_t kMsPerDay = 24LL * 60 * 60 * 1000;
+
+inline uint32_t readU32(const uchar* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline uint64_t readU64(const uchar* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline void writeU32(char* p, uint32_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void writeU64(char* p, uint64_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+uint32_t checksumOf(const void* data, size_t length) {
+    Fingerprint hasher;
+    hasher.update(data, length);
+    return static_cast<uint32_t>(hasher.digest());
+}
+
+std::string encodeRecord(uint64_t sequence, const Alert& alert, int64_t timestampMs) {
+    uint32_t lengths[4] = {
+        static_cast<uint32_t>(alert.title.size()),
+        static_cast<uint32_t>(alert.querySource.size()),
+        static_cast<uint32_t>(alert.message.size()),
+        static_cast<uint32_t>(alert.rawResult.size())
+    };
+    size_t length = kRecordHeaderSize + lengths[0] + lengths[1] + lengths[2] + lengths[3];
+
+    std::string record(length, '\0');
+    char* out = &record[0];
+    writeU32(out, static_cast<uint32_t>(length));
+    writeU64(out + 8, sequence);
+    writeU64(out + 16, static_cast<uint64_t>(timestampMs));
+    writeU32(out + 24, static_cast<uint32_t>(alert.type));
+    for (int i = 0; i < 4; ++i) {
+        writeU32(out + 28 + i * 4, lengths[i]);
+    }
+
+    char* payload = out + kRecordHeaderSize;
+    std::memcpy(payload, alert.title.data(), lengths[0]);
+    payload += lengths[0];
+    std::memcpy(payload, alert.querySource.data(), lengths[1]);
+    payload += lengths[1];
+    std::memcpy(payload, alert.message.data(), lengths[2]);
+    payload += lengths[2];
+    std::memcpy(payload, alert.rawResult.data(), lengths[3]);
+
+    writeU32(out + 4, checksumOf(out + 8, length - 8));
+    return record;
+}
+
+QString segmentFileName(uint64_t firstSequence) {
+    return QString("alerts-%1.journal").arg(static_cast<qulonglong>(firstSequence), 16, 10, QChar('0'));
+}
+
+bool syncFile(QFile& file) {
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+bool mapSegment(JournalSegment& segment, qint64 length) {
+    if (segment.data) {
+        segment.file.unmap(const_cast<uchar*>(segment.data));
+        segment.data = nullptr;
+        segment.mappedSize = 0;
+    }
+    if (!segment.file.isOpen()) {
+        segment.file.setFileName(segment.path);
+        if (!segment.file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+    }
+    segment.data = segment.file.map(0, length);
+    segment.mappedSize = segment.data ? length : 0;
+    return segment.data != nullptr;
+}
+
+void unmapSegment(JournalSegment& segment) {
+    if (segment.data) {
+        segment.file.unmap(const_cast<uchar*>(segment.data));
+        segment.data = nullptr;
+        segment.mappedSize = 0;
+    }
+    segment.file.close();
+}
+
+// Walks the records of a mapped segment, stopping at the first torn or
+// corrupt one. Returns false if the file isn't a journal segment at all.
+bool scanSegment(JournalSegment& segment) {
+    const uchar* data = segment.data;
+    qint64 limit = segment.mappedSize;
+    if (limit < kFileHeaderSize || std::memcmp(data, kFileMagic, sizeof(kFileMagic)) != 0) {
+        return false;
+    }
+
+    segment.firstSequence = readU64(data + 8);
+    segment.endSequence = segment.firstSequence;
+    segment.offsets.clear();
+
+    qint64 offset = kFileHeaderSize;
+    while (offset + static_cast<qint64>(kRecordHeaderSize) <= limit) {
+        const uchar* record = data + offset;
+        uint32_t length = readU32(record);
+        if (length < kRecordHeaderSize || offset + length > limit) {
+            break;
+        }
+
+        uint64_t payload = 0;
+        for (int i = 0; i < 4; ++i) {
+            payload += readU32(record + 28 + i * 4);
+        }
+        if (kRecordHeaderSize + payload != length ||
+            readU64(record + 8) != segment.endSequence ||
+            readU32(record + 4) != checksumOf(record + 8, length - 8)) {
+            break;
+        }
+
+        int64_t timestampMs = static_cast<int64_t>(readU64(record + 16));
+        if (segment.offsets.empty()) {
+            segment.firstTimestamp = timestampMs;
+        }
+        segment.lastTimestamp = timestampMs;
+        segment.offsets.push_back(static_cast<uint32_t>(offset));
+        segment.endSequence++;
+        offset += length;
+    }
+
+    segment.size = offset;
+    return true;
+}
+}
+
+AlertJournal::AlertJournal(const AlertJournalOptions& options)
+    : options_(options)
+    , nextSequence_(1)
+    , flushRequested_(0)
+    , syncedSequence_(0)
+    , stopping_(false)
+    , writtenSequence_(0)
+    , open_(false)
+    , writtenCount_(0)
+    , droppedCount_(0)
+    , syncCount_(0)
+{
+    options_.segmentBytes = std::clamp(options_.segmentBytes, kMinSegmentBytes, kMaxSegmentBytes);
+    options_.syncIntervalMs = std::max(0, options_.syncIntervalMs);
+    options_.maxPendingAlerts = std::max<size_t>(1, options_.maxPendingAlerts);
+}
+
+AlertJournal::~AlertJournal() {
+    close();
+}
+
+bool AlertJournal::open() {
+    if (open_) {
+        return true;
+    }
+
+    QDir directory(QString::fromStdString(options_.directory));
+    if (!directory.exists() && !directory.mkpath(".")) {
+        setError("Cannot create journal directory: " + options_.directory);
+        qWarning() << "Alert journal disabled:" << getLastError().c_str();
+        return false;
+    }
+
+    // Map every existing segment; names sort by first sequence
+    QStringList names = directory.entryList(QStringList() << "alerts-*.journal", QDir::Files, QDir::Name);
+    {
+        std::unique_lock<std::shared_mutex> lock(segmentsMutex_);
+        segments_.clear();
+
+        for (const QString& name : names) {
+            auto segment = std::make_unique<JournalSegment>();
+            segment->path = directory.filePath(name);
+
+            QFile probe(segment->path);
+            qint64 fileSize = probe.size();
+            if (fileSize <= 0 || !mapSegment(*segment, fileSize) || !scanSegment(*segment)) {
+                qWarning() << "Skipping unreadable journal segment" << segment->path;
+                unmapSegment(*segment);
+                continue;
+            }
+
+            if (segment->offsets.empty() ||
+                (!segments_.empty() && segment->firstSequence < segments_.back()->endSequence)) {
+                unmapSegment(*segment);
+                QFile::remove(segment->path);
+                continue;
+            }
+
+            // The last segment of a previous run still has its preallocated tail
+            if (segment->size < fileSize) {
+                unmapSegment(*segment);
+                QFile::resize(segment->path, segment->size);
+                if (!mapSegment(*segment, segment->size)) {
+                    continue;
+                }
+            }
+            segments_.push_back(std::move(segment));
+        }
+
+        if (!segments_.empty()) {
+            nextSequence_ = segments_.back()->endSequence;
+        }
+    }
+
+    writtenSequence_ = nextSequence_ - 1;
+    syncedSequence_ = writtenSequence_;
+    flushRequested_ = writtenSequence_;
+
+    // Each run writes into a fresh segment
+    if (!startSegment(nextSequence_, 0)) {
+        qWarning() << "Alert journal disabled:" << getLastError().c_str();
+        return false;
+    }
+    applyRetention();
+
+    stopping_ = false;
+    open_ = true;
+    writer_ = std::thread(&AlertJournal::writerLoop, this);
+
+    qDebug() << "Alert journal opened in" << directory.absolutePath()
+             << "with" << getSegmentCount() << "segments, next sequence" << nextSequence_;
+    return true;
+}
+
+void AlertJournal::close() {
+    if (!open_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueChanged_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    open_ = false;
+    synced_.notify_all();
+
+    std::unique_lock<std::shared_mutex> lock(segmentsMutex_);
+    for (auto& segment : segments_) {
+        unmapSegment(*segment);
+    }
+    segments_.clear();
+}
+
+bool AlertJournal::isOpen() const {
+    return open_;
+}
+
+bool AlertJournal::append(const Alert& alert, int64_t timestampMs) {
+    if (!open_) {
+        return false;
+    }
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (pending_.size() >= options_.maxPendingAlerts) {
+            droppedCount_++;
+            return false;
+        }
+        wake = pending_.empty();
+        pending_.push_back(encodeRecord(nextSequence_++, alert, timestampMs));
+    }
+
+    // The writer drains everything queued since it last woke in one batch
+    if (wake) {
+        queueChanged_.notify_one();
+    }
+    return true;
+}
+
+void AlertJournal::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    uint64_t target = nextSequence_ - 1;
+    if (!open_ || syncedSequence_ >= target) {
+        return;
+    }
+
+    flushRequested_ = std::max(flushRequested_, target);
+    queueChanged_.notify_one();
+    synced_.wait(lock, [this, target] { return syncedSequence_ >= target || !open_ || stopping_; });
+}
+
+uint64_t AlertJournal::firstSequence() const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+    return segments_.empty() ? 0 : segments_.front()->firstSequence;
+}
+
+uint64_t AlertJournal::endSequence() const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+    return segments_.empty() ? 0 : segments_.back()->endSequence;
+}
+
+size_t AlertJournal::read(uint64_t from, uint64_t to, const Visitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), from,
+                               [](uint64_t sequence, const std::unique_ptr<JournalSegment>& segment) {
+                                   return sequence < segment->firstSequence;
+                               });
+    if (it != segments_.begin()) {
+        --it;
+    }
+
+    size_t visited = 0;
+    JournalEntry entry;
+    for (; it != segments_.end(); ++it) {
+        const JournalSegment& segment = **it;
+        if (segment.firstSequence >= to) {
+            break;
+        }
+
+        uint64_t sequence = std::max(from, segment.firstSequence);
+        uint64_t end = std::min(to, segment.endSequence);
+        for (; sequence < end; ++sequence) {
+            if (!decodeEntry(segment, static_cast<size_t>(sequence - segment.firstSequence), entry)) {
+                continue;
+            }
+            visited++;
+            if (!visitor(entry)) {
+                return visited;
+            }
+        }
+    }
+    return visited;
+}
+
+size_t AlertJournal::readBackward(uint64_t before, size_t maxCount, const Visitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+
+    size_t visited = 0;
+    JournalEntry entry;
+    for (auto it = segments_.rbegin(); it != segments_.rend() && visited < maxCount; ++it) {
+        const JournalSegment& segment = **it;
+        if (segment.firstSequence >= before) {
+            continue;
+        }
+
+        uint64_t sequence = std::min(before, segment.endSequence);
+        while (sequence > segment.firstSequence && visited < maxCount) {
+            --sequence;
+            if (!decodeEntry(segment, static_cast<size_t>(sequence - segment.firstSequence), entry)) {
+                continue;
+            }
+            visited++;
+            if (!visitor(entry)) {
+                return visited;
+            }
+        }
+    }
+    return visited;
+}
+
+uint64_t AlertJournal::findSequenceAt(int64_t timestampMs) const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+
+    // First segment whose newest alert is recent enough
+    auto it = std::partition_point(segments_.begin(), segments_.end(),
+                                   [timestampMs](const std::unique_ptr<JournalSegment>& segment) {
+                                       return segment->offsets.empty() || segment->lastTimestamp < timestampMs;
+                                   });
+    if (it == segments_.end()) {
+        return segments_.empty() ? 0 : segments_.back()->endSequence;
+    }
+
+    // Then the first record in it at or after the timestamp
+    const JournalSegment& segment = **it;
+    size_t low = 0;
+    size_t high = segment.offsets.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int64_t recordTimestamp = static_cast<int64_t>(readU64(segment.data + segment.offsets[mid] + 16));
+        if (recordTimestamp < timestampMs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return segment.firstSequence + low;
+}
+
+int AlertJournal::getWrittenCount() const {
+    return writtenCount_;
+}
+
+int AlertJournal::getDroppedCount() const {
+    return droppedCount_;
+}
+
+int AlertJournal::getSyncCount() const {
+    return syncCount_;
+}
+
+int AlertJournal::getSegmentCount() const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+    return static_cast<int>(segments_.size());
+}
+
+int64_t AlertJournal::getDiskBytes() const {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+    int64_t total = 0;
+    for (const auto& segment : segments_) {
+        total += segment->size;
+    }
+    return total;
+}
+
+int AlertJournal::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return static_cast<int>(pending_.size());
+}
+
+std::string AlertJournal::getLastError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    return lastError_;
+}
+
+void AlertJournal::writerLoop() {
+    const auto syncInterval = std::chrono::milliseconds(options_.syncIntervalMs);
+    auto lastSync = std::chrono::steady_clock::now();
+    int64_t lastRetentionCheck = QDateTime::currentMSecsSinceEpoch();
+    bool dirty = false;
+    std::vector<std::string> batch;
+
+    for (;;) {
+        bool stopping;
+        uint64_t syncTarget;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            auto wakeup = [this] {
+                return stopping_ || !pending_.empty() || flushRequested_ > syncedSequence_;
+            };
+            if (dirty) {
+                queueChanged_.wait_until(lock, lastSync + syncInterval, wakeup);
+            } else {
+                queueChanged_.wait_for(lock, std::chrono::milliseconds(kRetentionCheckMs), wakeup);
+            }
+            batch.swap(pending_);
+            stopping = stopping_;
+            syncTarget = flushRequested_;
+        }
+
+        if (!batch.empty()) {
+            writeBatch(batch);
+            batch.clear();
+            dirty = true;
+        }
+
+        // One fsync covers every alert written since the last one
+        auto now = std::chrono::steady_clock::now();
+        if (dirty && (stopping || now - lastSync >= syncInterval || syncTarget > syncedSequence_)) {
+            syncActiveSegment();
+            lastSync = now;
+            dirty = false;
+        }
+        if (!dirty) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                syncedSequence_ = writtenSequence_;
+            }
+            synced_.notify_all();
+        }
+
+        int64_t wallClock = QDateTime::currentMSecsSinceEpoch();
+        if (wallClock - lastRetentionCheck >= kRetentionCheckMs) {
+            applyRetention();
+            lastRetentionCheck = wallClock;
+        }
+
+        if (stopping) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            if (pending_.empty()) {
+                break;
+            }
+        }
+    }
+
+    sealActiveSegment();
+}
+
+bool AlertJournal::writeBatch(std::vector<std::string>& batch) {
+    size_t index = 0;
+    while (index < batch.size()) {
+        JournalSegment* active;
+        {
+            std::shared_lock<std::shared_mutex> lock(segmentsMutex_);
+            active = segments_.empty() ? nullptr : segments_.back().get();
+        }
+
+        uint64_t firstSequence = readU64(reinterpret_cast<const uchar*>(batch[index].data()) + 8);
+        if (!activeFile_ || !active) {
+            if (!startSegment(firstSequence, static_cast<int64_t>(batch[index].size()))) {
+                break;
+            }
+            continue;
+        }
+        if (firstSequence != active->endSequence) {
+            // Alerts were lost after a failed write; keep each segment gap-free
+            sealActiveSegment();
+            continue;
+        }
+
+        // Records that fit in the active segment go out in one write
+        qint64 start = active->size;
+        qint64 end = start;
+        size_t last = index;
+        while (last < batch.size() && end + static_cast<qint64>(batch[last].size()) <= active->mappedSize) {
+            end += static_cast<qint64>(batch[last].size());
+            last++;
+        }
+
+        if (last == index) {
+            // Full: seal it and continue in a new segment
+            syncActiveSegment();
+            sealActiveSegment();
+            if (!startSegment(firstSequence, static_cast<int64_t>(batch[index].size()))) {
+                break;
+            }
+            continue;
+        }
+
+        std::string buffer;
+        buffer.reserve(static_cast<size_t>(end - start));
+        for (size_t i = index; i < last; ++i) {
+            buffer += batch[i];
+        }
+
+        if (!activeFile_->seek(start) ||
+            activeFile_->write(buffer.data(), static_cast<qint64>(buffer.size())) != static_cast<qint64>(buffer.size())) {
+            setError("Journal write failed: " + activeFile_->errorString().toStdString());
+            qWarning() << getLastError().c_str();
+            break;
+        }
+
+        // Publish the records to readers; the mapping sees the written pages
+        int64_t lastTimestamp = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(segmentsMutex_);
+            qint64 offset = start;
+            for (size_t i = index; i < last; ++i) {
+                const uchar* record = reinterpret_cast<const uchar*>(batch[i].data());
+                lastTimestamp = static_cast<int64_t>(readU64(record + 16));
+                if (active->offsets.empty()) {
+                    active->firstTimestamp = lastTimestamp;
+                }
+                active->offsets.push_back(static_cast<uint32_t>(offset));
+                offset += static_cast<qint64>(batch[i].size());
+            }
+            active->lastTimestamp = lastTimestamp;
+            active->endSequence += last - index;
+            active->size = end;
+        }
+
+        writtenCount_ += static_cast<int>(last - index);
+        writtenSequence_ = readU64(reinterpret_cast<const uchar*>(batch[last - 1].data()) + 8);
+        index = last;
+    }
+
+    if (index < batch.size()) {
+        // Nothing can be written; give up on the rest rather than retry forever
+        droppedCount_ += static_cast<int>(batch.size() - index);
+        writtenSequence_ = readU64(reinterpret_cast<const uchar*>(batch.back().data()) + 8);
+        return false;
+    }
+    return true;
+}
+
+bool AlertJournal::startSegment(uint64_t firstSequence, int64_t minimumBytes) {
+    auto segment = std::make_unique<JournalSegment>();
+    QDir directory(QString::fromStdString(options_.directory));
+    segment->path = directory.filePath(segmentFileName(firstSequence));
+    segment->firstSequence = firstSequence;
+    segment->endSequence = firstSequence;
+    segment->size = kFileHeaderSize;
+
+    auto file = std::make_unique<QFile>(segment->path);
+    qint64 capacity = std::max<qint64>(options_.segmentBytes, kFileHeaderSize + minimumBytes);
+
+    char header[kFileHeaderSize];
+    std::memcpy(header, kFileMagic, sizeof(kFileMagic));
+    writeU64(header + 8, firstSequence);
+
+    // Preallocating lets the segment be mapped once at its full size
+    if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+        file->write(header, kFileHeaderSize) != kFileHeaderSize ||
+        !file->resize(capacity) ||
+        !syncFile(*file) ||
+        !mapSegment(*segment, capacity)) {
+        setError("Cannot create journal segment " + segment->path.toStdString() +
+                 ": " + file->errorString().toStdString());
+        file->close();
+        unmapSegment(*segment);
+        QFile::remove(segment->path);
+        return false;
+    }
+
+    activeFile_ = std::move(file);
+    std::unique_lock<std::shared_mutex> lock(segmentsMutex_);
+    segments_.push_back(std::move(segment));
+    return true;
+}
+
+void AlertJournal::sealActiveSegment() {
+    if (!activeFile_) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(segmentsMutex_);
+    JournalSegment& active = *segments_.back();
+
+    // Trim the preallocated tail and remap at the final size
+    unmapSegment(active);
+    activeFile_->resize(active.size);
+    syncFile(*activeFile_);
+    activeFile_->close();
+    activeFile_.reset();
+
+    if (active.offsets.empty()) {
+        QFile::remove(active.path);
+        segments_.pop_back();
+    } else if (!mapSegment(active, active.size)) {
+        qWarning() << "Cannot remap journal segment" << active.path;
+        segments_.pop_back();
+    }
+}
+
+void AlertJournal::syncActiveSegment() {
+    if (activeFile_ && syncFile(*activeFile_)) {
+        syncCount_++;
+    }
+}
+
+void AlertJournal::applyRetention() {
+    int64_t cutoff = options_.retentionDays > 0
+                     ? QDateTime::currentMSecsSinceEpoch() - options_.retentionDays * kMsPerDay
+                     : 0;
+
+    std::unique_lock<std::shared_mutex> lock(segmentsMutex_);
+
+    // Only sealed segments go; the active one is the last while writing
+    size_t sealed = segments_.size() - (activeFile_ ? 1 : 0);
+    while (sealed > 0) {
+        JournalSegment& oldest = *segments_.front();
+        bool tooMany = options_.maxSegments > 0 && segments_.size() > static_cast<size_t>(options_.maxSegments);
+        bool tooOld = cutoff > 0 && oldest.lastTimestamp < cutoff;
+        if (!tooMany && !tooOld) {
+            break;
+        }
+
+        unmapSegment(oldest);
+        QFile::remove(oldest.path);
+        segments_.pop_front();
+        sealed--;
+    }
+}
+
+void AlertJournal::setError(const std::string& error) {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    lastError_ = error;
+}
+
+bool AlertJournal::decodeEntry(const JournalSegment& segment, size_t index, JournalEntry& entry) {
+    if (!segment.data || index >= segment.offsets.size()) {
+        return false;
+    }
+
+    const uchar* record = segment.data + segment.offsets[index];
+    uint32_t lengths[4];
+    for (int i = 0; i < 4; ++i) {
+        lengths[i] = readU32(record + 28 + i * 4);
+    }
+
+    const char* payload = reinterpret_cast<const char*>(record + kRecordHeaderSize);
+    entry.sequence = readU64(record + 8);
+    entry.timestampMs = static_cast<int64_t>(readU64(record + 16));
+    entry.type = static_cast<AlertType>(readU32(record + 24));
+    entry.title = std::string_view(payload, lengths[0]);
+    payload += lengths[0];
+    entry.querySource = std::string_view(payload, lengths[1]);
+    payload += lengths[1];
+    entry.message = std::string_view(payload, lengths[2]);
+    payload += lengths[2];
+    entry.rawResult = std::string_view(payload, lengths[3]);
+    return true;
+}
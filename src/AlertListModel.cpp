@@ -0,0 +1,363 @@
+#include "AlertListModel.h"
+#include "AlertJournal.h"
+#include <QPainter>
+#include <QFontMetrics>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+QString fromView(std::string_view value) {
+    return QString::fromUtf8(value.data(), static_cast<int>(value.size()));
+}
+}
+
+AlertListModel::AlertListModel(AlertSystem* alertSystem, QObject* parent)
+    : QAbstractListModel(parent)
+    , alertSystem_(alertSystem)
+    , scannedUpTo_(0)
+    , droppedAlerts_(0)
+    , typeMask_(AlertSearchIndex::AllTypes)
+{
+    reload();
+}
+
+QColor AlertListModel::colorFor(AlertType type) {
+    switch (type) {
+        case AlertType::CRITICAL:
+            return QColor("#d32f2f");  // Red
+        case AlertType::WARNING:
+            return QColor("#f57c00");  // Orange/Yellow
+        case AlertType::INFO:
+        default:
+            return QColor("#388e3c");  // Green
+    }
+}
+
+void AlertListModel::setAlertSystem(AlertSystem* alertSystem) {
+    if (alertSystem_ == alertSystem) {
+        return;
+    }
+    alertSystem_ = alertSystem;
+    internedText_.clear();
+    reload();
+}
+
+int AlertListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(ids_.size());
+}
+
+QVariant AlertListModel::data(const QModelIndex& index, int role) const {
+    AlertRecord record;
+    if (!index.isValid() || !alertAt(index.row(), record)) {
+        return QVariant();
+    }
+
+    switch (role) {
+        case Qt::DisplayRole:
+            return QString("[%1] %2\n%3 - %4")
+                   .arg(Alert::formatTimestamp(QDateTime::fromMSecsSinceEpoch(record.timestampMs)))
+                   .arg(internedText(record.title))
+                   .arg(QString::fromStdString(Alert::typeToString(record.type)))
+                   .arg(internedText(record.querySource));
+        case Qt::BackgroundRole:
+            return AlertListModel::colorFor(record.type);
+        case Qt::ForegroundRole:
+            return QColor(Qt::white);
+        case Qt::ToolTipRole:
+        case MessageRole:
+            return fromView(record.message);
+        case AlertIdRole:
+            return QVariant::fromValue<qulonglong>(record.id);
+        case TypeRole:
+            return static_cast<int>(record.type);
+        case TitleRole:
+            return internedText(record.title);
+        case QuerySourceRole:
+            return internedText(record.querySource);
+        case RawResultRole:
+            return fromView(record.rawResult);
+        case TimestampRole:
+            return QDateTime::fromMSecsSinceEpoch(record.timestampMs);
+        default:
+            return QVariant();
+    }
+}
+
+bool AlertListModel::removeRows(int row, int count, const QModelIndex& parent) {
+    int size = static_cast<int>(ids_.size());
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > size) {
+        return false;
+    }
+
+    // Rows run newest first, ids_ oldest first
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    auto last = ids_.begin() + (size - row);
+    ids_.erase(last - count, last);
+    endRemoveRows();
+    return true;
+}
+
+void AlertListModel::refresh() {
+    if (!alertSystem_) {
+        return;
+    }
+
+    AlertSnapshot view = alertSystem_->snapshot();
+    index_.evictBefore(view.firstId());
+    pruneEvicted(view.firstId());
+
+    if (scannedUpTo_ > 0 && scannedUpTo_ < view.firstId()) {
+        droppedAlerts_ += view.firstId() - scannedUpTo_;
+    }
+
+    std::vector<uint64_t> added;
+    AlertRecord record;
+    for (uint64_t id = std::max(scannedUpTo_, view.firstId()); id < view.endId(); ++id) {
+        if (!view.read(id, record)) {
+            continue;
+        }
+        index_.add(record);
+        if (AlertSearchIndex::matches(record, typeMask_, needle_)) {
+            added.push_back(id);
+        }
+    }
+    scannedUpTo_ = view.endId();
+
+    // Swap the snapshot in first so the view can read the new rows during the insert
+    snapshot_ = std::move(view);
+    if (added.empty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), 0, static_cast<int>(added.size()) - 1);
+    ids_.insert(ids_.end(), added.begin(), added.end());
+    endInsertRows();
+}
+
+void AlertListModel::reload() {
+    beginResetModel();
+
+    ids_.clear();
+    index_.clear();
+    snapshot_ = alertSystem_ ? alertSystem_->snapshot() : AlertSnapshot();
+
+    AlertRecord record;
+    for (uint64_t id = snapshot_.firstId(); id < snapshot_.endId(); ++id) {
+        if (!snapshot_.read(id, record)) {
+            continue;
+        }
+        index_.add(record);
+        if (AlertSearchIndex::matches(record, typeMask_, needle_)) {
+            ids_.push_back(id);
+        }
+    }
+    scannedUpTo_ = snapshot_.endId();
+
+    endResetModel();
+}
+
+void AlertListModel::setFilter(bool showCritical, bool showWarning, bool showInfo,
+                               const QString& searchText) {
+    unsigned typeMask = (showCritical ? AlertSearchIndex::typeBit(AlertType::CRITICAL) : 0) |
+                        (showWarning ? AlertSearchIndex::typeBit(AlertType::WARNING) : 0) |
+                        (showInfo ? AlertSearchIndex::typeBit(AlertType::INFO) : 0);
+    std::string needle = AlertSearchIndex::foldCase(searchText.toStdString());
+    if (typeMask == typeMask_ && needle == needle_) {
+        return;
+    }
+
+    // Current rows are a superset of the new answer when the filter only got stricter
+    bool narrowing = (typeMask & ~typeMask_) == 0 && needle.find(needle_) != std::string::npos;
+    std::vector<uint64_t> previous;
+    if (narrowing) {
+        previous.assign(ids_.begin(), ids_.end());
+    }
+
+    typeMask_ = typeMask;
+    needle_ = needle;
+    std::vector<uint64_t> found = index_.search(snapshot_, typeMask_, needle_,
+                                                narrowing ? &previous : nullptr);
+
+    beginResetModel();
+    ids_.assign(found.begin(), found.end());
+    endResetModel();
+}
+
+bool AlertListModel::alertAt(int row, AlertRecord& record) const {
+    if (row < 0 || row >= static_cast<int>(ids_.size())) {
+        return false;
+    }
+    return snapshot_.read(ids_[ids_.size() - 1 - row], record);
+}
+
+uint64_t AlertListModel::alertIdAt(int row) const {
+    if (row < 0 || row >= static_cast<int>(ids_.size())) {
+        return 0;
+    }
+    return ids_[ids_.size() - 1 - row];
+}
+
+QString AlertListModel::internedText(const InternedString& value) const {
+    if (value.isNull()) {
+        return QString();
+    }
+
+    auto it = internedText_.find(value.key());
+    if (it == internedText_.end()) {
+        it = internedText_.emplace(value.key(), QString::fromStdString(value.str())).first;
+    }
+    return it->second;
+}
+
+void AlertListModel::pruneEvicted(uint64_t firstId) {
+    // Evicted alerts are the oldest, which sit at the bottom of the list
+    size_t evicted = 0;
+    while (evicted < ids_.size() && ids_[evicted] < firstId) {
+        evicted++;
+    }
+    if (evicted == 0) {
+        return;
+    }
+
+    int size = static_cast<int>(ids_.size());
+    beginRemoveRows(QModelIndex(), size - static_cast<int>(evicted), size - 1);
+    ids_.erase(ids_.begin(), ids_.begin() + evicted);
+    endRemoveRows();
+}
+
+JournalHistoryModel::JournalHistoryModel(AlertJournal* journal, QObject* parent)
+    : QAbstractListModel(parent)
+    , journal_(journal)
+    , newest_(0)
+    , oldest_(0)
+    , loaded_(0)
+{
+    reload();
+}
+
+int JournalHistoryModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : loaded_;
+}
+
+QVariant JournalHistoryModel::data(const QModelIndex& index, int role) const {
+    if (!journal_ || !index.isValid() || index.row() >= loaded_) {
+        return QVariant();
+    }
+
+    // The entry's views die with the visitor, so the value is built inside it
+    QVariant value;
+    uint64_t sequence = sequenceAt(index.row());
+    journal_->read(sequence, sequence + 1, [&](const JournalEntry& entry) {
+        switch (role) {
+            case Qt::DisplayRole:
+                value = QString("[%1] %2\n%3 - %4")
+                        .arg(QDateTime::fromMSecsSinceEpoch(entry.timestampMs).toString("yyyy-MM-dd hh:mm:ss"))
+                        .arg(fromView(entry.title))
+                        .arg(QString::fromStdString(Alert::typeToString(entry.type)))
+                        .arg(fromView(entry.querySource));
+                break;
+            case Qt::BackgroundRole:
+                value = AlertListModel::colorFor(entry.type);
+                break;
+            case Qt::ForegroundRole:
+                value = QColor(Qt::white);
+                break;
+            case Qt::ToolTipRole:
+            case AlertListModel::MessageRole:
+                value = fromView(entry.message);
+                break;
+            case AlertListModel::AlertIdRole:
+                value = QVariant::fromValue<qulonglong>(entry.sequence);
+                break;
+            case AlertListModel::TypeRole:
+                value = static_cast<int>(entry.type);
+                break;
+            case AlertListModel::TitleRole:
+                value = fromView(entry.title);
+                break;
+            case AlertListModel::QuerySourceRole:
+                value = fromView(entry.querySource);
+                break;
+            case AlertListModel::RawResultRole:
+                value = fromView(entry.rawResult);
+                break;
+            case AlertListModel::TimestampRole:
+                value = QDateTime::fromMSecsSinceEpoch(entry.timestampMs);
+                break;
+            default:
+                break;
+        }
+        return false;
+    });
+    return value;
+}
+
+bool JournalHistoryModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && static_cast<uint64_t>(loaded_) < totalCount() &&
+           loaded_ < std::numeric_limits<int>::max();
+}
+
+void JournalHistoryModel::fetchMore(const QModelIndex& parent) {
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    uint64_t remaining = std::min<uint64_t>(totalCount() - static_cast<uint64_t>(loaded_),
+                                            static_cast<uint64_t>(std::numeric_limits<int>::max() - loaded_));
+    int count = static_cast<int>(std::min<uint64_t>(remaining, kPageSize));
+
+    beginInsertRows(QModelIndex(), loaded_, loaded_ + count - 1);
+    loaded_ += count;
+    endInsertRows();
+}
+
+void JournalHistoryModel::reload() {
+    beginResetModel();
+    newest_ = journal_ ? journal_->endSequence() : 0;
+    oldest_ = journal_ ? journal_->firstSequence() : 0;
+    loaded_ = 0;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+uint64_t JournalHistoryModel::sequenceAt(int row) const {
+    return newest_ - 1 - static_cast<uint64_t>(row);
+}
+
+AlertItemDelegate::AlertItemDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void AlertItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                              const QModelIndex& index) const {
+    painter->save();
+
+    QRect card = option.rect.adjusted(2, 1, -2, -1);
+    QColor background = index.data(Qt::BackgroundRole).value<QColor>();
+    if (option.state & QStyle::State_Selected) {
+        background = background.darker(130);
+    }
+    painter->fillRect(card, background);
+
+    QFont font = option.font;
+    font.setBold(true);
+    painter->setFont(font);
+    painter->setPen(index.data(Qt::ForegroundRole).value<QColor>());
+    painter->drawText(card.adjusted(6, 2, -6, -2), Qt::AlignLeft | Qt::AlignVCenter,
+                      index.data(Qt::DisplayRole).toString());
+
+    painter->restore();
+}
+
+QSize AlertItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    Q_UNUSED(index);
+
+    // Two lines of bold text plus padding, the same for every row
+    QFont font = option.font;
+    font.setBold(true);
+    QFontMetrics metrics(font);
+    return QSize(option.rect.width(), metrics.lineSpacing() * 2 + 10);
+}
@@ -0,0 +1,312 @@
+#include "AlertSearchIndex.h"
+#include <algorithm>
+#include <limits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+inline unsigned char fold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+}
+
+inline unsigned countTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+const uint64_t kCompactThreshold = 4096;
+}
+
+AlertSearchIndex::AlertSearchIndex()
+    : firstWord_(0)
+    , base_(0)
+    , firstId_(0)
+    , endId_(0)
+    , evictedSinceCompact_(0)
+{
+}
+
+void AlertSearchIndex::add(const AlertRecord& record) {
+    if (record.id < endId_) {
+        return;  // Already indexed
+    }
+
+    if (firstId_ == endId_) {
+        // Empty: start the bitsets and postings at this id
+        clear();
+        firstId_ = record.id;
+        firstWord_ = record.id / 64;
+        base_ = record.id;
+    } else if (record.id - base_ > std::numeric_limits<uint32_t>::max()) {
+        compact();
+    }
+    endId_ = record.id + 1;
+
+    size_t word = static_cast<size_t>(record.id / 64 - firstWord_);
+    for (auto& bits : typeBits_) {
+        while (bits.size() <= word) {
+            bits.push_back(0);
+        }
+    }
+
+    size_t typeIndex = static_cast<size_t>(record.type);
+    if (typeIndex < 3) {
+        typeBits_[typeIndex][word] |= 1ULL << (record.id % 64);
+    }
+
+    // Each trigram lists the alert once, however often it occurs
+    std::vector<Trigram> trigrams;
+    collectTrigrams(record.title.view(), trigrams);
+    collectTrigrams(record.message, trigrams);
+    collectTrigrams(record.querySource.view(), trigrams);
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    uint32_t relativeId = static_cast<uint32_t>(record.id - base_);
+    for (Trigram trigram : trigrams) {
+        postings_[trigram].push_back(relativeId);
+    }
+}
+
+void AlertSearchIndex::evictBefore(uint64_t firstId) {
+    if (firstId <= firstId_) {
+        return;
+    }
+
+    if (firstId >= endId_) {
+        clear();
+        firstId_ = endId_ = firstId;
+        return;
+    }
+
+    evictedSinceCompact_ += firstId - firstId_;
+    firstId_ = firstId;
+
+    while ((firstWord_ + 1) * 64 <= firstId_) {
+        for (auto& bits : typeBits_) {
+            bits.pop_front();
+        }
+        firstWord_++;
+    }
+
+    // Postings are trimmed in bulk; until then search skips the stale ids
+    if (evictedSinceCompact_ >= kCompactThreshold && evictedSinceCompact_ >= size()) {
+        compact();
+    }
+}
+
+void AlertSearchIndex::clear() {
+    for (auto& bits : typeBits_) {
+        bits.clear();
+    }
+    postings_.clear();
+    firstWord_ = 0;
+    base_ = 0;
+    firstId_ = 0;
+    endId_ = 0;
+    evictedSinceCompact_ = 0;
+}
+
+std::vector<uint64_t> AlertSearchIndex::search(const AlertSnapshot& view, unsigned typeMask,
+                                               const std::string& needle,
+                                               const std::vector<uint64_t>* candidates) const {
+    std::vector<uint64_t> results;
+    uint64_t low = std::max(view.firstId(), firstId_);
+    uint64_t high = std::min(view.endId(), endId_);
+    if (low >= high || (typeMask & AllTypes) == 0) {
+        return results;
+    }
+
+    AlertRecord record;
+    auto verify = [&](uint64_t id) {
+        return view.read(id, record) && matches(record, typeMask, needle);
+    };
+
+    // Trigram postings, smallest first, when the needle is long enough to have any
+    std::vector<const std::vector<uint32_t>*> lists;
+    if (needle.size() >= 3) {
+        std::vector<Trigram> trigrams;
+        collectTrigrams(needle, trigrams);
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        for (Trigram trigram : trigrams) {
+            auto it = postings_.find(trigram);
+            if (it == postings_.end()) {
+                return results;  // Some trigram never occurs, so nothing matches
+            }
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+                      return a->size() < b->size();
+                  });
+    }
+
+    // Narrowing: the previous results are already a superset of the answer
+    if (candidates && (lists.empty() || candidates->size() <= lists.front()->size())) {
+        for (uint64_t id : *candidates) {
+            if (id >= low && id < high && hasType(id, typeMask) && verify(id)) {
+                results.push_back(id);
+            }
+        }
+        return results;
+    }
+
+    if (!lists.empty()) {
+        // Walk the shortest list and probe the rest, each probe resuming where the last left off
+        std::vector<std::vector<uint32_t>::const_iterator> cursors;
+        for (size_t i = 1; i < lists.size(); ++i) {
+            cursors.push_back(lists[i]->begin());
+        }
+
+        for (uint32_t relativeId : *lists.front()) {
+            uint64_t id = base_ + relativeId;
+            if (id < low) {
+                continue;
+            }
+            if (id >= high) {
+                break;
+            }
+
+            bool inAll = true;
+            for (size_t i = 0; i < cursors.size() && inAll; ++i) {
+                cursors[i] = std::lower_bound(cursors[i], lists[i + 1]->end(), relativeId);
+                inAll = cursors[i] != lists[i + 1]->end() && *cursors[i] == relativeId;
+            }
+
+            if (inAll && hasType(id, typeMask) && verify(id)) {
+                results.push_back(id);
+            }
+        }
+        return results;
+    }
+
+    // Short or empty needle: scan the type bitsets a word at a time
+    for (uint64_t word = low / 64; word * 64 < high; ++word) {
+        size_t offset = static_cast<size_t>(word - firstWord_);
+        uint64_t bits = 0;
+        for (unsigned type = 0; type < 3; ++type) {
+            if ((typeMask & (1u << type)) && offset < typeBits_[type].size()) {
+                bits |= typeBits_[type][offset];
+            }
+        }
+
+        while (bits) {
+            uint64_t id = word * 64 + countTrailingZeros(bits);
+            bits &= bits - 1;
+            if (id < low || id >= high) {
+                continue;
+            }
+            if (needle.empty() || verify(id)) {
+                results.push_back(id);
+            }
+        }
+    }
+    return results;
+}
+
+bool AlertSearchIndex::matches(const AlertRecord& record, unsigned typeMask, const std::string& needle) {
+    if ((typeMask & typeBit(record.type)) == 0) {
+        return false;
+    }
+
+    return needle.empty() ||
+           containsFolded(record.title.view(), needle) ||
+           containsFolded(record.message, needle) ||
+           containsFolded(record.querySource.view(), needle);
+}
+
+std::string AlertSearchIndex::foldCase(std::string_view value) {
+    std::string folded(value);
+    for (char& c : folded) {
+        c = static_cast<char>(fold(static_cast<unsigned char>(c)));
+    }
+    return folded;
+}
+
+void AlertSearchIndex::collectTrigrams(std::string_view text, std::vector<Trigram>& trigrams) {
+    if (text.size() < 3) {
+        return;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    Trigram trigram = (static_cast<Trigram>(fold(data[0])) << 8) | fold(data[1]);
+    for (size_t i = 2; i < text.size(); ++i) {
+        trigram = ((trigram << 8) | fold(data[i])) & 0xFFFFFFu;
+        trigrams.push_back(trigram);
+    }
+}
+
+bool AlertSearchIndex::containsFolded(std::string_view haystack, const std::string& needle) {
+    if (needle.size() > haystack.size()) {
+        return false;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(haystack.data());
+    const unsigned char* pattern = reinterpret_cast<const unsigned char*>(needle.data());
+    size_t last = haystack.size() - needle.size();
+
+    for (size_t i = 0; i <= last; ++i) {
+        if (fold(data[i]) != pattern[0]) {
+            continue;
+        }
+        size_t j = 1;
+        while (j < needle.size() && fold(data[i + j]) == pattern[j]) {
+            j++;
+        }
+        if (j == needle.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AlertSearchIndex::hasType(uint64_t id, unsigned typeMask) const {
+    if (id < firstId_ || id >= endId_) {
+        return false;
+    }
+
+    size_t offset = static_cast<size_t>(id / 64 - firstWord_);
+    uint64_t bit = 1ULL << (id % 64);
+    for (unsigned type = 0; type < 3; ++type) {
+        if ((typeMask & (1u << type)) && offset < typeBits_[type].size() &&
+            (typeBits_[type][offset] & bit)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AlertSearchIndex::compact() {
+    // Drop evicted ids and rebase the rest on firstId_
+    if (firstId_ - base_ > std::numeric_limits<uint32_t>::max()) {
+        postings_.clear();
+        base_ = firstId_;
+        evictedSinceCompact_ = 0;
+        return;
+    }
+    uint32_t firstRelative = static_cast<uint32_t>(firstId_ - base_);
+
+    for (auto it = postings_.begin(); it != postings_.end();) {
+        std::vector<uint32_t>& ids = it->second;
+        ids.erase(ids.begin(), std::lower_bound(ids.begin(), ids.end(), firstRelative));
+        if (ids.empty()) {
+            it = postings_.erase(it);
+            continue;
+        }
+        for (uint32_t& id : ids) {
+            id -= firstRelative;
+        }
+        ++it;
+    }
+
+    base_ = firstId_;
+    evictedSinceCompact_ = 0;
+}
@@ -0,0 +1,182 @@
+#include "AlertSink.h"
+#include "AlertSystem.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUdpSocket>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+const char* const kAppName = "pg-monitor";
+
+// RFC 5426 asks receivers to take datagrams of at least this size
+const int kMaxSyslogDatagram = 2048;
+
+QString utcTimestamp(int64_t timestampMs) {
+    return QDateTime::fromMSecsSinceEpoch(timestampMs, Qt::UTC).toString(Qt::ISODateWithMs);
+}
+
+// Header fields are printable ASCII without spaces; anything else becomes '_'
+QByteArray headerField(const std::string& value, int maxLength) {
+    if (value.empty()) {
+        return "-";
+    }
+    QByteArray field = QByteArray::fromStdString(value).left(maxLength);
+    for (char& c : field) {
+        if (c < 33 || c > 126) {
+            c = '_';
+        }
+    }
+    return field;
+}
+
+int syslogSeverity(AlertType type) {
+    switch (type) {
+        case AlertType::CRITICAL:
+            return 2;   // crit
+        case AlertType::WARNING:
+            return 4;   // warning
+        case AlertType::INFO:
+        default:
+            return 6;   // informational
+    }
+}
+}
+
+WebhookSink::WebhookSink(const QString& url, int timeoutMs)
+    : url_(url)
+    , timeoutMs_(timeoutMs)
+{
+}
+
+WebhookSink::~WebhookSink() = default;
+
+bool WebhookSink::open(std::string& error) {
+    QUrl url(url_);
+    if (!url.isValid() || (url.scheme() != "http" && url.scheme() != "https")) {
+        error = "Invalid webhook URL: " + url_.toStdString();
+        return false;
+    }
+    network_ = std::make_unique<QNetworkAccessManager>();
+    return true;
+}
+
+AlertSink::Delivery WebhookSink::deliver(const std::vector<SinkAlert>& batch, std::string& error) {
+    QNetworkRequest request{QUrl(url_)};
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setTransferTimeout(timeoutMs_);
+
+    // The sink's thread has nothing else to do meanwhile, so it waits here
+    QNetworkReply* reply = network_->post(request, formatBatch(batch));
+    QEventLoop loop;
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QString errorString = reply->errorString();
+    delete reply;
+
+    if (status >= 200 && status < 300) {
+        return Delivery::Delivered;
+    }
+
+    error = status > 0 ? "HTTP " + std::to_string(status) : errorString.toStdString();
+    if (status == 0 || status == 408 || status == 429 || status >= 500) {
+        return Delivery::Retry;
+    }
+    return Delivery::Rejected;
+}
+
+void WebhookSink::close() {
+    network_.reset();
+}
+
+QByteArray WebhookSink::formatBatch(const std::vector<SinkAlert>& batch) {
+    QJsonArray alerts;
+    for (const SinkAlert& alert : batch) {
+        QJsonObject object;
+        object["id"] = alert.id;
+        object["type"] = QString::fromStdString(Alert::typeToString(alert.type));
+        object["timestamp"] = utcTimestamp(alert.timestampMs);
+        object["title"] = QString::fromStdString(alert.title);
+        object["source"] = QString::fromStdString(alert.querySource);
+        object["message"] = QString::fromStdString(alert.message);
+        alerts.append(object);
+    }
+    return QJsonDocument(alerts).toJson(QJsonDocument::Compact);
+}
+
+SyslogSink::SyslogSink(const QString& host, int port, int facility)
+    : host_(host)
+    , port_(port)
+    , facility_(std::max(0, std::min(facility, 23)))
+{
+}
+
+SyslogSink::~SyslogSink() = default;
+
+bool SyslogSink::open(std::string& error) {
+    QHostAddress address;
+    if (!address.setAddress(host_)) {
+        QHostInfo info = QHostInfo::fromName(host_);
+        if (info.addresses().isEmpty()) {
+            error = "Cannot resolve syslog host " + host_.toStdString() + ": " + info.errorString().toStdString();
+            return false;
+        }
+        address = info.addresses().first();
+    }
+
+    address_ = std::make_unique<QHostAddress>(address);
+    socket_ = std::make_unique<QUdpSocket>();
+    hostName_ = QHostInfo::localHostName();
+    return true;
+}
+
+AlertSink::Delivery SyslogSink::deliver(const std::vector<SinkAlert>& batch, std::string& error) {
+    // A failure part way through resends the whole batch; syslog takes repeats
+    for (const SinkAlert& alert : batch) {
+        QByteArray datagram = formatMessage(alert, facility_, hostName_);
+        if (socket_->writeDatagram(datagram, *address_, static_cast<quint16>(port_)) < 0) {
+            error = socket_->errorString().toStdString();
+            return Delivery::Retry;
+        }
+    }
+    return Delivery::Delivered;
+}
+
+void SyslogSink::close() {
+    socket_.reset();
+    address_.reset();
+}
+
+QByteArray SyslogSink::formatMessage(const SinkAlert& alert, int facility, const QString& hostName) {
+    // <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID - MSG, with the query as MSGID
+    QByteArray datagram;
+    datagram += "<" + QByteArray::number(facility * 8 + syslogSeverity(alert.type)) + ">1 ";
+    datagram += utcTimestamp(alert.timestampMs).toLatin1() + " ";
+    datagram += headerField(hostName.toStdString(), 255) + " ";
+    datagram += QByteArray(kAppName) + " ";
+    datagram += QByteArray::number(QCoreApplication::applicationPid()) + " ";
+    datagram += headerField(alert.querySource, 32) + " - ";
+    datagram += "\xEF\xBB\xBF";
+    datagram += QByteArray::fromStdString(alert.title) + ": " + QByteArray::fromStdString(alert.message);
+
+    if (datagram.size() > kMaxSyslogDatagram) {
+        // Cut on a character boundary
+        int length = kMaxSyslogDatagram;
+        while (length > 0 && (static_cast<unsigned char>(datagram[length]) & 0xC0) == 0x80) {
+            length--;
+        }
+        datagram.truncate(length);
+    }
+    return datagram;
+}
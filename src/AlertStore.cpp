@@ -0,0 +1,336 @@
+#include "AlertStore.h"
+#include "AlertSystem.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace {
+const size_t kChunkSize = 64 * 1024;
+}
+
+// A block of string payloads; rows only ever append, so pointers stay valid
+struct ArenaChunk {
+    std::unique_ptr<char[]> data;
+    size_t capacity = 0;
+    size_t used = 0;
+    uint64_t lastId = 0;    // newest row with a payload in this chunk
+};
+
+Alert AlertRecord::toAlert() const {
+    Alert alert(static_cast<int>(id), type, title, std::string(message),
+                querySource, std::string(rawResult));
+    alert.timestamp = QDateTime::fromMSecsSinceEpoch(timestampMs);
+    alert.fingerprint = fingerprint;
+    alert.similarityKey = similarityKey;
+    return alert;
+}
+
+bool AlertSnapshot::read(uint64_t id, AlertRecord& record) const {
+    if (!store_ || id < first_ || id >= end_) {
+        return false;
+    }
+    return store_->read(id, record);
+}
+
+AlertStore::AlertStore(size_t capacity, std::shared_ptr<StringInterner> strings)
+    : capacity_(std::max<size_t>(1, capacity))
+    , headSlot_(0)
+    , firstId_(1)
+    , nextId_(1)
+    , typeCounts_{}
+    , strings_(strings ? std::move(strings) : std::make_shared<StringInterner>())
+{
+    ids_.resize(capacity_);
+    types_.resize(capacity_);
+    timestamps_.resize(capacity_);
+    querySourceIds_.resize(capacity_);
+    titleIds_.resize(capacity_);
+    messages_.resize(capacity_);
+    rawResults_.resize(capacity_);
+    fingerprints_.resize(capacity_);
+    similarityKeys_.resize(capacity_);
+}
+
+AlertStore::~AlertStore() = default;
+
+void AlertStore::setEvictionHandler(EvictionHandler handler) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    evictionHandler_ = std::move(handler);
+}
+
+uint64_t AlertStore::append(const Alert& alert, int64_t timestampMs) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // Handles from our own table are used as-is, anything else is interned
+    uint32_t querySourceId = strings_->adopt(alert.querySource).id();
+    uint32_t titleId = strings_->adopt(alert.title).id();
+
+    if (nextId_ - firstId_ >= capacity_) {
+        evictFrontLocked();
+    }
+
+    uint64_t id = nextId_++;
+    size_t slot = slotOf(id);
+
+    ids_[slot] = id;
+    types_[slot] = static_cast<uint8_t>(alert.type);
+    timestamps_[slot] = timestampMs;
+    querySourceIds_[slot] = querySourceId;
+    titleIds_[slot] = titleId;
+    messages_[slot] = storeString(alert.message, id);
+    rawResults_[slot] = storeString(alert.rawResult, id);
+    fingerprints_[slot] = alert.fingerprint;
+    similarityKeys_[slot] = alert.similarityKey;
+
+    size_t typeIndex = types_[slot];
+    if (typeIndex < kTypeCount) {
+        typeCounts_[typeIndex]++;
+    }
+
+    releaseChunksLocked();
+    return id;
+}
+
+void AlertStore::evictOldest(size_t count) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    while (count-- > 0 && firstId_ < nextId_) {
+        evictFrontLocked();
+    }
+    releaseChunksLocked();
+}
+
+void AlertStore::evictBefore(int64_t timestampMs) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // Timestamps never decrease along the ring, so old rows are all at the front
+    while (firstId_ < nextId_ && timestamps_[headSlot_] < timestampMs) {
+        evictFrontLocked();
+    }
+    releaseChunksLocked();
+}
+
+void AlertStore::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    while (firstId_ < nextId_) {
+        evictFrontLocked();
+    }
+    chunks_.clear();
+}
+
+void AlertStore::setCapacity(size_t capacity) {
+    capacity = std::max<size_t>(1, capacity);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (capacity == capacity_) {
+        return;
+    }
+
+    // Drop what no longer fits, then lay the survivors out from slot 0
+    while (nextId_ - firstId_ > capacity) {
+        evictFrontLocked();
+    }
+
+    size_t count = static_cast<size_t>(nextId_ - firstId_);
+    auto relayout = [&](auto& column) {
+        std::remove_reference_t<decltype(column)> resized(capacity);
+        for (size_t i = 0; i < count; ++i) {
+            resized[i] = column[(headSlot_ + i) % capacity_];
+        }
+        column.swap(resized);
+    };
+
+    relayout(ids_);
+    relayout(types_);
+    relayout(timestamps_);
+    relayout(querySourceIds_);
+    relayout(titleIds_);
+    relayout(messages_);
+    relayout(rawResults_);
+    relayout(fingerprints_);
+    relayout(similarityKeys_);
+
+    capacity_ = capacity;
+    headSlot_ = 0;
+    releaseChunksLocked();
+}
+
+void AlertStore::setStringTable(std::shared_ptr<StringInterner> strings) {
+    if (!strings) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (strings == strings_) {
+        return;
+    }
+
+    for (uint64_t id = firstId_; id < nextId_; ++id) {
+        size_t slot = slotOf(id);
+        querySourceIds_[slot] = strings->intern(strings_->view(querySourceIds_[slot]));
+        titleIds_[slot] = strings->intern(strings_->view(titleIds_[slot]));
+    }
+
+    // Handles already given out still point into the old table
+    retiredStrings_.push_back(std::move(strings_));
+    strings_ = std::move(strings);
+}
+
+AlertSnapshot AlertStore::snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return makeSnapshotLocked(firstId_);
+}
+
+AlertSnapshot AlertStore::snapshotLatest(size_t maxCount) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint64_t count = nextId_ - firstId_;
+    return makeSnapshotLocked(nextId_ - std::min<uint64_t>(count, maxCount));
+}
+
+AlertSnapshot AlertStore::snapshotSince(int64_t timestampMs) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    // Binary search over the (sorted) timestamp column in ring order
+    uint64_t low = firstId_;
+    uint64_t high = nextId_;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (timestamps_[slotOf(mid)] < timestampMs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return makeSnapshotLocked(low);
+}
+
+bool AlertStore::read(uint64_t id, AlertRecord& record) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return readLocked(id, record);
+}
+
+size_t AlertStore::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return static_cast<size_t>(nextId_ - firstId_);
+}
+
+size_t AlertStore::capacity() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return capacity_;
+}
+
+uint64_t AlertStore::firstId() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return firstId_;
+}
+
+uint64_t AlertStore::endId() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return nextId_;
+}
+
+size_t AlertStore::countByType(AlertType type) const {
+    size_t typeIndex = static_cast<size_t>(type);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return typeIndex < kTypeCount ? typeCounts_[typeIndex] : 0;
+}
+
+int64_t AlertStore::lastTimestamp() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return firstId_ < nextId_ ? timestamps_[slotOf(nextId_ - 1)] : 0;
+}
+
+size_t AlertStore::arenaBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const auto& chunk : chunks_) {
+        bytes += chunk->capacity;
+    }
+    return bytes;
+}
+
+std::shared_ptr<StringInterner> AlertStore::strings() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return strings_;
+}
+
+size_t AlertStore::slotOf(uint64_t id) const {
+    return (headSlot_ + static_cast<size_t>(id - firstId_)) % capacity_;
+}
+
+bool AlertStore::readLocked(uint64_t id, AlertRecord& record) const {
+    if (id < firstId_ || id >= nextId_) {
+        return false;
+    }
+
+    size_t slot = slotOf(id);
+    record.id = id;
+    record.type = static_cast<AlertType>(types_[slot]);
+    record.timestampMs = timestamps_[slot];
+    record.querySource = strings_->handleOf(querySourceIds_[slot]);
+    record.title = strings_->handleOf(titleIds_[slot]);
+    record.message = std::string_view(messages_[slot].data, messages_[slot].length);
+    record.rawResult = std::string_view(rawResults_[slot].data, rawResults_[slot].length);
+    record.fingerprint = fingerprints_[slot];
+    record.similarityKey = similarityKeys_[slot];
+    return true;
+}
+
+AlertStore::Span AlertStore::storeString(const std::string& value, uint64_t id) {
+    Span span;
+    if (value.empty()) {
+        return span;
+    }
+
+    if (chunks_.empty() || chunks_.back()->capacity - chunks_.back()->used < value.size()) {
+        auto chunk = std::make_shared<ArenaChunk>();
+        chunk->capacity = std::max(kChunkSize, value.size());
+        chunk->data.reset(new char[chunk->capacity]);
+        chunks_.push_back(std::move(chunk));
+    }
+
+    ArenaChunk& chunk = *chunks_.back();
+    char* destination = chunk.data.get() + chunk.used;
+    std::memcpy(destination, value.data(), value.size());
+    chunk.used += value.size();
+    chunk.lastId = id;
+
+    span.data = destination;
+    span.length = static_cast<uint32_t>(std::min<size_t>(value.size(), UINT32_MAX));
+    return span;
+}
+
+void AlertStore::evictFrontLocked() {
+    if (evictionHandler_) {
+        AlertRecord record;
+        if (readLocked(firstId_, record)) {
+            evictionHandler_(record);
+        }
+    }
+
+    size_t typeIndex = types_[headSlot_];
+    if (typeIndex < kTypeCount && typeCounts_[typeIndex] > 0) {
+        typeCounts_[typeIndex]--;
+    }
+
+    messages_[headSlot_] = Span();
+    rawResults_[headSlot_] = Span();
+    headSlot_ = (headSlot_ + 1) % capacity_;
+    firstId_++;
+}
+
+void AlertStore::releaseChunksLocked() {
+    // Chunks are filled in id order, so once the front one holds only evicted
+    // rows it can go; snapshots still holding it keep the memory alive
+    while (chunks_.size() > 1 && chunks_.front()->lastId < firstId_) {
+        chunks_.pop_front();
+    }
+}
+
+AlertSnapshot AlertStore::makeSnapshotLocked(uint64_t first) const {
+    AlertSnapshot view;
+    view.store_ = this;
+    view.first_ = std::max(first, firstId_);
+    view.end_ = nextId_;
+    view.chunks_.assign(chunks_.begin(), chunks_.end());
+    return view;
+}
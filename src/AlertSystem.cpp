@@ -1,42 +1,85 @@
 #include "AlertSystem.h"
+#include "AlertDispatcher.h"
+#include "AlertJournal.h"
+#include "Fingerprint.h"
 #include <algorithm>
 #include <cctype>
+#include <limits>
 #include <QDebug>
 
+namespace {
+const int kCriticalCategory = 0;
+const int kWarningCategory = 1;
+const uint32_t kCriticalBit = uint32_t(1) << kCriticalCategory;
+const uint32_t kWarningBit = uint32_t(1) << kWarningCategory;
+}
+
+const char* const AlertSystem::DEFAULT_CRITICAL_KEYWORDS = "error,fail,critical,breach";
+const char* const AlertSystem::DEFAULT_WARNING_KEYWORDS = "warning,alert,unusual";
+
 AlertSystem::AlertSystem()
-    : nextAlertId_(1)
+    : store_(1000)
     , duplicateDetectionEnabled_(true)
     , duplicateTimeWindow_(30)
-    , maxAlerts_(1000) {
+    , maxAlerts_(1000)
+    , journal_(nullptr)
+    , dispatcher_(nullptr) {
+    // Every eviction path runs with alertsMutex_ held, so the indexes are safe to touch
+    store_.setEvictionHandler([this](const AlertRecord& record) {
+        unindexAlert(record);
+    });
+
+    setClassificationKeywords(KeywordMatcher::splitList(DEFAULT_CRITICAL_KEYWORDS),
+                              KeywordMatcher::splitList(DEFAULT_WARNING_KEYWORDS));
 }
 
 int AlertSystem::addAlert(const Alert& alert) {
+    Alert newAlert = alert;
+
+    // With both handles in our table, the comparisons below are pointer checks
+    std::shared_ptr<StringInterner> strings = store_.strings();
+    newAlert.title = strings->adopt(newAlert.title);
+    newAlert.querySource = strings->adopt(newAlert.querySource);
+
+    newAlert.fingerprint = computeFingerprint(newAlert);
+    newAlert.similarityKey = computeSimilarityKey(newAlert);
+
     std::lock_guard<std::mutex> lock(alertsMutex_);
 
-    if (duplicateDetectionEnabled_ && isDuplicateInternal(alert)) {
+    if (duplicateDetectionEnabled_ && isDuplicateInternal(newAlert, duplicateTimeWindow_)) {
         return -1;  // Duplicate alert not added
     }
 
-    Alert newAlert = alert;
-    newAlert.id = nextAlertId_++;
-    newAlert.timestamp = QDateTime::currentDateTime();
+    // Keep the timestamp column sorted even if the wall clock steps back
+    int64_t timestampMs = std::max<int64_t>(QDateTime::currentMSecsSinceEpoch(), store_.lastTimestamp());
 
-    alerts_.push_back(newAlert);
+    // A full store evicts its oldest alert here
+    newAlert.id = static_cast<int>(store_.append(newAlert, timestampMs));
+    indexAlert(newAlert.id, newAlert);
 
-    // Enforce maximum alert limit
-    if (alerts_.size() > static_cast<size_t>(maxAlerts_)) {
-        removeOldestAlerts(alerts_.size() - maxAlerts_);
+    // Queued under the lock so journal order matches store order
+    if (journal_) {
+        journal_->append(newAlert, timestampMs);
+    }
+    if (dispatcher_) {
+        dispatcher_->publish(newAlert, timestampMs);
     }
 
     qDebug() << "Added alert:" << newAlert.title.c_str()
              << "Type:" << newAlert.getTypeString().c_str()
-             << "Total alerts:" << alerts_.size();
+             << "Total alerts:" << store_.size();
 
     return newAlert.id;
 }
 
 int AlertSystem::addAlert(AlertType type, const std::string& title, const std::string& message,
                          const std::string& querySource, const std::string& rawResult) {
+    std::shared_ptr<StringInterner> strings = store_.strings();
+    return addAlert(type, strings->handle(title), message, strings->handle(querySource), rawResult);
+}
+
+int AlertSystem::addAlert(AlertType type, InternedString title, const std::string& message,
+                          InternedString querySource, const std::string& rawResult) {
     Alert alert;
     alert.type = type;
     alert.title = title;
@@ -47,6 +90,15 @@ int AlertSystem::addAlert(AlertType type, const std::string& title, const std::s
     return addAlert(alert);
 }
 
+void AlertSystem::setStringTable(std::shared_ptr<StringInterner> strings) {
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    store_.setStringTable(std::move(strings));
+}
+
+std::shared_ptr<StringInterner> AlertSystem::stringTable() const {
+    return store_.strings();
+}
+
 AlertType AlertSystem::classifyAlert(const std::string& alertTypeStr, const pqxx::result& result) {
     std::string lowerType = alertTypeStr;
     std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(), ::tolower);
@@ -64,28 +116,32 @@ AlertType AlertSystem::classifyAlert(const std::string& alertTypeStr, const pqxx
         return AlertType::INFO;
     }
 
-    // Check for keywords in result content
+    std::shared_ptr<const KeywordMatcher> keywords;
+    {
+        std::lock_guard<std::mutex> lock(alertsMutex_);
+        keywords = keywords_;
+    }
+
+    // One pass over each field's raw bytes; a critical keyword decides the result outright
     bool hasCriticalKeywords = false;
     bool hasWarningKeywords = false;
 
     for (const auto& row : result) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            std::string value = row[i].as<std::string>();
-            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
-
-            if (value.find("error") != std::string::npos ||
-                value.find("fail") != std::string::npos ||
-                value.find("critical") != std::string::npos ||
-                value.find("breach") != std::string::npos) {
-                hasCriticalKeywords = true;
+        for (const auto& field : row) {
+            if (field.is_null()) {
+                continue;
             }
 
-            if (value.find("warning") != std::string::npos ||
-                value.find("alert") != std::string::npos ||
-                value.find("unusual") != std::string::npos) {
-                hasWarningKeywords = true;
+            uint32_t found = keywords->scan(field.c_str(), field.size(), kCriticalBit);
+            hasWarningKeywords = hasWarningKeywords || (found & kWarningBit);
+            if (found & kCriticalBit) {
+                hasCriticalKeywords = true;
+                break;
             }
         }
+        if (hasCriticalKeywords) {
+            break;
+        }
     }
 
     if (hasCriticalKeywords) {
@@ -97,25 +153,31 @@ AlertType AlertSystem::classifyAlert(const std::string& alertTypeStr, const pqxx
     return AlertType::INFO;
 }
 
-AlertType AlertSystem::classifyFromThreshold(const pqxx::result& result, int threshold, AlertType defaultType) {
-    if (result.empty()) {
+void AlertSystem::setClassificationKeywords(const std::vector<std::string>& critical,
+                                            const std::vector<std::string>& warning) {
+    auto keywords = std::make_shared<KeywordMatcher>();
+    for (const auto& keyword : critical) {
+        keywords->add(keyword, kCriticalCategory);
+    }
+    for (const auto& keyword : warning) {
+        keywords->add(keyword, kWarningCategory);
+    }
+    keywords->compile();
+
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    keywords_ = std::move(keywords);
+}
+
+AlertType AlertSystem::classifyFromThreshold(const ResultSummary& summary, int threshold, AlertType defaultType) {
+    if (summary.empty()) {
         return AlertType::INFO;
     }
 
-    if (result.size() >= 2) {
-        // If result has multiple rows, try to get a count
-        try {
-            const auto& firstRow = result[0];
-            if (firstRow.size() > 0) {
-                std::string firstValue = firstRow[0].as<std::string>();
-                // Try to parse as integer
-                int count = std::stoi(firstValue);
-                if (count >= threshold) {
-                    return (count >= threshold * 2) ? AlertType::CRITICAL : AlertType::WARNING;
-                }
-            }
-        } catch (const std::exception&) {
-            // Not a number, use default type
+    // A numeric first value is taken as a count, whether it is a single COUNT(*) row or heads a list
+    if (summary.firstCount) {
+        int count = *summary.firstCount;
+        if (count >= threshold) {
+            return (count >= threshold * 2) ? AlertType::CRITICAL : AlertType::WARNING;
         }
     }
 
@@ -123,131 +185,181 @@ AlertType AlertSystem::classifyFromThreshold(const pqxx::result& result, int thr
 }
 
 bool AlertSystem::isDuplicate(const Alert& alert, int timeWindowSeconds) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+    Alert candidate = alert;
+    std::shared_ptr<StringInterner> strings = store_.strings();
+    candidate.title = strings->adopt(candidate.title);
+    candidate.querySource = strings->adopt(candidate.querySource);
+    candidate.fingerprint = computeFingerprint(candidate);
 
-    int originalWindow = duplicateTimeWindow_;
-    duplicateTimeWindow_ = timeWindowSeconds;
-    bool result = isDuplicateInternal(alert);
-    duplicateTimeWindow_ = originalWindow;
-
-    return result;
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    return isDuplicateInternal(candidate, timeWindowSeconds);
 }
 
 bool AlertSystem::isSimilar(const Alert& alert, int timeWindowSeconds) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+    uint64_t key = computeSimilarityKey(alert);
 
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-timeWindowSeconds);
+    std::lock_guard<std::mutex> lock(alertsMutex_);
 
-    for (const auto& existingAlert : alerts_) {
-        if (existingAlert.timestamp < cutoff) {
-            continue;
-        }
+    auto it = similarityIndex_.find(key);
+    if (it == similarityIndex_.end()) {
+        return false;
+    }
 
-        if (existingAlert.type == alert.type &&
-            existingAlert.querySource == alert.querySource &&
-            existingAlert.title == alert.title) {
-            return true;
-        }
+    // The index holds the newest match, so if it is outside the window so are the rest
+    AlertRecord existing;
+    if (!store_.read(it->second, existing)) {
+        return false;
     }
 
-    return false;
+    int64_t cutoffMs = QDateTime::currentMSecsSinceEpoch() - timeWindowSeconds * 1000LL;
+
+    return existing.timestampMs >= cutoffMs &&
+           existing.type == alert.type &&
+           existing.querySource == alert.querySource &&
+           existing.title == alert.title;
 }
 
 std::vector<Alert> AlertSystem::getRecentAlerts(int maxCount) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+    AlertSnapshot view = store_.snapshotLatest(std::max(0, maxCount));
 
     std::vector<Alert> recentAlerts;
-    int count = 0;
-
-    // Iterate from newest to oldest
-    auto it = alerts_.rbegin();
-    while (it != alerts_.rend() && count < maxCount) {
-        recentAlerts.insert(recentAlerts.begin(), *it);
-        ++it;
-        ++count;
+    recentAlerts.reserve(view.size());
+
+    // Oldest to newest
+    AlertRecord record;
+    for (size_t i = 0; i < view.size(); ++i) {
+        if (view.at(i, record)) {
+            recentAlerts.push_back(record.toAlert());
+        }
     }
 
     return recentAlerts;
 }
 
 std::vector<Alert> AlertSystem::getAlertsByType(AlertType type, int maxCount) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+    AlertSnapshot view = store_.snapshot();
 
     std::vector<Alert> filteredAlerts;
-    int count = 0;
+    AlertRecord record;
 
-    auto it = alerts_.rbegin();
-    while (it != alerts_.rend() && count < maxCount) {
-        if (it->type == type) {
-            filteredAlerts.insert(filteredAlerts.begin(), *it);
-            ++count;
+    // Walk back from the newest and keep the latest maxCount matches
+    for (uint64_t id = view.endId(); id > view.firstId() &&
+         filteredAlerts.size() < static_cast<size_t>(std::max(0, maxCount)); --id) {
+        if (view.read(id - 1, record) && record.type == type) {
+            filteredAlerts.push_back(record.toAlert());
         }
-        ++it;
     }
 
+    std::reverse(filteredAlerts.begin(), filteredAlerts.end());
     return filteredAlerts;
 }
 
 std::vector<Alert> AlertSystem::getAlertsSince(const QDateTime& since) {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
+    AlertSnapshot view = snapshotSince(since);
 
     std::vector<Alert> recentAlerts;
+    recentAlerts.reserve(view.size());
 
-    for (const auto& alert : alerts_) {
-        if (alert.timestamp >= since) {
-            recentAlerts.insert(recentAlerts.begin(), alert);
+    // Newest first
+    AlertRecord record;
+    for (uint64_t id = view.endId(); id > view.firstId(); --id) {
+        if (view.read(id - 1, record)) {
+            recentAlerts.push_back(record.toAlert());
         }
     }
 
+    // The journal only has to cover what the store no longer holds
+    AlertJournal* journal = this->journal();
+    if (!journal || (view.empty() ? store_.size() > 0 : view.firstId() > store_.firstId())) {
+        return recentAlerts;
+    }
+
+    // A burst can share the oldest retained alert's millisecond with alerts
+    // already evicted, so the journal is read through that millisecond. It
+    // is written in store order, so the last of its alerts there are the
+    // ones the store still holds.
+    int64_t oldestRetained = std::numeric_limits<int64_t>::max();
+    size_t retainedInBoundary = 0;
+    if (!view.empty() && view.read(view.firstId(), record)) {
+        oldestRetained = record.timestampMs;
+        for (uint64_t id = view.firstId(); id < view.endId() && view.read(id, record) &&
+             record.timestampMs == oldestRetained; ++id) {
+            retainedInBoundary++;
+        }
+    }
+
+    uint64_t from = journal->findSequenceAt(since.toMSecsSinceEpoch());
+    uint64_t to = retainedInBoundary > 0 ? journal->findSequenceAt(oldestRetained + 1)
+                                         : journal->findSequenceAt(oldestRetained);
+    if (from >= to) {
+        return recentAlerts;
+    }
+
+    std::shared_ptr<StringInterner> strings = store_.strings();
+    journal->readBackward(to, static_cast<size_t>(to - from), [&](const JournalEntry& entry) {
+        if (retainedInBoundary > 0 && entry.timestampMs == oldestRetained) {
+            retainedInBoundary--;
+            return true;
+        }
+        Alert alert(0, entry.type, strings->handle(entry.title), std::string(entry.message),
+                    strings->handle(entry.querySource), std::string(entry.rawResult));
+        alert.timestamp = QDateTime::fromMSecsSinceEpoch(entry.timestampMs);
+        recentAlerts.push_back(std::move(alert));
+        return true;
+    });
+
     return recentAlerts;
 }
 
+AlertSnapshot AlertSystem::snapshot() const {
+    return store_.snapshot();
+}
+
+AlertSnapshot AlertSystem::snapshotLatest(int maxCount) const {
+    return store_.snapshotLatest(std::max(0, maxCount));
+}
+
+AlertSnapshot AlertSystem::snapshotSince(const QDateTime& since) const {
+    return store_.snapshotSince(since.toMSecsSinceEpoch());
+}
+
+bool AlertSystem::readAlert(int id, AlertRecord& record) const {
+    return id > 0 && store_.read(static_cast<uint64_t>(id), record);
+}
+
 void AlertSystem::cleanupOldAlerts(int maxAgeSeconds) {
     std::lock_guard<std::mutex> lock(alertsMutex_);
 
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-maxAgeSeconds);
-
-    alerts_.erase(
-        std::remove_if(alerts_.begin(), alerts_.end(),
-                      [cutoff](const Alert& alert) {
-                          return alert.timestamp < cutoff;
-                      }),
-        alerts_.end()
-    );
+    int64_t cutoffMs = QDateTime::currentMSecsSinceEpoch() - maxAgeSeconds * 1000LL;
+    store_.evictBefore(cutoffMs);
 
-    qDebug() << "Cleaned up old alerts, remaining:" << alerts_.size();
+    qDebug() << "Cleaned up old alerts, remaining:" << store_.size();
 }
 
 void AlertSystem::enforceMaxAlerts(int maxAlerts) {
     std::lock_guard<std::mutex> lock(alertsMutex_);
 
-    if (alerts_.size() > static_cast<size_t>(maxAlerts)) {
-        removeOldestAlerts(alerts_.size() - maxAlerts);
+    size_t limit = static_cast<size_t>(std::max(0, maxAlerts));
+    size_t count = store_.size();
+    if (count > limit) {
+        store_.evictOldest(count - limit);
     }
 }
 
 int AlertSystem::getAlertCount() const {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
-    return static_cast<int>(alerts_.size());
+    return static_cast<int>(store_.size());
 }
 
 int AlertSystem::getAlertCountByType(AlertType type) const {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
-
-    return std::count_if(alerts_.begin(), alerts_.end(),
-                        [type](const Alert& alert) {
-                            return alert.type == type;
-                        });
+    return static_cast<int>(store_.countByType(type));
 }
 
 QDateTime AlertSystem::getLastAlertTime() const {
-    std::lock_guard<std::mutex> lock(alertsMutex_);
-
-    if (alerts_.empty()) {
+    if (store_.size() == 0) {
         return QDateTime();
     }
 
-    return alerts_.back().timestamp;
+    return QDateTime::fromMSecsSinceEpoch(store_.lastTimestamp());
 }
 
 void AlertSystem::setDuplicateDetectionEnabled(bool enabled) {
@@ -259,54 +371,88 @@ void AlertSystem::setDuplicateTimeWindow(int seconds) {
 }
 
 void AlertSystem::setMaxAlerts(int maxAlerts) {
-    maxAlerts_ = maxAlerts;
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+
+    maxAlerts_ = std::max(1, maxAlerts);
+    store_.setCapacity(static_cast<size_t>(maxAlerts_));
 }
 
-bool AlertSystem::isDuplicateInternal(const Alert& alert) {
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-duplicateTimeWindow_);
+void AlertSystem::setJournal(AlertJournal* journal) {
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    journal_ = journal;
+}
 
-    for (const auto& existingAlert : alerts_) {
-        if (existingAlert.timestamp < cutoff) {
-            continue;
-        }
+AlertJournal* AlertSystem::journal() const {
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    return journal_;
+}
 
-        if (existingAlert.type == alert.type &&
-            existingAlert.querySource == alert.querySource &&
-            existingAlert.title == alert.title &&
-            existingAlert.message == alert.message) {
-            return true;
-        }
-    }
+void AlertSystem::setDispatcher(AlertDispatcher* dispatcher) {
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    dispatcher_ = dispatcher;
+}
 
-    return false;
+AlertDispatcher* AlertSystem::dispatcher() const {
+    std::lock_guard<std::mutex> lock(alertsMutex_);
+    return dispatcher_;
 }
 
-bool AlertSystem::isSimilarInternal(const Alert& alert) {
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-duplicateTimeWindow_);
+bool AlertSystem::isDuplicateInternal(const Alert& alert, int timeWindowSeconds) const {
+    auto it = fingerprintIndex_.find(alert.fingerprint);
+    if (it == fingerprintIndex_.end()) {
+        return false;
+    }
 
-    for (const auto& existingAlert : alerts_) {
-        if (existingAlert.timestamp < cutoff) {
-            continue;
-        }
+    AlertRecord existing;
+    if (!store_.read(it->second, existing)) {
+        return false;
+    }
 
-        if (existingAlert.type == alert.type &&
-            existingAlert.querySource == alert.querySource) {
-            return true;
-        }
+    int64_t cutoffMs = QDateTime::currentMSecsSinceEpoch() - timeWindowSeconds * 1000LL;
+    if (existing.timestampMs < cutoffMs) {
+        return false;
     }
 
-    return false;
+    // Compare the fields too so a hash collision can't swallow a real alert
+    return existing.type == alert.type &&
+           existing.querySource == alert.querySource &&
+           existing.title == alert.title &&
+           existing.message == alert.message;
 }
 
-void AlertSystem::removeOldestAlerts(int removeCount) {
-    if (removeCount <= 0) {
-        return;
-    }
+uint64_t AlertSystem::computeFingerprint(const Alert& alert) {
+    Fingerprint fingerprint;
+    fingerprint.updateValue(static_cast<uint64_t>(alert.type));
+    fingerprint.updateField(alert.querySource.str());
+    fingerprint.updateField(alert.title.str());
+    fingerprint.updateField(alert.message);
+    return fingerprint.digest();
+}
+
+uint64_t AlertSystem::computeSimilarityKey(const Alert& alert) {
+    Fingerprint fingerprint;
+    fingerprint.updateValue(static_cast<uint64_t>(alert.type));
+    fingerprint.updateField(alert.querySource.str());
+    fingerprint.updateField(alert.title.str());
+    return fingerprint.digest();
+}
 
-    if (removeCount >= static_cast<int>(alerts_.size())) {
-        alerts_.clear();
-        return;
+void AlertSystem::indexAlert(int id, const Alert& alert) {
+    fingerprintIndex_[alert.fingerprint] = id;
+    similarityIndex_[alert.similarityKey] = id;
+}
+
+void AlertSystem::unindexAlert(const AlertRecord& record) {
+    int id = static_cast<int>(record.id);
+
+    // Only drop the entry if no newer alert has taken it over
+    auto fingerprint = fingerprintIndex_.find(record.fingerprint);
+    if (fingerprint != fingerprintIndex_.end() && fingerprint->second == id) {
+        fingerprintIndex_.erase(fingerprint);
     }
 
-    alerts_.erase(alerts_.begin(), alerts_.begin() + removeCount);
-}
\ No newline at end of file
+    auto similarity = similarityIndex_.find(record.similarityKey);
+    if (similarity != similarityIndex_.end() && similarity->second == id) {
+        similarityIndex_.erase(similarity);
+    }
+}
@@ -1,4 +1,7 @@
 #include "AlertWindow.h"
+#include "ConfigManager.h"
+#include "AlertJournal.h"
+#include "QueryEngine.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QInputDialog>
@@ -6,9 +9,13 @@
 #include <QTextStream>
 #include <QFile>
 #include <QCloseEvent>
+#include <QPaintEvent>
 #include <QHeaderView>
 #include <QClipboard>
+#include <QDialogButtonBox>
 #include <QGuiApplication>
+#include <QScrollBar>
+#include <algorithm>
 
 AlertWindow::AlertWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -17,15 +24,18 @@ AlertWindow::AlertWindow(QWidget *parent)
     , leftPanel_(nullptr)
     , rightPanel_(nullptr)
     , alertList_(nullptr)
+    , alertModel_(nullptr)
     , alertDetails_(nullptr)
     , filterGroup_(nullptr)
     , showCritical_(nullptr)
     , showWarning_(nullptr)
     , showInfo_(nullptr)
     , searchBox_(nullptr)
+    , searchDebounce_(nullptr)
     , connectionStatusLabel_(nullptr)
     , lastUpdateLabel_(nullptr)
     , alertCountLabel_(nullptr)
+    , latencyLabel_(nullptr)
     , connectionProgressBar_(nullptr)
     , fileMenu_(nullptr)
     , viewMenu_(nullptr)
@@ -37,18 +47,38 @@ AlertWindow::AlertWindow(QWidget *parent)
     , exportAction_(nullptr)
     , clearAction_(nullptr)
     , refreshAction_(nullptr)
+    , historyAction_(nullptr)
     , aboutAction_(nullptr)
     , exitAction_(nullptr)
+    , alertSystem_(nullptr)
+    , databaseManager_(nullptr)
+    , configManager_(nullptr)
+    , queryEngine_(nullptr)
     , isMonitoring_(false)
     , isConnected_(false)
+    , firstFrameShown_(false)
+    , flushTimer_(new QTimer(this))
+    , frameIntervalMs_(1000 / 30)
+    , pendingAlerts_(0)
+    , lastFlushSize_(0)
+    , flushCount_(0)
+    , latencyTimer_(new QTimer(this))
+    , exporter_(nullptr)
+    , exportProgress_(nullptr)
 {
-    alertSystem_ = std::make_unique<AlertSystem>();
-    databaseManager_ = std::make_unique<DatabaseManager>();
+    ownedAlertSystem_ = std::make_unique<AlertSystem>();
+    alertSystem_ = ownedAlertSystem_.get();
 
     setupUI();
     createActions();
     connectSignals();
 
+    flushTimer_->setSingleShot(true);
+    connect(flushTimer_, &QTimer::timeout, this, &AlertWindow::flushPendingAlerts);
+
+    latencyTimer_->setInterval(1000);
+    connect(latencyTimer_, &QTimer::timeout, this, &AlertWindow::updateLatencyStatus);
+
     setWindowTitle("PostgreSQL Monitor - Alert Dashboard");
     setMinimumSize(800, 600);
     resize(1200, 800);
@@ -151,25 +181,38 @@ void AlertWindow::setupFilterPanel() {
     connect(showCritical_, &QCheckBox::toggled, this, &AlertWindow::onFilterChanged);
     connect(showWarning_, &QCheckBox::toggled, this, &AlertWindow::onFilterChanged);
     connect(showInfo_, &QCheckBox::toggled, this, &AlertWindow::onFilterChanged);
-    connect(searchBox_, &QLineEdit::textChanged, this, &AlertWindow::onFilterChanged);
+
+    // Typing re-filters once the keystrokes pause, not on every key
+    searchDebounce_ = new QTimer(this);
+    searchDebounce_->setSingleShot(true);
+    searchDebounce_->setInterval(150);
+    connect(searchDebounce_, &QTimer::timeout, this, &AlertWindow::onFilterChanged);
+    connect(searchBox_, &QLineEdit::textChanged, searchDebounce_, [this]() {
+        searchDebounce_->start();
+    });
 }
 
 void AlertWindow::setupAlertList() {
-    alertList_ = new QListWidget();
-    alertList_->setAlternatingRowColors(true);
+    alertModel_ = new AlertListModel(alertSystem_, this);
+
+    alertList_ = new QListView();
+    alertList_->setModel(alertModel_);
+    alertList_->setItemDelegate(new AlertItemDelegate(alertList_));
     alertList_->setSelectionMode(QAbstractItemView::SingleSelection);
     alertList_->setContextMenuPolicy(Qt::CustomContextMenu);
 
+    // Every row has the same height, so the view never measures rows it doesn't show
+    alertList_->setUniformItemSizes(true);
+    alertList_->setLayoutMode(QListView::Batched);
+
     QFont font = alertList_->font();
     font.setPointSize(10);
     alertList_->setFont(font);
 
-    connect(alertList_, &QListWidget::itemDoubleClicked, this, &AlertWindow::onAlertItemDoubleClicked);
-    connect(alertList_, &QListWidget::itemSelectionChanged, this, [this]() {
-        auto items = alertList_->selectedItems();
-        if (!items.empty()) {
-            showAlertDetails(items.first());
-        }
+    connect(alertList_, &QListView::doubleClicked, this, &AlertWindow::onAlertItemDoubleClicked);
+    connect(alertList_->selectionModel(), &QItemSelectionModel::currentChanged, this,
+            [this](const QModelIndex& current) {
+        showAlertDetails(current);
     });
 }
 
@@ -177,12 +220,15 @@ void AlertWindow::setupStatusBar() {
     connectionStatusLabel_ = new QLabel("Disconnected");
     lastUpdateLabel_ = new QLabel("Last update: Never");
     alertCountLabel_ = new QLabel("Alerts: 0");
+    latencyLabel_ = new QLabel();
+    latencyLabel_->setVisible(false);
     connectionProgressBar_ = new QProgressBar();
     connectionProgressBar_->setVisible(false);
     connectionProgressBar_->setMaximumWidth(200);
 
     statusBar()->addWidget(connectionStatusLabel_);
     statusBar()->addWidget(connectionProgressBar_);
+    statusBar()->addPermanentWidget(latencyLabel_);
     statusBar()->addPermanentWidget(lastUpdateLabel_);
     statusBar()->addPermanentWidget(alertCountLabel_);
 }
@@ -212,6 +258,12 @@ void AlertWindow::createActions() {
     viewMenu_->addAction(showDetailsAction);
     connect(showDetailsAction, &QAction::toggled, rightPanel_, &QWidget::setVisible);
 
+    historyAction_ = new QAction("Alert &History...", this);
+    historyAction_->setShortcut(QKeySequence("Ctrl+H"));
+    historyAction_->setStatusTip("Browse alerts saved in the journal");
+    historyAction_->setEnabled(false);
+    viewMenu_->addAction(historyAction_);
+
     // Tools menu
     startAction_ = new QAction("&Start Monitoring", this);
     startAction_->setShortcut(QKeySequence("F5"));
@@ -230,7 +282,7 @@ void AlertWindow::createActions() {
     toolsMenu_->addAction(refreshAction_);
 
     toolsMenu_->addSeparator();
-    settingsAction_ = new Action("&Settings...", this);
+    settingsAction_ = new QAction("&Settings...", this);
     settingsAction_->setShortcut(QKeySequence("Ctrl+,"));
     settingsAction_->setStatusTip("Configure application settings");
     toolsMenu_->addAction(settingsAction_);
@@ -249,64 +301,153 @@ void AlertWindow::connectSignals() {
     connect(exportAction_, &QAction::triggered, this, &AlertWindow::exportAlerts);
     connect(clearAction_, &QAction::triggered, this, &AlertWindow::clearAllAlerts);
     connect(refreshAction_, &QAction::triggered, this, &AlertWindow::refreshConnection);
+    connect(historyAction_, &QAction::triggered, this, &AlertWindow::showHistory);
 }
 
 bool AlertWindow::connectToDatabase(const DatabaseManager::ConnectionConfig& config) {
-    try {
-        if (databaseManager_->connect(config)) {
-            isConnected_ = true;
-            updateConnectionStatus(true);
-            return true;
-        } else {
-            QMessageBox::warning(this, "Connection Error",
-                                "Failed to connect to database:\n" +
-                                QString::fromStdString(databaseManager_->getLastError()));
-            return false;
-        }
-    } catch (const std::exception& e) {
-        QMessageBox::critical(this, "Connection Error",
-                            "Database connection failed:\n" + QString(e.what()));
+    DatabaseManager* manager = database();
+    if (!manager->connectAsync(config)) {
+        statusBar()->showMessage("Failed to connect to database: " +
+                                 QString::fromStdString(manager->getLastError()), 5000);
         return false;
     }
+
+    connect(manager, &DatabaseManager::connectFinished, this, [this, manager](bool connected) {
+        if (connected) {
+            statusBar()->showMessage("Connected to database", 3000);
+        } else {
+            statusBar()->showMessage("Failed to connect to database: " +
+                                     QString::fromStdString(manager->getLastError()), 5000);
+        }
+    }, Qt::SingleShotConnection);
+    return true;
 }
 
 void AlertWindow::disconnectFromDatabase() {
-    databaseManager_->disconnect();
+    if (databaseManager_) {
+        databaseManager_->disconnect();
+    }
     isConnected_ = false;
     updateConnectionStatus(false);
 }
 
 bool AlertWindow::isDatabaseConnected() const {
-    return isConnected_ && databaseManager_->isConnected();
+    return isConnected_ && databaseManager_ && databaseManager_->isConnected();
 }
 
-void AlertWindow::updateAlertDisplay() {
-    auto alerts = alertSystem_->getRecentAlerts();
+void AlertWindow::setDatabaseManager(DatabaseManager* databaseManager) {
+    if (databaseManager_) {
+        QObject::disconnect(databaseManager_, nullptr, this, nullptr);
+    }
 
-    alertList_->clear();
+    databaseManager_ = databaseManager;
+    if (databaseManager_) {
+        connect(databaseManager_, &DatabaseManager::connectProgress, this, &AlertWindow::onConnectProgress);
+        connect(databaseManager_, &DatabaseManager::connectFinished, this, &AlertWindow::onConnectFinished);
+    }
+}
 
-    for (const auto& alert : alerts) {
-        if (shouldShowAlert(alert)) {
-            QListWidgetItem* item = createAlertItem(alert);
-            alertList_->addItem(item);
-        }
+DatabaseManager* AlertWindow::database() {
+    // Only needed once the user connects or opens the settings
+    if (!databaseManager_) {
+        ownedDatabaseManager_ = std::make_unique<DatabaseManager>();
+        setDatabaseManager(ownedDatabaseManager_.get());
+    }
+    return databaseManager_;
+}
+
+void AlertWindow::setAlertSystem(AlertSystem* alertSystem) {
+    alertSystem_ = alertSystem ? alertSystem : ownedAlertSystem_.get();
+    alertModel_->setAlertSystem(alertSystem_);
+    historyAction_->setEnabled(alertSystem_->journal() != nullptr);
+    updateStatusBar();
+}
+
+void AlertWindow::setQueryEngine(QueryEngine* queryEngine) {
+    queryEngine_ = queryEngine;
+    latencyLabel_->setVisible(queryEngine_ != nullptr);
+    if (queryEngine_) {
+        latencyTimer_->start();
+        updateLatencyStatus();
+    } else {
+        latencyTimer_->stop();
     }
+}
 
+void AlertWindow::updateAlertDisplay() {
+    alertModel_->setFilter(showCritical_->isChecked(), showWarning_->isChecked(),
+                           showInfo_->isChecked(), searchBox_->text());
     updateStatusBar();
 }
 
 void AlertWindow::addAlertToUI(const Alert& alert) {
-    if (shouldShowAlert(alert)) {
-        QListWidgetItem* item = createAlertItem(alert);
-        alertList_->insertItem(0, item);
+    // Without a shared store the window keeps its own copy of each alert
+    if (alertSystem_ == ownedAlertSystem_.get()) {
+        alertSystem_->addAlert(alert);
+    }
+
+    pendingAlerts_++;
+    scheduleFlush();
+}
+
+void AlertWindow::scheduleFlush() {
+    if (flushTimer_->isActive()) {
+        return;  // Already coming up in this frame
+    }
+
+    // A quiet period means the first alert shows at once; a burst waits out the frame
+    int elapsed = sinceLastFlush_.isValid() ? static_cast<int>(sinceLastFlush_.elapsed()) : frameIntervalMs_;
+    flushTimer_->start(std::max(0, frameIntervalMs_ - elapsed));
+}
+
+void AlertWindow::flushPendingAlerts() {
+    sinceLastFlush_.start();
+    lastFlushSize_ = pendingAlerts_;
+    pendingAlerts_ = 0;
+    flushCount_++;
+
+    // One refresh inserts every alert that arrived since the last frame
+    bool atTop = alertList_->verticalScrollBar()->value() == 0;
+    alertModel_->refresh();
+    if (atTop) {
         alertList_->scrollToTop();
     }
     updateStatusBar();
 }
 
+void AlertWindow::setMaxRefreshRate(int updatesPerSecond) {
+    frameIntervalMs_ = updatesPerSecond > 0 ? 1000 / std::min(updatesPerSecond, 1000) : 0;
+}
+
+int AlertWindow::getPendingAlertCount() const {
+    return pendingAlerts_;
+}
+
+int AlertWindow::getDroppedRenderCount() const {
+    return static_cast<int>(alertModel_->droppedAlertCount());
+}
+
+int AlertWindow::getFlushCount() const {
+    return flushCount_;
+}
+
+void AlertWindow::setConfigManager(ConfigManager* configManager) {
+    configManager_ = configManager;
+    if (configManager_) {
+        setMaxRefreshRate(configManager_->getUIConfig().maxRefreshRate);
+    }
+}
+
+ConfigManager* AlertWindow::getConfigManager() const {
+    return configManager_;
+}
+
 void AlertWindow::clearAlerts() {
-    alertList_->clear();
     alertSystem_->enforceMaxAlerts(0);  // Clear all
+    flushTimer_->stop();
+    pendingAlerts_ = 0;
+    alertModel_->reload();
+    alertDetails_->clear();
     updateStatusBar();
 }
 
@@ -341,6 +482,51 @@ void AlertWindow::onDatabaseError(const QString& error) {
     updateConnectionStatus(false);
 }
 
+void AlertWindow::onConfigChanged() {
+    if (configManager_) {
+        setMaxRefreshRate(configManager_->getUIConfig().maxRefreshRate);
+    }
+}
+
+void AlertWindow::onConfigLoaded() {
+    statusBar()->showMessage("Configuration loaded", 3000);
+}
+
+void AlertWindow::onConnectProgress(int opened, int total) {
+    // Busy until the first connection is up, then counts the pool
+    if (opened == 0) {
+        connectionStatusLabel_->setText("Connecting...");
+        connectionStatusLabel_->setStyleSheet("QLabel { color: #f57c00; font-weight: bold; }");
+        connectionProgressBar_->setRange(0, 0);
+    } else {
+        // Pooled connections finish opening in any order
+        connectionProgressBar_->setRange(0, total);
+        connectionProgressBar_->setValue(std::max(opened, connectionProgressBar_->value()));
+    }
+    connectionProgressBar_->setVisible(true);
+}
+
+void AlertWindow::onConnectFinished(bool connected) {
+    connectionProgressBar_->setVisible(false);
+    connectionProgressBar_->setRange(0, 100);
+    connectionProgressBar_->reset();
+    updateConnectionStatus(connected);
+}
+
+void AlertWindow::onMonitoringStarted() {
+    isMonitoring_ = true;
+    startAction_->setEnabled(false);
+    stopAction_->setEnabled(true);
+    updateStatusBar();
+}
+
+void AlertWindow::onMonitoringStopped() {
+    isMonitoring_ = false;
+    startAction_->setEnabled(isConnected_);
+    stopAction_->setEnabled(false);
+    updateStatusBar();
+}
+
 void AlertWindow::startMonitoring() {
     // This will be connected to QueryEngine signals
     isMonitoring_ = true;
@@ -373,37 +559,70 @@ void AlertWindow::showAbout() {
 }
 
 void AlertWindow::exportAlerts() {
-    QString fileName = QFileDialog::getSaveFileName(this, "Export Alerts",
-                                                   "alerts_export.txt",
-                                                   "Text Files (*.txt);;All Files (*)");
-    if (fileName.isEmpty()) {
+    if (exporter_ && exporter_->isRunning()) {
+        QMessageBox::information(this, "Export", "An export is already running.");
         return;
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "Export Error", "Could not open file for writing");
+    ExportDialog options(alertSystem_->journal() != nullptr, this);
+    options.setTypeFilter(showCritical_->isChecked(), showWarning_->isChecked(), showInfo_->isChecked());
+    if (options.exec() != QDialog::Accepted) {
         return;
     }
 
-    QTextStream out(&file);
-    auto alerts = alertSystem_->getRecentAlerts(1000);  // Export up to 1000 alerts
+    ExportRequest request = options.getRequest();
+    QString extension = AlertExporter::fileExtension(request.format);
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Alerts",
+                                                   "alerts_export." + extension,
+                                                   AlertExporter::formatName(request.format) +
+                                                   " (*." + extension + ");;All Files (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    request.filePath = fileName;
+
+    // A fresh exporter each time, so it follows the current alert system
+    delete exporter_;
+    exporter_ = new AlertExporter(alertSystem_, this);
+    connect(exporter_, &AlertExporter::progress, this, &AlertWindow::onExportProgress);
+    connect(exporter_, &AlertExporter::finished, this, &AlertWindow::onExportFinished);
+
+    if (!exportProgress_) {
+        exportProgress_ = new QProgressDialog("Exporting alerts...", "Cancel", 0, 1000, this);
+        exportProgress_->setWindowTitle("Export Alerts");
+        exportProgress_->setMinimumDuration(500);
+        exportProgress_->setAutoReset(false);
+        exportProgress_->setAutoClose(false);
+    }
+    connect(exportProgress_, &QProgressDialog::canceled, exporter_, &AlertExporter::cancel);
+    exportProgress_->setValue(0);
 
-    out << "PostgreSQL Monitor - Alert Export\n";
-    out << "Generated: " << QDateTime::currentDateTime().toString() << "\n";
-    out << "Total Alerts: " << alerts.size() << "\n\n";
+    exportAction_->setEnabled(false);
+    exporter_->start(request);
+    statusBar()->showMessage("Exporting alerts to " + fileName);
+}
 
-    for (const auto& alert : alerts) {
-        out << "ID: " << alert.id << "\n";
-        out << "Type: " << alert.getTypeString().c_str() << "\n";
-        out << "Title: " << alert.title.c_str() << "\n";
-        out << "Message: " << alert.message.c_str() << "\n";
-        out << "Query: " << alert.querySource.c_str() << "\n";
-        out << "Timestamp: " << alert.timestamp.toString("yyyy-MM-dd hh:mm:ss") << "\n";
-        out << "----------------------------------------\n";
+void AlertWindow::onExportProgress(qint64 done, qint64 total) {
+    if (exportProgress_ && total > 0) {
+        exportProgress_->setValue(static_cast<int>(std::min<qint64>(1000, done * 1000 / total)));
     }
+}
 
-    statusBar()->showMessage("Exported " + QString::number(alerts.size()) + " alerts", 3000);
+void AlertWindow::onExportFinished(qint64 exported, bool cancelled, const QString& error) {
+    if (exportProgress_) {
+        exportProgress_->reset();
+        exportProgress_->hide();
+    }
+    exportAction_->setEnabled(true);
+
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "Export Error", error);
+        statusBar()->clearMessage();
+    } else if (cancelled) {
+        statusBar()->showMessage("Export cancelled", 3000);
+    } else {
+        statusBar()->showMessage("Exported " + QString::number(exported) + " alerts", 3000);
+    }
 }
 
 void AlertWindow::clearAllAlerts() {
@@ -417,77 +636,102 @@ void AlertWindow::clearAllAlerts() {
 }
 
 void AlertWindow::refreshConnection() {
-    if (databaseManager_) {
-        connectionProgressBar_->setVisible(true);
-        connectionProgressBar_->setRange(0, 0);  // Indeterminate progress
+    DatabaseManager* manager = database();
+    if (manager->isConnecting()) {
+        statusBar()->showMessage("Already connecting...", 3000);
+        return;
+    }
 
-        QApplication::processEvents();
+    // Reopens the pool in the background; onConnectProgress shows how far it got
+    if (!manager->connectAsync(manager->getConnectionConfig())) {
+        updateConnectionStatus(false);
+        statusBar()->showMessage("Failed to refresh connection: " +
+                                 QString::fromStdString(manager->getLastError()), 5000);
+        return;
+    }
 
-        if (databaseManager_->reconnect()) {
-            updateConnectionStatus(true);
+    connect(manager, &DatabaseManager::connectFinished, this, [this, manager](bool connected) {
+        if (connected) {
             statusBar()->showMessage("Connection refreshed successfully", 3000);
         } else {
-            updateConnectionStatus(false);
-            QMessageBox::warning(this, "Connection Error",
-                                "Failed to refresh connection:\n" +
-                                QString::fromStdString(databaseManager_->getLastError()));
+            statusBar()->showMessage("Failed to refresh connection: " +
+                                     QString::fromStdString(manager->getLastError()), 5000);
         }
-
-        connectionProgressBar_->setVisible(false);
-        connectionProgressBar_->setRange(0, 100);
-    }
+    }, Qt::SingleShotConnection);
 }
 
-void AlertWindow::onAlertItemDoubleClicked(QListWidgetItem* item) {
-    showAlertDetails(item);
+void AlertWindow::onAlertItemDoubleClicked(const QModelIndex& index) {
+    showAlertDetails(index);
 }
 
 void AlertWindow::onFilterChanged() {
     updateFiltering();
 }
 
-void AlertWindow::showAlertDetails(QListWidgetItem* item) {
-    if (!item) {
+void AlertWindow::showAlertDetails(const QModelIndex& index) {
+    AlertRecord record;
+    if (!index.isValid() || !alertModel_->alertAt(index.row(), record)) {
         alertDetails_->clear();
         return;
     }
 
-    QVariant alertVariant = item->data(Qt::UserRole);
-    if (!alertVariant.isValid()) {
+    QString details = QString("Type: %1\nTitle: %2\nQuery: %3\nTime: %4\n\n%5")
+                      .arg(QString::fromStdString(Alert::typeToString(record.type)))
+                      .arg(alertModel_->internedText(record.title))
+                      .arg(alertModel_->internedText(record.querySource))
+                      .arg(QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString("yyyy-MM-dd hh:mm:ss"))
+                      .arg(index.data(AlertListModel::MessageRole).toString());
+
+    QString rawResult = index.data(AlertListModel::RawResultRole).toString();
+    if (!rawResult.isEmpty()) {
+        details += "\n\n" + rawResult;
+    }
+
+    alertDetails_->setPlainText(details);
+}
+
+void AlertWindow::showHistory() {
+    AlertJournal* journal = alertSystem_->journal();
+    if (!journal) {
+        QMessageBox::information(this, "Alert History", "The alert journal is disabled.");
         return;
     }
 
-    // Note: In a real implementation, we'd store Alert object in the item
-    // For now, show item text as details
-    alertDetails_->setPlainText(item->text());
+    AlertHistoryDialog dialog(journal, this);
+    dialog.exec();
 }
 
 void AlertWindow::contextMenuEvent(QContextMenuEvent *event) {
-    QListWidgetItem* item = alertList_->itemAt(event->pos());
+    QModelIndex index = alertList_->indexAt(alertList_->viewport()->mapFromGlobal(event->globalPos()));
 
     QMenu contextMenu(this);
 
-    if (item) {
+    if (index.isValid()) {
         QAction* detailsAction = contextMenu.addAction("View Details");
         QAction* copyAction = contextMenu.addAction("Copy Alert");
 
-        connect(detailsAction, &QAction::triggered, [this, item]() {
-            showAlertDetails(item);
+        connect(detailsAction, &QAction::triggered, [this, index]() {
+            showAlertDetails(index);
         });
 
-        connect(copyAction, &QAction::triggered, [item]() {
-            QGuiApplication::clipboard()->setText(item->text());
+        connect(copyAction, &QAction::triggered, [index]() {
+            QGuiApplication::clipboard()->setText(index.data(Qt::DisplayRole).toString());
         });
 
         contextMenu.addSeparator();
     }
 
     QAction* clearSelectedAction = contextMenu.addAction("Clear Selected");
-    QAction* exportAction = contextMenu.addAction("Export All");
-
-    if (item) {
-        connect(clearSelectedAction, &QAction::triggered, [this, item]() {
-            delete alertList_->takeItem(alertList_->row(item));
+    QAction* exportAction = contextMenu.addAction("Export...");
+
+    if (index.isValid()) {
+        // Hides the row; the alert itself stays in the store
+        QPersistentModelIndex row(index);
+        connect(clearSelectedAction, &QAction::triggered, [this, row]() {
+            if (row.isValid()) {
+                alertModel_->removeRows(row.row(), 1);
+                updateStatusBar();
+            }
         });
     }
 
@@ -511,30 +755,14 @@ void AlertWindow::closeEvent(QCloseEvent *event) {
     event->accept();
 }
 
-QListWidgetItem* AlertWindow::createAlertItem(const Alert& alert) {
-    QListWidgetItem* item = new QListWidgetItem();
-
-    QString alertText = QString("[%1] %2\n%3 - %4")
-                       .arg(alert.getFormattedTimestamp())
-                       .arg(QString::fromStdString(alert.title))
-                       .arg(QString::fromStdString(alert.getTypeString()))
-                       .arg(QString::fromStdString(alert.querySource));
-
-    item->setText(alertText);
-    item->setBackground(alert.getColor());
-    item->setForeground(Qt::white);
-
-    QFont font = item->font();
-    font.setBold(true);
-    item->setFont(font);
+void AlertWindow::paintEvent(QPaintEvent *event) {
+    QMainWindow::paintEvent(event);
 
-    item->setToolTip(QString::fromStdString(alert.message));
-
-    // Store alert data in the item for later retrieval
-    // Note: In a real implementation, we'd use a custom Qt type or QVariant
-    // For simplicity, we're storing basic info
-
-    return item;
+    // Queued, so whatever waits for the first frame runs after it reaches the screen
+    if (!firstFrameShown_) {
+        firstFrameShown_ = true;
+        QTimer::singleShot(0, this, &AlertWindow::firstFrameShown);
+    }
 }
 
 void AlertWindow::updateFiltering() {
@@ -542,7 +770,43 @@ void AlertWindow::updateFiltering() {
 }
 
 void AlertWindow::updateStatusBar() {
-    alertCountLabel_->setText(QString("Alerts: %1").arg(alertList_->count()));
+    alertCountLabel_->setText(QString("Alerts: %1").arg(alertModel_->rowCount()));
+    alertCountLabel_->setToolTip(QString("Last update: %1 alerts\nUpdates: %2\nQueued: %3\nEvicted before shown: %4")
+                                 .arg(lastFlushSize_)
+                                 .arg(flushCount_)
+                                 .arg(pendingAlerts_)
+                                 .arg(getDroppedRenderCount()));
+}
+
+void AlertWindow::updateLatencyStatus() {
+    if (!queryEngine_) {
+        return;
+    }
+
+    LatencySummary overall = queryEngine_->getOverallLatency();
+    LatencySummary lag = queryEngine_->getSchedulerLag();
+    latencyLabel_->setText(QString("p95: %1 ms | Lag p95: %2 ms | Queue: %3")
+                           .arg(overall.p95Ms, 0, 'f', 1)
+                           .arg(lag.p95Ms, 0, 'f', 1)
+                           .arg(queryEngine_->getQueueDepth()));
+
+    // One line per run key: execution percentiles, then connection wait and processing
+    QStringList lines;
+    lines << QString("Queue wait p95: %1 ms, deepest queue: %2")
+             .arg(queryEngine_->getQueueWait().p95Ms, 0, 'f', 1)
+             .arg(queryEngine_->getMaxQueueDepth());
+    for (const auto& pair : queryEngine_->getQueryLatencies()) {
+        const QueryLatencyStats& stats = pair.second;
+        lines << QString("%1: p50 %2 / p95 %3 / p99 %4 / max %5 ms (wait p95 %6, processing p95 %7)")
+                 .arg(QString::fromStdString(pair.first))
+                 .arg(stats.execution.p50Ms, 0, 'f', 1)
+                 .arg(stats.execution.p95Ms, 0, 'f', 1)
+                 .arg(stats.execution.p99Ms, 0, 'f', 1)
+                 .arg(stats.execution.maxMs, 0, 'f', 1)
+                 .arg(stats.connectionWait.p95Ms, 0, 'f', 1)
+                 .arg(stats.processing.p95Ms, 0, 'f', 1);
+    }
+    latencyLabel_->setToolTip(lines.join("\n"));
 }
 
 QString AlertWindow::getConnectionStatusText() const {
@@ -573,33 +837,6 @@ QString AlertWindow::getAlertIcon(AlertType type) const {
     }
 }
 
-bool AlertWindow::shouldShowAlert(const Alert& alert) const {
-    bool showByType = false;
-    switch (alert.type) {
-        case AlertType::CRITICAL:
-            showByType = showCritical_->isChecked();
-            break;
-        case AlertType::WARNING:
-            showByType = showWarning_->isChecked();
-            break;
-        case AlertType::INFO:
-            showByType = showInfo_->isChecked();
-            break;
-    }
-
-    if (!showByType) {
-        return false;
-    }
-
-    QString searchText = searchBox_->text().toLower();
-    if (searchText.isEmpty()) {
-        return true;
-    }
-
-    QString alertText = QString::fromStdString(alert.title + " " + alert.message + " " + alert.querySource);
-    return alertText.toLower().contains(searchText);
-}
-
 void AlertWindow::applyFilters() {
     updateFiltering();
 }
@@ -607,10 +844,8 @@ void AlertWindow::applyFilters() {
 void AlertWindow::showSettingsDialog() {
     SettingsDialog dialog(this);
 
-    // Load current config if available
-    if (databaseManager_) {
-        dialog.setDatabaseConfig(databaseManager_->getConnectionConfig());
-    }
+    // Load current config
+    dialog.setDatabaseConfig(database()->getConnectionConfig());
 
     // Load alert system settings
     dialog.setDuplicateDetectionEnabled(alertSystem_->getAlertCount() > 0);
@@ -630,7 +865,7 @@ void AlertWindow::showSettingsDialog() {
     }
 }
 
-bool AlertWindow::validateDatabaseConfig(const DatabaseManager::ConnectionConfig& config) const {
+bool AlertWindow::validateDatabaseConfig(const DatabaseManager::ConnectionConfig& config) {
     if (config.host.empty() || config.database.empty() ||
         config.username.empty() || config.password.empty()) {
         QMessageBox::warning(this, "Invalid Configuration",
@@ -793,6 +1028,178 @@ void SettingsDialog::testConnection() {
     testConnectionButton_->setEnabled(true);
 }
 
+void SettingsDialog::accept() {
+    if (hostEdit_->text().trimmed().isEmpty() || databaseEdit_->text().trimmed().isEmpty() ||
+        usernameEdit_->text().trimmed().isEmpty()) {
+        testConnectionStatus_->setText("Host, database and username are required");
+        testConnectionStatus_->setStyleSheet("color: red;");
+        return;
+    }
+
+    QDialog::accept();
+}
+
+// ExportDialog implementation
+ExportDialog::ExportDialog(bool journalAvailable, QWidget *parent)
+    : QDialog(parent)
+{
+    setupUI(journalAvailable);
+    setWindowTitle("Export Alerts");
+    setModal(true);
+}
+
+ExportDialog::~ExportDialog() = default;
+
+void ExportDialog::setupUI(bool journalAvailable) {
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    QFormLayout* formLayout = new QFormLayout();
+
+    formatCombo_ = new QComboBox();
+    formatCombo_->addItem("CSV", static_cast<int>(ExportFormat::CSV));
+    formatCombo_->addItem("JSON Lines", static_cast<int>(ExportFormat::JSONLines));
+    formatCombo_->addItem("Columnar (binary)", static_cast<int>(ExportFormat::Columnar));
+
+    sourceCombo_ = new QComboBox();
+    sourceCombo_->addItem("Alerts in memory", static_cast<int>(ExportSource::Memory));
+    if (journalAvailable) {
+        sourceCombo_->addItem("Full history (journal)", static_cast<int>(ExportSource::Journal));
+    }
+
+    criticalCheck_ = new QCheckBox("Critical");
+    warningCheck_ = new QCheckBox("Warning");
+    infoCheck_ = new QCheckBox("Info");
+    QHBoxLayout* typeLayout = new QHBoxLayout();
+    typeLayout->addWidget(criticalCheck_);
+    typeLayout->addWidget(warningCheck_);
+    typeLayout->addWidget(infoCheck_);
+
+    limitRangeCheck_ = new QCheckBox("Only alerts between");
+    fromEdit_ = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(-3600));
+    toEdit_ = new QDateTimeEdit(QDateTime::currentDateTime());
+    fromEdit_->setCalendarPopup(true);
+    toEdit_->setCalendarPopup(true);
+    fromEdit_->setEnabled(false);
+    toEdit_->setEnabled(false);
+    connect(limitRangeCheck_, &QCheckBox::toggled, fromEdit_, &QWidget::setEnabled);
+    connect(limitRangeCheck_, &QCheckBox::toggled, toEdit_, &QWidget::setEnabled);
+
+    formLayout->addRow("Format:", formatCombo_);
+    formLayout->addRow("Source:", sourceCombo_);
+    formLayout->addRow("Types:", typeLayout);
+    formLayout->addRow(limitRangeCheck_);
+    formLayout->addRow("From:", fromEdit_);
+    formLayout->addRow("To:", toEdit_);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    mainLayout->addLayout(formLayout);
+    mainLayout->addWidget(buttonBox);
+}
+
+ExportRequest ExportDialog::getRequest() const {
+    ExportRequest request;
+    request.format = static_cast<ExportFormat>(formatCombo_->currentData().toInt());
+    request.source = static_cast<ExportSource>(sourceCombo_->currentData().toInt());
+    request.typeMask = (criticalCheck_->isChecked() ? AlertSearchIndex::typeBit(AlertType::CRITICAL) : 0) |
+                       (warningCheck_->isChecked() ? AlertSearchIndex::typeBit(AlertType::WARNING) : 0) |
+                       (infoCheck_->isChecked() ? AlertSearchIndex::typeBit(AlertType::INFO) : 0);
+    if (limitRangeCheck_->isChecked()) {
+        request.fromMs = fromEdit_->dateTime().toMSecsSinceEpoch();
+        request.toMs = toEdit_->dateTime().toMSecsSinceEpoch();
+    }
+    return request;
+}
+
+void ExportDialog::setTypeFilter(bool showCritical, bool showWarning, bool showInfo) {
+    criticalCheck_->setChecked(showCritical);
+    warningCheck_->setChecked(showWarning);
+    infoCheck_->setChecked(showInfo);
+}
+
+// AlertHistoryDialog implementation
+AlertHistoryDialog::AlertHistoryDialog(AlertJournal* journal, QWidget *parent)
+    : QDialog(parent)
+    , journal_(journal)
+    , model_(new JournalHistoryModel(journal, this))
+    , historyList_(nullptr)
+    , entryDetails_(nullptr)
+    , summaryLabel_(nullptr)
+{
+    setupUI();
+    setWindowTitle("Alert History");
+    setModal(true);
+    resize(900, 600);
+    reload();
+}
+
+AlertHistoryDialog::~AlertHistoryDialog() = default;
+
+void AlertHistoryDialog::setupUI() {
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    summaryLabel_ = new QLabel();
+    mainLayout->addWidget(summaryLabel_);
+
+    // Rows are fetched from the mapped journal as the list scrolls
+    historyList_ = new QListView();
+    historyList_->setModel(model_);
+    historyList_->setItemDelegate(new AlertItemDelegate(historyList_));
+    historyList_->setUniformItemSizes(true);
+    historyList_->setSelectionMode(QAbstractItemView::SingleSelection);
+
+    entryDetails_ = new QTextEdit();
+    entryDetails_->setReadOnly(true);
+
+    QSplitter* splitter = new QSplitter(Qt::Horizontal);
+    splitter->addWidget(historyList_);
+    splitter->addWidget(entryDetails_);
+    splitter->setSizes({550, 350});
+    mainLayout->addWidget(splitter);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton* reloadButton = buttonBox->addButton("Reload", QDialogButtonBox::ActionRole);
+    connect(reloadButton, &QPushButton::clicked, this, &AlertHistoryDialog::reload);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    connect(historyList_->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &AlertHistoryDialog::showEntry);
+}
+
+void AlertHistoryDialog::reload() {
+    model_->reload();
+    entryDetails_->clear();
+
+    summaryLabel_->setText(QString("%1 alerts in %2 journal segments (%3 MB)")
+                           .arg(static_cast<qulonglong>(model_->totalCount()))
+                           .arg(journal_->getSegmentCount())
+                           .arg(journal_->getDiskBytes() / (1024.0 * 1024.0), 0, 'f', 1));
+}
+
+void AlertHistoryDialog::showEntry(const QModelIndex& index) {
+    if (!index.isValid()) {
+        entryDetails_->clear();
+        return;
+    }
+
+    QString details = QString("Type: %1\nTitle: %2\nQuery: %3\nTime: %4\n\n%5")
+                      .arg(QString::fromStdString(Alert::typeToString(
+                           static_cast<AlertType>(index.data(AlertListModel::TypeRole).toInt()))))
+                      .arg(index.data(AlertListModel::TitleRole).toString())
+                      .arg(index.data(AlertListModel::QuerySourceRole).toString())
+                      .arg(index.data(AlertListModel::TimestampRole).toDateTime().toString("yyyy-MM-dd hh:mm:ss"))
+                      .arg(index.data(AlertListModel::MessageRole).toString());
+
+    QString rawResult = index.data(AlertListModel::RawResultRole).toString();
+    if (!rawResult.isEmpty()) {
+        details += "\n\n" + rawResult;
+    }
+
+    entryDetails_->setPlainText(details);
+}
+
 // AlertDetailsDialog implementation
 AlertDetailsDialog::AlertDetailsDialog(const Alert& alert, QWidget *parent)
     : QDialog(parent)
@@ -809,14 +1216,14 @@ void AlertDetailsDialog::setupUI(const Alert& alert) {
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
     // Create detail fields
-    titleLabel_ = new QLabel(QString::fromStdString(alert.title));
+    titleLabel_ = new QLabel(QString::fromStdString(alert.title.str()));
     titleLabel_->setStyleSheet("font-size: 16px; font-weight: bold;");
 
     typeLabel_ = new QLabel("Type: " + QString::fromStdString(alert.getTypeString()));
-    typeLabel_->setStyleSheet(QString("color: %1; font-weight: bold;").arg(alert.getColor().name()));
+    typeLabel_->setStyleSheet(QString("color: %1; font-weight: bold;").arg(AlertListModel::colorFor(alert.type).name()));
 
     timestampLabel_ = new QLabel("Timestamp: " + alert.timestamp.toString("yyyy-MM-dd hh:mm:ss"));
-    querySourceLabel_ = new QLabel("Query Source: " + QString::fromStdString(alert.querySource));
+    querySourceLabel_ = new QLabel("Query Source: " + QString::fromStdString(alert.querySource.str()));
 
     messageEdit_ = new QTextEdit();
     messageEdit_->setPlainText(QString::fromStdString(alert.message));
@@ -843,5 +1250,3 @@ void AlertDetailsDialog::setupUI(const Alert& alert) {
     connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
     mainLayout->addWidget(buttonBox);
 }
-
-#include "AlertWindow.moc"
\ No newline at end of file
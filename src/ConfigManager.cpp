@@ -7,6 +7,7 @@
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <QDebug>
+#include <algorithm>
 
 // Static constants
 const QString ConfigManager::CONFIG_FILE_NAME = "config.txt";
@@ -14,8 +15,9 @@ const QString ConfigManager::CONFIG_SECTION_MARKER = "[";
 const QString ConfigManager::CONFIG_COMMENT_PREFIX = "#";
 const QString ConfigManager::CONFIG_KEY_VALUE_SEPARATOR = "=";
 
-ConfigManager::ConfigManager()
-    : useEnvironmentVariables_(false)
+ConfigManager::ConfigManager(QObject *parent)
+    : QObject(parent)
+    , useEnvironmentVariables_(false)
     , configChanged_(false)
 {
     // Initialize with default values
@@ -178,11 +180,11 @@ void ConfigManager::setAlertConfig(const AlertConfig& config) {
     notifyConfigChanged();
 }
 
-QueryConfig ConfigManager::getQueryConfig() const {
+QueryEngineConfig ConfigManager::getQueryConfig() const {
     return queryConfig_;
 }
 
-void ConfigManager::setQueryConfig(const QueryConfig& config) {
+void ConfigManager::setQueryConfig(const QueryEngineConfig& config) {
     queryConfig_ = config;
     configChanged_ = true;
     notifyConfigChanged();
@@ -297,25 +299,9 @@ bool ConfigManager::parseDatabaseSection(const QStringList& lines, int& lineNumb
                 value = value.mid(1, value.length() - 2);
             }
 
-            if (key == "host") {
-                databaseConfig_.host = value.toStdString();
-            } else if (key == "port") {
-                databaseConfig_.port = value.toInt();
-            } else if (key == "database") {
-                databaseConfig_.database = value.toStdString();
-            } else if (key == "username") {
-                databaseConfig_.username = value.toStdString();
-            } else if (key == "password") {
-                databaseConfig_.password = value.toStdString();
-            } else if (key == "connect_timeout") {
-                databaseConfig_.connectTimeout = value.toInt();
-            } else if (key == "sslmode") {
-                databaseConfig_.sslMode = value.toStdString();
-            } else if (key == "application_name") {
-                databaseConfig_.applicationName = value.toStdString();
-            } else if (key == "use_environment_variables") {
+            if (key == "use_environment_variables") {
                 useEnvironmentVariables_ = (value.toLower() == "true" || value == "1");
-            } else {
+            } else if (!parseDatabaseKey(databaseConfig_, key, value)) {
                 qWarning() << "Unknown database config key:" << key;
             }
         }
@@ -326,6 +312,116 @@ bool ConfigManager::parseDatabaseSection(const QStringList& lines, int& lineNumb
     return true;
 }
 
+bool ConfigManager::parseDatabaseKey(DatabaseConfig& config, const QString& key, const QString& value) {
+    if (key == "host") {
+        config.host = value.toStdString();
+    } else if (key == "port") {
+        config.port = value.toInt();
+    } else if (key == "database") {
+        config.database = value.toStdString();
+    } else if (key == "username") {
+        config.username = value.toStdString();
+    } else if (key == "password") {
+        config.password = value.toStdString();
+    } else if (key == "connect_timeout") {
+        config.connectTimeout = value.toInt();
+    } else if (key == "sslmode") {
+        config.sslMode = value.toStdString();
+    } else if (key == "application_name") {
+        config.applicationName = value.toStdString();
+    } else if (key == "pool_size") {
+        config.poolSize = value.toInt();
+    } else if (key == "health_check_interval") {
+        config.healthCheckInterval = value.toInt();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ConfigManager::loadDatabaseTargets(const QString& filePath) {
+    databaseTargets_.clear();
+
+    // The targets file is optional; without it only [Database] is monitored
+    if (!QFileInfo::exists(filePath)) {
+        return true;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Cannot open database targets file:" << filePath;
+        return false;
+    }
+
+    QTextStream in(&file);
+    QStringList lines = in.readAll().split('\n');
+    file.close();
+
+    const QString targetPrefix = "Target:";
+    DatabaseTarget* current = nullptr;
+    bool valid = true;
+
+    for (const QString& rawLine : lines) {
+        QString line = rawLine.trimmed();
+        if (line.isEmpty() || line.startsWith(CONFIG_COMMENT_PREFIX)) {
+            continue;
+        }
+
+        if (line.startsWith(CONFIG_SECTION_MARKER) && line.endsWith("]")) {
+            QString sectionName = line.mid(1, line.length() - 2).trimmed();
+            current = nullptr;
+
+            // Other sections, such as [Connection], are not targets
+            if (!sectionName.startsWith(targetPrefix)) {
+                continue;
+            }
+
+            QString name = sectionName.mid(targetPrefix.length()).trimmed();
+            bool duplicate = std::any_of(databaseTargets_.begin(), databaseTargets_.end(),
+                                         [&name](const DatabaseTarget& target) {
+                                             return target.name == name.toStdString();
+                                         });
+            if (!isValidTargetName(name) || duplicate) {
+                qWarning() << "Skipping database target with invalid or duplicate name:" << name;
+                valid = false;
+                continue;
+            }
+
+            databaseTargets_.push_back(DatabaseTarget{name.toStdString(), databaseConfig_});
+            current = &databaseTargets_.back();
+            continue;
+        }
+
+        int separatorPos = line.indexOf(CONFIG_KEY_VALUE_SEPARATOR);
+        if (!current || separatorPos <= 0) {
+            continue;
+        }
+
+        QString key = line.left(separatorPos).trimmed();
+        QString value = line.mid(separatorPos + 1).trimmed();
+        if (value.startsWith("\"") && value.endsWith("\"")) {
+            value = value.mid(1, value.length() - 2);
+        }
+
+        if (!parseDatabaseKey(current->config, key, value)) {
+            qWarning() << "Unknown database target key:" << key << "in" << QString::fromStdString(current->name);
+        }
+    }
+
+    qInfo() << "Loaded" << databaseTargets_.size() << "database targets from:" << filePath;
+    return valid;
+}
+
+std::vector<DatabaseTarget> ConfigManager::getDatabaseTargets() const {
+    return databaseTargets_;
+}
+
+bool ConfigManager::isValidTargetName(const QString& name) {
+    // '@' separates query ids from targets, ',' lists targets and "*" means all of them
+    return !name.isEmpty() && name != "default" && name != "*" &&
+           !name.contains('@') && !name.contains(',') && !name.contains(' ');
+}
+
 bool ConfigManager::parseAlertSection(const QStringList& lines, int& lineNumber) {
     while (lineNumber < lines.size()) {
         QString line = lines[lineNumber].trimmed();
@@ -362,6 +458,46 @@ bool ConfigManager::parseAlertSection(const QStringList& lines, int& lineNumber)
                 alertConfig_.dateFormat = value;
             } else if (key == "time_format") {
                 alertConfig_.timeFormat = value;
+            } else if (key == "journal_enabled") {
+                alertConfig_.journalEnabled = (value.toLower() == "true" || value == "1");
+            } else if (key == "journal_directory") {
+                alertConfig_.journalDirectory = value;
+            } else if (key == "journal_segment_size_mb") {
+                alertConfig_.journalSegmentSizeMb = value.toInt();
+            } else if (key == "journal_max_segments") {
+                alertConfig_.journalMaxSegments = value.toInt();
+            } else if (key == "journal_retention_days") {
+                alertConfig_.journalRetentionDays = value.toInt();
+            } else if (key == "journal_sync_interval_ms") {
+                alertConfig_.journalSyncIntervalMs = value.toInt();
+            } else if (key == "webhook_url") {
+                alertConfig_.webhookUrl = value;
+            } else if (key == "webhook_timeout_ms") {
+                alertConfig_.webhookTimeoutMs = value.toInt();
+            } else if (key == "syslog_host") {
+                alertConfig_.syslogHost = value;
+            } else if (key == "syslog_port") {
+                alertConfig_.syslogPort = value.toInt();
+            } else if (key == "syslog_facility") {
+                alertConfig_.syslogFacility = value.toInt();
+            } else if (key == "metrics_port") {
+                alertConfig_.metricsPort = value.toInt();
+            } else if (key == "metrics_address") {
+                alertConfig_.metricsAddress = value;
+            } else if (key == "sink_queue_size") {
+                alertConfig_.sinkQueueSize = value.toInt();
+            } else if (key == "sink_batch_size") {
+                alertConfig_.sinkBatchSize = value.toInt();
+            } else if (key == "sink_batch_delay_ms") {
+                alertConfig_.sinkBatchDelayMs = value.toInt();
+            } else if (key == "sink_retry_max_ms") {
+                alertConfig_.sinkRetryMaxMs = value.toInt();
+            } else if (key == "sink_max_attempts") {
+                alertConfig_.sinkMaxAttempts = value.toInt();
+            } else if (key == "critical_keywords") {
+                alertConfig_.criticalKeywords = value;
+            } else if (key == "warning_keywords") {
+                alertConfig_.warningKeywords = value;
             } else {
                 qWarning() << "Unknown alert config key:" << key;
             }
@@ -397,10 +533,24 @@ bool ConfigManager::parseQuerySection(const QStringList& lines, int& lineNumber)
 
             if (key == "queries_file_path") {
                 queryConfig_.queriesFilePath = value.toStdString();
+            } else if (key == "targets_file_path") {
+                queryConfig_.targetsFilePath = value.toStdString();
+            } else if (key == "watermarks_file_path") {
+                queryConfig_.watermarksFilePath = value.toStdString();
             } else if (key == "execution_interval") {
                 queryConfig_.executionInterval = value.toInt();
             } else if (key == "max_concurrent_queries") {
                 queryConfig_.maxConcurrentQueries = value.toInt();
+            } else if (key == "max_queued_queries") {
+                queryConfig_.maxQueuedQueries = value.toInt();
+            } else if (key == "batch_execution") {
+                queryConfig_.batchExecution = (value.toLower() == "true" || value == "1");
+            } else if (key == "adaptive_scheduling") {
+                queryConfig_.adaptiveScheduling = (value.toLower() == "true" || value == "1");
+            } else if (key == "adaptive_max_interval") {
+                queryConfig_.adaptiveMaxInterval = value.toInt();
+            } else if (key == "watch_config_files") {
+                queryConfig_.watchConfigFiles = (value.toLower() == "true" || value == "1");
             } else if (key == "start_monitoring_on_startup") {
                 queryConfig_.startMonitoringOnStartup = (value.toLower() == "true" || value == "1");
             } else if (key == "enable_query_logging") {
@@ -466,6 +616,8 @@ bool ConfigManager::parseUISection(const QStringList& lines, int& lineNumber) {
                 uiConfig_.alertFontSize = value.toInt();
             } else if (key == "dark_theme") {
                 uiConfig_.darkTheme = (value.toLower() == "true" || value == "1");
+            } else if (key == "max_refresh_rate") {
+                uiConfig_.maxRefreshRate = value.toInt();
             } else {
                 qWarning() << "Unknown UI config key:" << key;
             }
@@ -549,7 +701,9 @@ QStringList ConfigManager::formatDatabaseSection() const {
     lines.append("connect_timeout=" + QString::number(databaseConfig_.connectTimeout));
     lines.append("sslmode=" + QString::fromStdString(databaseConfig_.sslMode));
     lines.append("application_name=" + QString::fromStdString(databaseConfig_.applicationName));
-    lines.append("use_environment_variables=" + (useEnvironmentVariables_ ? "true" : "false"));
+    lines.append("pool_size=" + QString::number(databaseConfig_.poolSize));
+    lines.append("health_check_interval=" + QString::number(databaseConfig_.healthCheckInterval));
+    lines.append(QString("use_environment_variables=") + (useEnvironmentVariables_ ? "true" : "false"));
     lines.append("");
     return lines;
 }
@@ -558,13 +712,33 @@ QStringList ConfigManager::formatAlertSection() const {
     QStringList lines;
     lines.append("[Alerts]");
     lines.append("# Alert system settings");
-    lines.append("duplicate_detection_enabled=" + (alertConfig_.duplicateDetectionEnabled ? "true" : "false"));
+    lines.append(QString("duplicate_detection_enabled=") + (alertConfig_.duplicateDetectionEnabled ? "true" : "false"));
     lines.append("duplicate_time_window=" + QString::number(alertConfig_.duplicateTimeWindow));
     lines.append("max_alerts=" + QString::number(alertConfig_.maxAlerts));
-    lines.append("show_timestamps=" + (alertConfig_.showTimestamps ? "true" : "false"));
-    lines.append("auto_scroll=" + (alertConfig_.autoScroll ? "true" : "false"));
+    lines.append(QString("show_timestamps=") + (alertConfig_.showTimestamps ? "true" : "false"));
+    lines.append(QString("auto_scroll=") + (alertConfig_.autoScroll ? "true" : "false"));
     lines.append("date_format=" + alertConfig_.dateFormat);
     lines.append("time_format=" + alertConfig_.timeFormat);
+    lines.append(QString("journal_enabled=") + (alertConfig_.journalEnabled ? "true" : "false"));
+    lines.append("journal_directory=" + alertConfig_.journalDirectory);
+    lines.append("journal_segment_size_mb=" + QString::number(alertConfig_.journalSegmentSizeMb));
+    lines.append("journal_max_segments=" + QString::number(alertConfig_.journalMaxSegments));
+    lines.append("journal_retention_days=" + QString::number(alertConfig_.journalRetentionDays));
+    lines.append("journal_sync_interval_ms=" + QString::number(alertConfig_.journalSyncIntervalMs));
+    lines.append("webhook_url=" + alertConfig_.webhookUrl);
+    lines.append("webhook_timeout_ms=" + QString::number(alertConfig_.webhookTimeoutMs));
+    lines.append("syslog_host=" + alertConfig_.syslogHost);
+    lines.append("syslog_port=" + QString::number(alertConfig_.syslogPort));
+    lines.append("syslog_facility=" + QString::number(alertConfig_.syslogFacility));
+    lines.append("metrics_port=" + QString::number(alertConfig_.metricsPort));
+    lines.append("metrics_address=" + alertConfig_.metricsAddress);
+    lines.append("sink_queue_size=" + QString::number(alertConfig_.sinkQueueSize));
+    lines.append("sink_batch_size=" + QString::number(alertConfig_.sinkBatchSize));
+    lines.append("sink_batch_delay_ms=" + QString::number(alertConfig_.sinkBatchDelayMs));
+    lines.append("sink_retry_max_ms=" + QString::number(alertConfig_.sinkRetryMaxMs));
+    lines.append("sink_max_attempts=" + QString::number(alertConfig_.sinkMaxAttempts));
+    lines.append("critical_keywords=" + alertConfig_.criticalKeywords);
+    lines.append("warning_keywords=" + alertConfig_.warningKeywords);
     lines.append("");
     return lines;
 }
@@ -574,10 +748,17 @@ QStringList ConfigManager::formatQuerySection() const {
     lines.append("[Queries]");
     lines.append("# Query execution settings");
     lines.append("queries_file_path=" + QString::fromStdString(queryConfig_.queriesFilePath));
+    lines.append("targets_file_path=" + QString::fromStdString(queryConfig_.targetsFilePath));
+    lines.append("watermarks_file_path=" + QString::fromStdString(queryConfig_.watermarksFilePath));
     lines.append("execution_interval=" + QString::number(queryConfig_.executionInterval));
     lines.append("max_concurrent_queries=" + QString::number(queryConfig_.maxConcurrentQueries));
-    lines.append("start_monitoring_on_startup=" + (queryConfig_.startMonitoringOnStartup ? "true" : "false"));
-    lines.append("enable_query_logging=" + (queryConfig_.enableQueryLogging ? "true" : "false"));
+    lines.append("max_queued_queries=" + QString::number(queryConfig_.maxQueuedQueries));
+    lines.append("batch_execution=" + QString(queryConfig_.batchExecution ? "true" : "false"));
+    lines.append("adaptive_scheduling=" + QString(queryConfig_.adaptiveScheduling ? "true" : "false"));
+    lines.append("adaptive_max_interval=" + QString::number(queryConfig_.adaptiveMaxInterval));
+    lines.append("watch_config_files=" + QString(queryConfig_.watchConfigFiles ? "true" : "false"));
+    lines.append(QString("start_monitoring_on_startup=") + (queryConfig_.startMonitoringOnStartup ? "true" : "false"));
+    lines.append(QString("enable_query_logging=") + (queryConfig_.enableQueryLogging ? "true" : "false"));
     lines.append("");
     return lines;
 }
@@ -589,14 +770,15 @@ QStringList ConfigManager::formatUISection() const {
     lines.append("window_title=" + uiConfig_.windowTitle);
     lines.append("window_size=" + QString::number(uiConfig_.windowSize.width()) + "x" + QString::number(uiConfig_.windowSize.height()));
     lines.append("window_position=" + QString::number(uiConfig_.windowPosition.x()) + "," + QString::number(uiConfig_.windowPosition.y()));
-    lines.append("show_filter_panel=" + (uiConfig_.showFilterPanel ? "true" : "false"));
-    lines.append("show_details_panel=" + (uiConfig_.showDetailsPanel ? "true" : "false"));
+    lines.append(QString("show_filter_panel=") + (uiConfig_.showFilterPanel ? "true" : "false"));
+    lines.append(QString("show_details_panel=") + (uiConfig_.showDetailsPanel ? "true" : "false"));
     lines.append("alert_color_critical=" + uiConfig_.alertColorCritical);
     lines.append("alert_color_warning=" + uiConfig_.alertColorWarning);
     lines.append("alert_color_info=" + uiConfig_.alertColorInfo);
     lines.append("alert_font_family=" + uiConfig_.alertFontFamily);
     lines.append("alert_font_size=" + QString::number(uiConfig_.alertFontSize));
-    lines.append("dark_theme=" + (uiConfig_.darkTheme ? "true" : "false"));
+    lines.append(QString("dark_theme=") + (uiConfig_.darkTheme ? "true" : "false"));
+    lines.append("max_refresh_rate=" + QString::number(uiConfig_.maxRefreshRate));
     lines.append("");
     return lines;
 }
@@ -605,7 +787,7 @@ QStringList ConfigManager::formatGeneralSection() const {
     QStringList lines;
     lines.append("[General]");
     lines.append("# General application settings");
-    lines.append("use_environment_variables=" + (useEnvironmentVariables_ ? "true" : "false"));
+    lines.append(QString("use_environment_variables=") + (useEnvironmentVariables_ ? "true" : "false"));
     lines.append("");
     return lines;
 }
@@ -654,6 +836,8 @@ DatabaseConfig ConfigManager::getDefaultDatabaseConfig() const {
     config.connectTimeout = 10;
     config.sslMode = "prefer";
     config.applicationName = "PostgreSQL-Monitor";
+    config.poolSize = 5;
+    config.healthCheckInterval = 30;
     return config;
 }
 
@@ -665,14 +849,41 @@ AlertConfig ConfigManager::getDefaultAlertConfig() const {
     config.showTimestamps = true;
     config.autoScroll = true;
     config.dateFormat = "hh:mm:ss";
+    config.journalEnabled = true;
+    config.journalDirectory = "journal";
+    config.journalSegmentSizeMb = 64;
+    config.journalMaxSegments = 64;
+    config.journalRetentionDays = 30;
+    config.journalSyncIntervalMs = 1000;
+    config.webhookUrl = "";
+    config.webhookTimeoutMs = 5000;
+    config.syslogHost = "";
+    config.syslogPort = 514;
+    config.syslogFacility = 16;
+    config.metricsPort = 0;
+    config.metricsAddress = "127.0.0.1";
+    config.sinkQueueSize = 1000;
+    config.sinkBatchSize = 50;
+    config.sinkBatchDelayMs = 1000;
+    config.sinkRetryMaxMs = 30000;
+    config.sinkMaxAttempts = 5;
+    config.criticalKeywords = "error,fail,critical,breach";
+    config.warningKeywords = "warning,alert,unusual";
     return config;
 }
 
-QueryConfig ConfigManager::getDefaultQueryConfig() const {
-    QueryConfig config;
+QueryEngineConfig ConfigManager::getDefaultQueryConfig() const {
+    QueryEngineConfig config;
     config.queriesFilePath = "config/queries.conf";
+    config.targetsFilePath = "config/database.conf";
+    config.watermarksFilePath = "watermarks.state";
     config.executionInterval = 1000;
     config.maxConcurrentQueries = 5;
+    config.maxQueuedQueries = 100;
+    config.batchExecution = false;
+    config.adaptiveScheduling = false;
+    config.adaptiveMaxInterval = 60000;
+    config.watchConfigFiles = true;
     config.startMonitoringOnStartup = false;
     config.enableQueryLogging = false;
     return config;
@@ -691,6 +902,7 @@ UIConfig ConfigManager::getDefaultUIConfig() const {
     config.alertFontFamily = "Segoe UI, Arial, sans-serif";
     config.alertFontSize = 10;
     config.darkTheme = false;
+    config.maxRefreshRate = 30;
     return config;
 }
 
@@ -723,6 +935,7 @@ void ConfigManager::notifyConfigChanged() {
     if (configChangedCallback_) {
         configChangedCallback_();
     }
+    emit configChanged();
 }
 
 std::vector<QString> ConfigManager::getRecentConfigFiles() {
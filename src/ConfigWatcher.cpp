@@ -0,0 +1,90 @@
+#include "ConfigWatcher.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <algorithm>
+
+namespace {
+// Long enough for an editor's write, rename and chmod to land as one change
+const int kDefaultSettleDelayMs = 250;
+}
+
+ConfigWatcher::ConfigWatcher(QObject *parent)
+    : QObject(parent)
+    , watcher_(new QFileSystemWatcher(this))
+    , settleTimer_(new QTimer(this))
+{
+    settleTimer_->setSingleShot(true);
+    settleTimer_->setInterval(kDefaultSettleDelayMs);
+
+    connect(watcher_, &QFileSystemWatcher::fileChanged, this, &ConfigWatcher::onFileChanged);
+    connect(watcher_, &QFileSystemWatcher::directoryChanged, this, &ConfigWatcher::onDirectoryChanged);
+    connect(settleTimer_, &QTimer::timeout, this, &ConfigWatcher::onSettled);
+}
+
+void ConfigWatcher::watch(const QString& filePath) {
+    QFileInfo info(filePath);
+    QString absolutePath = info.absoluteFilePath();
+    if (files_.contains(absolutePath)) {
+        return;
+    }
+
+    if (!info.absoluteDir().exists()) {
+        qWarning() << "Not watching" << filePath << ": its directory does not exist";
+        return;
+    }
+
+    files_.append(absolutePath);
+    watcher_->addPath(info.absolutePath());
+    rewatch(absolutePath);
+}
+
+QStringList ConfigWatcher::watchedFiles() const {
+    return files_;
+}
+
+void ConfigWatcher::setSettleDelay(int milliseconds) {
+    settleTimer_->setInterval(std::max(0, milliseconds));
+}
+
+int ConfigWatcher::getSettleDelay() const {
+    return settleTimer_->interval();
+}
+
+void ConfigWatcher::onFileChanged(const QString& filePath) {
+    // A file renamed over or deleted drops out of the watcher; the directory
+    // signal brings it back if it reappears
+    rewatch(filePath);
+    changed_.insert(filePath);
+    settleTimer_->start();
+}
+
+void ConfigWatcher::onDirectoryChanged(const QString& directory) {
+    // Only files of ours that the watcher lost are news here; writes to the
+    // ones it still holds arrive through fileChanged
+    const QStringList watched = watcher_->files();
+    for (const QString& filePath : files_) {
+        if (QFileInfo(filePath).absolutePath() != directory || watched.contains(filePath)) {
+            continue;
+        }
+        if (QFileInfo::exists(filePath)) {
+            rewatch(filePath);
+            changed_.insert(filePath);
+            settleTimer_->start();
+        }
+    }
+}
+
+void ConfigWatcher::onSettled() {
+    QSet<QString> changed;
+    changed.swap(changed_);
+
+    for (const QString& filePath : changed) {
+        emit fileChanged(filePath);
+    }
+}
+
+void ConfigWatcher::rewatch(const QString& filePath) {
+    if (QFileInfo::exists(filePath) && !watcher_->files().contains(filePath)) {
+        watcher_->addPath(filePath);
+    }
+}
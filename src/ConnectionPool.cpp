@@ -0,0 +1,356 @@
+#include "ConnectionPool.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <QDebug>
+
+// ConnectionLease implementation
+ConnectionLease::ConnectionLease(ConnectionPool* pool, PooledConnection* connection)
+    : pool_(pool)
+    , connection_(connection)
+{
+}
+
+ConnectionLease::~ConnectionLease() {
+    release();
+}
+
+ConnectionLease::ConnectionLease(ConnectionLease&& other) noexcept
+    : pool_(other.pool_)
+    , connection_(other.connection_)
+    , broken_(other.broken_)
+{
+    other.pool_ = nullptr;
+    other.connection_ = nullptr;
+    other.broken_ = false;
+}
+
+ConnectionLease& ConnectionLease::operator=(ConnectionLease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        connection_ = other.connection_;
+        broken_ = other.broken_;
+        other.pool_ = nullptr;
+        other.connection_ = nullptr;
+        other.broken_ = false;
+    }
+    return *this;
+}
+
+void ConnectionLease::markBroken() {
+    broken_ = true;
+}
+
+void ConnectionLease::release() {
+    if (pool_ && connection_) {
+        pool_->release(connection_, broken_);
+    }
+    pool_ = nullptr;
+    connection_ = nullptr;
+    broken_ = false;
+}
+
+// ConnectionPool implementation
+ConnectionPool::ConnectionPool()
+    : leasedCount_(0)
+    , closing_(false)
+    , healthCheckInterval_(30000)
+{
+}
+
+ConnectionPool::~ConnectionPool() {
+    close();
+}
+
+void ConnectionPool::setConnectionInitializer(ConnectionInitializer initializer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    initializer_ = std::move(initializer);
+}
+
+bool ConnectionPool::open(const std::string& connectionString, int size, std::string& error,
+                          const OpenProgress& progress) {
+    close();
+
+    std::vector<std::unique_ptr<PooledConnection>> connections;
+    size = std::max(1, size);
+    for (int i = 0; i < size; ++i) {
+        auto pooled = std::make_unique<PooledConnection>();
+        pooled->index = i;
+        pooled->lastUsed = std::chrono::steady_clock::now();
+        pooled->lastHealthCheck = pooled->lastUsed;
+        connections.push_back(std::move(pooled));
+    }
+
+    if (progress) {
+        progress(0, size);
+    }
+
+    // The server is unreachable; don't wait out connect_timeout once per slot
+    if (!openConnection(*connections[0], connectionString, error)) {
+        if (error.empty()) {
+            error = "Failed to open database connection";
+        }
+        return false;
+    }
+
+    std::atomic<int> openCount(1);
+    if (progress) {
+        progress(1, size);
+    }
+
+    // Each connection is its own round-trips to the server, so the rest of the
+    // pool opens and prepares in the time of one
+    std::vector<std::thread> openers;
+    for (int i = 1; i < size; ++i) {
+        PooledConnection* pooled = connections[i].get();
+        openers.emplace_back([this, pooled, &connectionString, &openCount, &progress, size]() {
+            std::string slotError;
+            if (openConnection(*pooled, connectionString, slotError)) {
+                int opened = ++openCount;
+                if (progress) {
+                    progress(opened, size);
+                }
+            } else if (!slotError.empty()) {
+                qWarning() << "Pooled connection" << pooled->index << "failed to open:" << slotError.c_str();
+            }
+        });
+    }
+    for (std::thread& opener : openers) {
+        opener.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    connectionString_ = connectionString;
+    connections_ = std::move(connections);
+    idle_.clear();
+    for (auto& pooled : connections_) {
+        idle_.push_back(pooled.get());
+    }
+    leasedCount_ = 0;
+    closing_ = false;
+
+    qInfo() << "Connection pool opened with" << openCount.load() << "of" << size << "connections";
+    return true;
+}
+
+void ConnectionPool::close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (connections_.empty()) {
+        return;
+    }
+
+    closing_ = true;
+    available_.notify_all();
+
+    // Interrupt queries still running on leased connections so they return quickly
+    for (auto& pooled : connections_) {
+        bool isIdle = std::find(idle_.begin(), idle_.end(), pooled.get()) != idle_.end();
+        if (!isIdle && pooled->connection) {
+            try {
+                pooled->connection->cancel_query();
+            } catch (const std::exception&) {
+                // Best effort
+            }
+        }
+    }
+
+    drained_.wait(lock, [this]() { return leasedCount_ == 0; });
+
+    idle_.clear();
+    connections_.clear();
+    closing_ = false;
+}
+
+bool ConnectionPool::isOpen() const {
+    return healthyCount() > 0;
+}
+
+ConnectionLease ConnectionPool::acquire(std::chrono::milliseconds timeout, std::string& error) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    // Each idle connection gets one chance to pass its health check
+    size_t attempts = 0;
+    while (true) {
+        PooledConnection* pooled = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (connections_.empty() || closing_) {
+                error = "Connection pool is closed";
+                return ConnectionLease();
+            }
+
+            if (!available_.wait_until(lock, deadline, [this]() { return !idle_.empty() || closing_; })) {
+                error = "Timed out waiting for a pooled connection";
+                return ConnectionLease();
+            }
+            if (closing_) {
+                error = "Connection pool is closed";
+                return ConnectionLease();
+            }
+
+            pooled = idle_.back();
+            idle_.pop_back();
+            leasedCount_++;
+            attempts++;
+        }
+
+        if (ensureHealthy(*pooled, error)) {
+            pooled->lastUsed = std::chrono::steady_clock::now();
+            return ConnectionLease(this, pooled);
+        }
+
+        // Put the unhealthy connection at the back of the line and try another
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pooled->broken = true;
+            idle_.insert(idle_.begin(), pooled);
+            leasedCount_--;
+            if (closing_ && leasedCount_ == 0) {
+                drained_.notify_all();
+            }
+            if (attempts >= connections_.size()) {
+                return ConnectionLease();
+            }
+        }
+        available_.notify_one();
+    }
+}
+
+void ConnectionPool::setHealthCheckInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    healthCheckInterval_ = interval;
+}
+
+std::chrono::milliseconds ConnectionPool::getHealthCheckInterval() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return healthCheckInterval_;
+}
+
+int ConnectionPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(connections_.size());
+}
+
+int ConnectionPool::idleCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(idle_.size());
+}
+
+int ConnectionPool::healthyCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(std::count_if(connections_.begin(), connections_.end(),
+                                          [](const std::unique_ptr<PooledConnection>& pooled) {
+                                              return !pooled->broken;
+                                          }));
+}
+
+void ConnectionPool::release(PooledConnection* connection, bool broken) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (broken) {
+            connection->broken = true;
+        }
+        idle_.push_back(connection);
+        leasedCount_--;
+
+        if (closing_ && leasedCount_ == 0) {
+            drained_.notify_all();
+        }
+    }
+    available_.notify_one();
+}
+
+bool ConnectionPool::ensureHealthy(PooledConnection& connection, std::string& error) {
+    bool broken;
+    std::chrono::milliseconds interval;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        broken = connection.broken;
+        interval = healthCheckInterval_;
+    }
+
+    if (broken || !connection.connection || !connection.connection->is_open()) {
+        return reconnectConnection(connection, error);
+    }
+
+    // Ping connections that have sat idle longer than the health check interval
+    auto now = std::chrono::steady_clock::now();
+    if (interval.count() > 0 && now - connection.lastHealthCheck >= interval &&
+        now - connection.lastUsed >= interval) {
+        try {
+            pqxx::nontransaction ping(*connection.connection);
+            ping.exec("SELECT 1");
+            connection.lastHealthCheck = now;
+        } catch (const std::exception& e) {
+            qWarning() << "Pooled connection" << connection.index << "failed health check:" << e.what();
+            return reconnectConnection(connection, error);
+        }
+    }
+
+    return true;
+}
+
+bool ConnectionPool::reconnectConnection(PooledConnection& connection, std::string& error) {
+    std::string connectionString;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connectionString = connectionString_;
+    }
+
+    try {
+        connection.connection.reset();
+        connection.preparedStatements.clear();
+        connection.connection = std::make_unique<pqxx::connection>(connectionString);
+        if (!connection.connection->is_open()) {
+            error = "Failed to reopen pooled connection";
+            return false;
+        }
+    } catch (const std::exception& e) {
+        error = "Reconnect failed: " + std::string(e.what());
+        return false;
+    }
+
+    initializeConnection(connection);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection.broken = false;
+    }
+    connection.reconnectCount++;
+    connection.lastHealthCheck = std::chrono::steady_clock::now();
+
+    qInfo() << "Pooled connection" << connection.index << "reconnected";
+    return true;
+}
+
+bool ConnectionPool::openConnection(PooledConnection& connection, const std::string& connectionString,
+                                    std::string& error) {
+    try {
+        connection.connection = std::make_unique<pqxx::connection>(connectionString);
+        if (connection.connection->is_open()) {
+            initializeConnection(connection);
+            return true;
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    // Left broken; the first checkout reconnects it
+    connection.broken = true;
+    return false;
+}
+
+void ConnectionPool::initializeConnection(PooledConnection& connection) {
+    ConnectionInitializer initializer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        initializer = initializer_;
+    }
+
+    connection.preparedStatements.clear();
+    connection.statementTimeoutMs = -1;
+    if (initializer) {
+        initializer(connection);
+    }
+}
@@ -2,32 +2,89 @@
 #include "ConfigManager.h"
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+
+namespace {
+// Lets the server-side statement_timeout fire first; the cancel is a fallback
+const std::chrono::milliseconds kCancelGrace(500);
+const int kDeadlineCheckIntervalMs = 100;
+
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+}
+
+// Tracks one execution's deadline for as long as it holds its connection
+class DatabaseManager::DeadlineScope {
+public:
+    DeadlineScope(DatabaseManager* manager, PooledConnection* connection,
+                  const std::string& name, std::chrono::milliseconds timeout)
+        : manager_(manager)
+        , token_(0)
+    {
+        if (timeout.count() <= 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(manager_->activeQueriesMutex_);
+        token_ = manager_->nextQueryToken_++;
+        manager_->activeQueries_[token_] = ActiveQuery{
+            connection, std::chrono::steady_clock::now() + timeout + kCancelGrace, name, false};
+    }
+
+    ~DeadlineScope() {
+        if (token_ != 0) {
+            std::lock_guard<std::mutex> lock(manager_->activeQueriesMutex_);
+            manager_->activeQueries_.erase(token_);
+        }
+    }
+
+    DeadlineScope(const DeadlineScope&) = delete;
+    DeadlineScope& operator=(const DeadlineScope&) = delete;
+
+private:
+    DatabaseManager* manager_;
+    uint64_t token_;
+};
 
 DatabaseManager::DatabaseManager(ConfigManager* configManager, QObject *parent)
     : QObject(parent)
+    , connectionPool_(std::make_unique<ConnectionPool>())
     , isConnected_(false)
+    , nextQueryToken_(1)
+    , cancelledQueries_(0)
+    , deadlineTimer_(new QTimer(this))
     , configManager_(configManager)
     , reconnectTimer_(new QTimer(this))
     , autoReconnectEnabled_(false)
     , reconnectInterval_(5000)
     , connectionAttemptCount_(0)
+    , retryAfterConnect_(false)
+    , restartAfterConnect_(false)
+    , connectGeneration_(0)
+    , connecting_(false)
 {
     // Setup auto-reconnection timer
     reconnectTimer_->setSingleShot(true);
     reconnectTimer_->setInterval(reconnectInterval_);
-    connect(reconnectTimer_, &QTimer::timeout, this, &DatabaseManager::attemptReconnect);
+    QObject::connect(reconnectTimer_, &QTimer::timeout, this, &DatabaseManager::attemptReconnect);
+
+    // Watchdog for queries that outlive their timeout
+    deadlineTimer_->setInterval(kDeadlineCheckIntervalMs);
+    QObject::connect(deadlineTimer_, &QTimer::timeout, this, [this]() { cancelOverdueQueries(); });
+    deadlineTimer_->start();
 
-    // Load initial configuration
+    // Re-prepare every registered statement whenever a pooled connection (re)opens
+    connectionPool_->setConnectionInitializer([this](PooledConnection& connection) {
+        prepareRegisteredStatements(connection);
+    });
+
+    // Load initial configuration; without a config manager the caller sets one
     if (configManager_) {
         config_ = configManager_->getDatabaseConfig();
 
         // Connect to config changes
-        connect(configManager_, &ConfigManager::configChanged, this, &DatabaseManager::onConfigChanged);
-    }
-
-    // Try to load from default location if no config manager provided
-    if (!configManager_) {
-        loadConfigFromDefaultLocation();
+        QObject::connect(configManager_, &ConfigManager::configChanged, this, &DatabaseManager::onConfigChanged);
     }
 }
 
@@ -36,16 +93,20 @@ DatabaseManager::~DatabaseManager() {
 }
 
 bool DatabaseManager::connect(const DatabaseConfig& config) {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
-
-    if (!validateDatabaseConfig()) {
+    if (!config.isValid()) {
         setError("Invalid database configuration");
         return false;
     }
 
-    config_ = config;
-    connectionAttemptCount_++;
-    lastConnectionAttemptTime_ = QDateTime::currentDateTime();
+    waitForConnect();
+    connectGeneration_++;
+
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        config_ = config;
+        connectionAttemptCount_++;
+        lastConnectionAttemptTime_ = QDateTime::currentDateTime();
+    }
 
     bool success = createConnection();
     updateConnectionStatus(success);
@@ -74,105 +135,327 @@ bool DatabaseManager::connect(const std::string& configFilePath) {
     return false;
 }
 
+bool DatabaseManager::connectAsync(const DatabaseConfig& config) {
+    if (connecting_) {
+        qWarning() << "Database connect already in progress";
+        return false;
+    }
+    if (!config.isValid()) {
+        setError("Invalid database configuration");
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        config_ = config;
+        connectionAttemptCount_++;
+        lastConnectionAttemptTime_ = QDateTime::currentDateTime();
+    }
+
+    retryAfterConnect_ = false;
+    startConnect();
+    return true;
+}
+
+bool DatabaseManager::connectAsync() {
+    if (configManager_) {
+        return connectAsync(configManager_->getDatabaseConfig());
+    }
+
+    if (!config_.isValid()) {
+        setError("No database configuration available");
+        return false;
+    }
+
+    return connectAsync(getConnectionConfig());
+}
+
+bool DatabaseManager::isConnecting() const {
+    return connecting_;
+}
+
 bool DatabaseManager::isConnected() const {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
-    return isConnected_ && connection_ && connection_->is_open();
+    return isConnected_ && connectionPool_->isOpen();
 }
 
 void DatabaseManager::disconnect() {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
-
     if (reconnectTimer_) {
         reconnectTimer_->stop();
     }
 
-    if (connection_) {
-        connection_.reset();
+    waitForConnect();
+    connectGeneration_++;
+
+    if (connectionPool_->size() > 0) {
+        connectionPool_->close();
         updateConnectionStatus(false);
     }
 }
 
 bool DatabaseManager::reconnect() {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
+    waitForConnect();
+    connectGeneration_++;
+    connectionPool_->close();
 
-    disconnect();
-    return createConnection();
+    bool success = createConnection();
+    updateConnectionStatus(success);
+    return success;
 }
 
-pqxx::result DatabaseManager::executeQuery(const std::string& query) {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
-
-    if (!isConnected()) {
+ConnectionLease DatabaseManager::acquireConnection() {
+    if (!isConnected_) {
         throw std::runtime_error("Not connected to database");
     }
 
+    int timeoutSeconds;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        timeoutSeconds = config_.connectTimeout;
+    }
+
+    std::string error;
+    ConnectionLease lease = connectionPool_->acquire(std::chrono::seconds(timeoutSeconds), error);
+    if (!lease) {
+        if (!connectionPool_->isOpen()) {
+            setError("No usable pooled connections: " + error);
+            updateConnectionStatus(false);
+            if (autoReconnectEnabled_) {
+                QMetaObject::invokeMethod(this, "attemptReconnect", Qt::QueuedConnection);
+            }
+        }
+        throw std::runtime_error(error);
+    }
+
+    return lease;
+}
+
+int DatabaseManager::getPoolSize() const {
+    return connectionPool_->size();
+}
+
+int DatabaseManager::getIdleConnectionCount() const {
+    return connectionPool_->idleCount();
+}
+
+pqxx::result DatabaseManager::executeQuery(const std::string& query) {
+    ConnectionLease lease = acquireConnection();
+
     try {
-        pqxx::work transaction(*connection_);
+        pqxx::work transaction(*lease);
         pqxx::result result = transaction.exec(query);
         transaction.commit();
         return result;
     } catch (const std::exception& e) {
-        setError("Query execution failed: " + std::string(e.what()));
-        updateConnectionStatus(false);
+        handleQueryFailure(lease, e, "Query execution failed: ");
+        throw;
+    }
+}
 
-        // Trigger auto-reconnect if enabled
-        if (autoReconnectEnabled_) {
-            QMetaObject::invokeMethod(this, "attemptReconnect", Qt::QueuedConnection);
+pqxx::result DatabaseManager::executeQuery(const std::string& query, const std::vector<std::string>& params) {
+    ConnectionLease lease = acquireConnection();
+
+    try {
+        // Parameters are bound server-side rather than substituted into the text
+        pqxx::params bound;
+        for (const auto& param : params) {
+            bound.append(param);
         }
 
+        pqxx::work transaction(*lease);
+        pqxx::result result = transaction.exec_params(query, bound);
+        transaction.commit();
+        return result;
+    } catch (const std::exception& e) {
+        handleQueryFailure(lease, e, "Parameterized query execution failed: ");
         throw;
     }
 }
 
-pqxx::result DatabaseManager::executeQuery(const std::string& query, const std::vector<std::string>& params) {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
+void DatabaseManager::registerStatement(const std::string& name, const std::string& sql) {
+    std::lock_guard<std::mutex> lock(statementsMutex_);
+    statements_[name] = sql;
+}
 
-    if (!isConnected()) {
-        throw std::runtime_error("Not connected to database");
+void DatabaseManager::unregisterStatement(const std::string& name) {
+    std::lock_guard<std::mutex> lock(statementsMutex_);
+    statements_.erase(name);
+}
+
+bool DatabaseManager::hasStatement(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(statementsMutex_);
+    return statements_.count(name) > 0;
+}
+
+pqxx::result DatabaseManager::executePrepared(const std::string& name, const std::vector<std::optional<std::string>>& params,
+                                              std::chrono::milliseconds timeout, QueryTiming* timing) {
+    auto waitStart = std::chrono::steady_clock::now();
+    ConnectionLease lease = acquireConnection();
+    auto executeStart = std::chrono::steady_clock::now();
+    if (timing) {
+        timing->connectionWait = std::chrono::duration_cast<std::chrono::microseconds>(executeStart - waitStart);
     }
 
     try {
-        pqxx::work transaction(*connection_);
-
-        // Prepare statement with parameters
-        std::string preparedQuery = query;
-        for (size_t i = 0; i < params.size(); ++i) {
-            size_t pos = preparedQuery.find("$" + std::to_string(i + 1));
-            if (pos != std::string::npos) {
-                preparedQuery.replace(pos, 2, transaction.quote(params[i]));
-            }
+        ensurePrepared(*lease.get(), name);
+        applyStatementTimeout(*lease.get(), timeout);
+
+        // An empty optional is bound as NULL
+        pqxx::params bound;
+        for (const auto& param : params) {
+            bound.append(param);
         }
 
-        pqxx::result result = transaction.exec(preparedQuery);
-        transaction.commit();
+        // A single statement is atomic on its own; skip the BEGIN/COMMIT round-trips
+        DeadlineScope deadline(this, lease.get(), name, timeout);
+        pqxx::nontransaction transaction(*lease);
+        pqxx::result result = transaction.exec_prepared(name, bound);
+        if (timing) {
+            timing->execution = elapsedSince(executeStart);
+        }
         return result;
     } catch (const std::exception& e) {
-        setError("Parameterized query execution failed: " + std::string(e.what()));
+        if (timing) {
+            timing->execution = elapsedSince(executeStart);
+        }
+        handleQueryFailure(lease, e, "Prepared statement " + name + " failed: ");
+        throw;
+    }
+}
+
+std::vector<PreparedBatchResult> DatabaseManager::executePreparedBatch(const std::vector<std::string>& names,
+                                                                      std::chrono::milliseconds timeout,
+                                                                      QueryTiming* timing) {
+    std::vector<PreparedBatchResult> results(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        results[i].name = names[i];
+    }
+
+    if (names.empty()) {
+        return results;
+    }
+
+    auto waitStart = std::chrono::steady_clock::now();
+    ConnectionLease lease = acquireConnection();
+    auto executeStart = std::chrono::steady_clock::now();
+    if (timing) {
+        timing->connectionWait = std::chrono::duration_cast<std::chrono::microseconds>(executeStart - waitStart);
+    }
+
+    try {
+        std::vector<size_t> pipelined;
+        for (size_t i = 0; i < names.size(); ++i) {
+            try {
+                ensurePrepared(*lease.get(), names[i]);
+                pipelined.push_back(i);
+            } catch (const pqxx::broken_connection&) {
+                throw;
+            } catch (const std::exception& e) {
+                results[i].errorMessage = e.what();
+            }
+        }
+
+        // statement_timeout applies to each statement, so the batch as a whole gets the sum
+        applyStatementTimeout(*lease.get(), timeout);
+        DeadlineScope deadline(this, lease.get(), "batch of " + std::to_string(names.size()),
+                               timeout * static_cast<int>(names.size()));
+
+        // The server discards every statement after the first failing one
+        std::vector<size_t> retry;
+        {
+            pqxx::nontransaction transaction(*lease);
+            pqxx::pipeline pipeline(transaction);
+            pipeline.retain(static_cast<int>(pipelined.size()));
+
+            std::vector<pqxx::pipeline::query_id> queryIds;
+            for (size_t index : pipelined) {
+                queryIds.push_back(pipeline.insert("EXECUTE " + lease->quote_name(names[index])));
+            }
+            pipeline.complete();
+
+            bool aborted = false;
+            for (size_t i = 0; i < pipelined.size(); ++i) {
+                size_t index = pipelined[i];
+                if (aborted) {
+                    retry.push_back(index);
+                    continue;
+                }
+
+                try {
+                    results[index].data = pipeline.retrieve(queryIds[i]);
+                    results[index].success = true;
+                } catch (const pqxx::broken_connection&) {
+                    throw;
+                } catch (const std::exception& e) {
+                    results[index].errorMessage = e.what();
+                    aborted = true;
+                }
+            }
+        }
+
+        // Run the discarded statements one by one
+        for (size_t index : retry) {
+            try {
+                pqxx::nontransaction transaction(*lease);
+                results[index].data = transaction.exec_prepared(names[index]);
+                results[index].success = true;
+            } catch (const pqxx::broken_connection&) {
+                throw;
+            } catch (const std::exception& e) {
+                results[index].errorMessage = e.what();
+            }
+        }
+    } catch (const std::exception& e) {
+        handleQueryFailure(lease, e, "Batch execution failed: ");
+        for (auto& result : results) {
+            if (!result.success && result.errorMessage.empty()) {
+                result.errorMessage = e.what();
+            }
+        }
+    }
+
+    if (timing) {
+        timing->execution = elapsedSince(executeStart);
+    }
+    return results;
+}
+
+void DatabaseManager::handleQueryFailure(ConnectionLease& lease, const std::exception& e, const std::string& context) {
+    setError(context + std::string(e.what()));
+
+    // SQL errors leave the connection usable; only a lost socket affects connection state
+    if (!dynamic_cast<const pqxx::broken_connection*>(&e)) {
+        return;
+    }
+
+    lease.markBroken();
+    lease.release();
+
+    if (!connectionPool_->isOpen()) {
         updateConnectionStatus(false);
 
         // Trigger auto-reconnect if enabled
         if (autoReconnectEnabled_) {
             QMetaObject::invokeMethod(this, "attemptReconnect", Qt::QueuedConnection);
         }
-
-        throw;
     }
 }
 
 bool DatabaseManager::pingConnection() {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
-
-    if (!isConnected() || !connection_) {
+    if (!isConnected()) {
         return false;
     }
 
     try {
-        pqxx::work transaction(*connection_);
-        transaction.exec("SELECT 1");
-        transaction.commit();
-        return true;
+        ConnectionLease lease = acquireConnection();
+        try {
+            pqxx::nontransaction transaction(*lease);
+            transaction.exec("SELECT 1");
+            return true;
+        } catch (const std::exception& e) {
+            handleQueryFailure(lease, e, "Ping failed: ");
+            return false;
+        }
     } catch (const std::exception&) {
-        updateConnectionStatus(false);
         return false;
     }
 }
@@ -183,8 +466,10 @@ std::string DatabaseManager::getLastError() const {
 }
 
 void DatabaseManager::setConnectionConfig(const DatabaseConfig& config) {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
-    config_ = config;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        config_ = config;
+    }
 
     // Update config manager if available
     if (configManager_) {
@@ -192,14 +477,51 @@ void DatabaseManager::setConnectionConfig(const DatabaseConfig& config) {
     }
 }
 
-DatabaseConfig DatabaseManager::getConnectionConfig() const {
-    std::lock_guard<std::mutex> lock(connectionMutex_);
+bool DatabaseManager::applyConnectionConfig(const DatabaseConfig& config) {
+    bool reconnectNeeded;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        reconnectNeeded = !config.sameConnection(config_);
+        config_ = config;
+    }
 
+    if (!reconnectNeeded) {
+        connectionPool_->setHealthCheckInterval(std::chrono::seconds(config.healthCheckInterval));
+        return false;
+    }
+
+    // Reconnect with new configuration if currently connected
+    if (!isConnected() && !connecting_) {
+        return false;
+    }
+    qInfo() << "Database configuration changed, reconnecting...";
+
+    // A connect under way still has the old parameters; it starts over once it returns
+    if (connecting_) {
+        restartAfterConnect_ = true;
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        connectionAttemptCount_++;
+        lastConnectionAttemptTime_ = QDateTime::currentDateTime();
+    }
+
+    // In the background, so an unreachable new host never holds up the GUI
+    // thread or the scheduler; connectFinished reports how it went
+    retryAfterConnect_ = true;
+    startConnect();
+    return true;
+}
+
+DatabaseConfig DatabaseManager::getConnectionConfig() const {
     // Return config from config manager if available and using environment variables
     if (configManager_ && configManager_->useEnvironmentVariables()) {
         return configManager_->getDatabaseConfig();
     }
 
+    std::lock_guard<std::mutex> lock(connectionMutex_);
     return config_;
 }
 
@@ -211,7 +533,7 @@ void DatabaseManager::setConfigManager(ConfigManager* configManager) {
         config_ = configManager_->getDatabaseConfig();
 
         // Connect to config changes
-        connect(configManager_, &ConfigManager::configChanged, this, &DatabaseManager::onConfigChanged);
+        QObject::connect(configManager_, &ConfigManager::configChanged, this, &DatabaseManager::onConfigChanged);
     }
 }
 
@@ -313,21 +635,9 @@ int DatabaseManager::getConnectionAttemptCount() const {
 }
 
 void DatabaseManager::onConfigChanged() {
+    // Fired for every setting, not only the database ones
     if (configManager_) {
-        DatabaseConfig newConfig = configManager_->getDatabaseConfig();
-
-        // Check if database configuration actually changed
-        if (newConfig.host != config_.host || newConfig.port != config_.port ||
-            newConfig.database != config_.database || newConfig.username != config_.username) {
-
-            qInfo() << "Database configuration changed, reconnecting...";
-            config_ = newConfig;
-
-            // Reconnect with new configuration if currently connected
-            if (isConnected()) {
-                reconnect();
-            }
-        }
+        applyConnectionConfig(configManager_->getDatabaseConfig());
     }
 }
 
@@ -336,51 +646,197 @@ void DatabaseManager::attemptReconnect() {
         return;
     }
 
+    // The connect under way stands in for this attempt
+    if (connecting_) {
+        retryAfterConnect_ = true;
+        return;
+    }
+
     qInfo() << "Attempting database reconnection" << connectionAttemptCount_ << "...";
 
     emit reconnectionAttempt(connectionAttemptCount_);
 
-    if (reconnect()) {
-        qInfo() << "Database reconnection successful";
-        connectionAttemptCount_ = 0;
+    // In the background, so an unreachable server never holds up the GUI thread;
+    // finishConnect schedules the next attempt if this one fails
+    retryAfterConnect_ = true;
+    startConnect();
+}
+
+void DatabaseManager::startConnect() {
+    uint64_t generation = ++connectGeneration_;
+    connecting_ = true;
+
+    QThread* thread = QThread::create([this, generation]() {
+        bool connected = createConnection();
+        QMetaObject::invokeMethod(this, [this, connected, generation]() {
+            finishConnect(connected, generation);
+        }, Qt::QueuedConnection);
+    });
+    thread->setObjectName("DatabaseConnect");
+    thread->setParent(this);
+    QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connectThread_ = thread;
+    thread->start();
+}
+
+void DatabaseManager::finishConnect(bool connected, uint64_t generation) {
+    // The configuration changed while it ran; its outcome is for the old one
+    if (restartAfterConnect_ && generation == connectGeneration_) {
+        restartAfterConnect_ = false;
+        retryAfterConnect_ = true;
+        startConnect();
+        return;
+    }
+
+    connecting_ = false;
+    restartAfterConnect_ = false;
+    bool retry = retryAfterConnect_;
+    retryAfterConnect_ = false;
+
+    // A connect or disconnect made meanwhile has already set the status
+    if (generation != connectGeneration_) {
+        emit connectFinished(isConnected());
         return;
     }
 
-    // Schedule next reconnection attempt
-    if (reconnectTimer_ && autoReconnectEnabled_) {
-        reconnectTimer_->start();
+    updateConnectionStatus(connected);
+    if (retry) {
+        if (connected) {
+            qInfo() << "Database reconnection successful";
+            connectionAttemptCount_ = 0;
+        } else if (reconnectTimer_ && autoReconnectEnabled_) {
+            // Schedule next reconnection attempt
+            reconnectTimer_->start();
+        }
+    }
+
+    emit connectFinished(connected);
+}
+
+void DatabaseManager::waitForConnect() {
+    if (connectThread_) {
+        connectThread_->wait();
     }
 }
 
 bool DatabaseManager::createConnection() {
-    try {
-        std::string connectionString = buildConnectionString();
-        connection_ = std::make_unique<pqxx::connection>(connectionString);
+    DatabaseConfig config = getConnectionConfig();
+    connectionPool_->setHealthCheckInterval(std::chrono::seconds(config.healthCheckInterval));
+
+    // Emitted from whichever thread opened the connection
+    std::string error;
+    bool opened = connectionPool_->open(config.toConnectionString(), config.poolSize, error,
+                                        [this](int openedCount, int total) {
+        emit connectProgress(openedCount, total);
+    });
+    if (!opened) {
+        setError("Connection failed: " + error);
+        return false;
+    }
 
-        if (connection_->is_open()) {
-            isConnected_ = true;
-            lastError_.clear();
-            connectionEstablishedTime_ = QDateTime::currentDateTime();
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        lastError_.clear();
+        connectionEstablishedTime_ = QDateTime::currentDateTime();
+    }
 
-            // Test the connection
-            pqxx::work testTransaction(*connection_);
-            testTransaction.exec("SELECT 1");
-            testTransaction.commit();
+    qInfo() << "Database connection established successfully with" << connectionPool_->size()
+            << "pooled connections";
+    return true;
+}
 
-            qInfo() << "Database connection established successfully";
-            return true;
-        } else {
-            setError("Failed to open database connection");
-            return false;
+void DatabaseManager::prepareRegisteredStatements(PooledConnection& connection) {
+    std::map<std::string, std::string> statements;
+    {
+        std::lock_guard<std::mutex> lock(statementsMutex_);
+        statements = statements_;
+    }
+
+    for (const auto& pair : statements) {
+        try {
+            connection.connection->prepare(pair.first, pair.second);
+            connection.preparedStatements[pair.first] = pair.second;
+        } catch (const std::exception& e) {
+            // Left unprepared; the error resurfaces when the query runs
+            qWarning() << "Failed to prepare statement" << pair.first.c_str() << ":" << e.what();
         }
-    } catch (const std::exception& e) {
-        setError("Connection failed: " + std::string(e.what()));
-        return false;
     }
 }
 
+void DatabaseManager::ensurePrepared(PooledConnection& connection, const std::string& name) {
+    std::string sql;
+    {
+        std::lock_guard<std::mutex> lock(statementsMutex_);
+        auto it = statements_.find(name);
+        if (it == statements_.end()) {
+            throw std::runtime_error("Unknown prepared statement: " + name);
+        }
+        sql = it->second;
+    }
+
+    auto prepared = connection.preparedStatements.find(name);
+    if (prepared != connection.preparedStatements.end()) {
+        if (prepared->second == sql) {
+            return;
+        }
+
+        // The SQL changed since this connection prepared it
+        connection.connection->unprepare(name);
+        connection.preparedStatements.erase(prepared);
+    }
+
+    connection.connection->prepare(name, sql);
+    connection.preparedStatements[name] = sql;
+}
+
+void DatabaseManager::applyStatementTimeout(PooledConnection& connection, std::chrono::milliseconds timeout) {
+    // Leave the server default alone until a query asks for a timeout
+    if (connection.statementTimeoutMs == timeout.count() ||
+        (connection.statementTimeoutMs < 0 && timeout.count() <= 0)) {
+        return;
+    }
+
+    long long timeoutMs = std::max<long long>(0, timeout.count());
+    pqxx::nontransaction transaction(*connection.connection);
+    transaction.exec("SET statement_timeout = " + std::to_string(timeoutMs));
+    connection.statementTimeoutMs = timeoutMs;
+}
+
+int DatabaseManager::cancelOverdueQueries() {
+    int cancelled = 0;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(activeQueriesMutex_);
+    for (auto& pair : activeQueries_) {
+        ActiveQuery& active = pair.second;
+        if (active.cancelled || now < active.deadline) {
+            continue;
+        }
+
+        // libpq cancel requests are safe to send while another thread owns the connection
+        try {
+            active.connection->connection->cancel_query();
+            qWarning() << "Cancelled" << active.name.c_str() << "after it exceeded its deadline";
+        } catch (const std::exception& e) {
+            qWarning() << "Failed to cancel" << active.name.c_str() << ":" << e.what();
+        }
+        active.cancelled = true;
+        cancelled++;
+    }
+
+    cancelledQueries_ += cancelled;
+    return cancelled;
+}
+
+int DatabaseManager::getCancelledQueryCount() const {
+    return cancelledQueries_;
+}
+
 void DatabaseManager::setError(const std::string& error) {
-    lastError_ = error;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        lastError_ = error;
+    }
     qWarning() << "Database Error:" << QString::fromStdString(error);
 
     emit connectionError(error);
@@ -398,8 +854,7 @@ bool DatabaseManager::validateDatabaseConfig() const {
 }
 
 void DatabaseManager::updateConnectionStatus(bool connected) {
-    bool wasConnected = isConnected_;
-    isConnected_ = connected;
+    bool wasConnected = isConnected_.exchange(connected);
 
     if (wasConnected != connected) {
         emit connectionStatusChanged(connected);
@@ -411,5 +866,3 @@ void DatabaseManager::updateConnectionStatus(bool connected) {
         }
     }
 }
-
-#include "DatabaseManager.moc"
\ No newline at end of file
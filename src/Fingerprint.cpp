@@ -0,0 +1,178 @@
+#include "Fingerprint.h"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+// Marks a NULL field; no real field is this long
+const uint64_t kNullLength = ~0ULL;
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64(const unsigned char* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint32_t read32(const unsigned char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint64_t round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * kPrime2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t hash, uint64_t accumulator) {
+    hash ^= round(0, accumulator);
+    return hash * kPrime1 + kPrime4;
+}
+}
+
+Fingerprint::Fingerprint(uint64_t seed)
+    : seed_(seed)
+    , accumulators_{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1}
+    , buffer_{}
+    , bufferSize_(0)
+    , totalLength_(0)
+{
+}
+
+void Fingerprint::update(const void* data, size_t length) {
+    const unsigned char* input = static_cast<const unsigned char*>(data);
+    totalLength_ += length;
+
+    // Top up a partially filled stripe first
+    if (bufferSize_ > 0) {
+        size_t fill = std::min(length, sizeof(buffer_) - bufferSize_);
+        std::memcpy(buffer_ + bufferSize_, input, fill);
+        bufferSize_ += fill;
+        input += fill;
+        length -= fill;
+
+        if (bufferSize_ < sizeof(buffer_)) {
+            return;
+        }
+        consumeStripe(buffer_);
+        bufferSize_ = 0;
+    }
+
+    while (length >= sizeof(buffer_)) {
+        consumeStripe(input);
+        input += sizeof(buffer_);
+        length -= sizeof(buffer_);
+    }
+
+    if (length > 0) {
+        std::memcpy(buffer_, input, length);
+        bufferSize_ = length;
+    }
+}
+
+void Fingerprint::updateValue(uint64_t value) {
+    update(&value, sizeof(value));
+}
+
+void Fingerprint::updateField(const char* data, size_t length) {
+    updateValue(length);
+    update(data, length);
+}
+
+void Fingerprint::updateField(const std::string& value) {
+    updateField(value.data(), value.size());
+}
+
+uint64_t Fingerprint::digest() const {
+    uint64_t hash;
+    if (totalLength_ >= sizeof(buffer_)) {
+        hash = rotateLeft(accumulators_[0], 1) + rotateLeft(accumulators_[1], 7) +
+               rotateLeft(accumulators_[2], 12) + rotateLeft(accumulators_[3], 18);
+        for (uint64_t accumulator : accumulators_) {
+            hash = mergeRound(hash, accumulator);
+        }
+    } else {
+        hash = seed_ + kPrime5;
+    }
+
+    hash += totalLength_;
+
+    const unsigned char* tail = buffer_;
+    size_t remaining = bufferSize_;
+    while (remaining >= 8) {
+        hash ^= round(0, read64(tail));
+        hash = rotateLeft(hash, 27) * kPrime1 + kPrime4;
+        tail += 8;
+        remaining -= 8;
+    }
+    if (remaining >= 4) {
+        hash ^= static_cast<uint64_t>(read32(tail)) * kPrime1;
+        hash = rotateLeft(hash, 23) * kPrime2 + kPrime3;
+        tail += 4;
+        remaining -= 4;
+    }
+    while (remaining > 0) {
+        hash ^= (*tail) * kPrime5;
+        hash = rotateLeft(hash, 11) * kPrime1;
+        tail++;
+        remaining--;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t Fingerprint::ofResult(const pqxx::result& result) {
+    Fingerprint fingerprint;
+    fingerprint.updateValue(result.size());
+    fingerprint.updateValue(static_cast<uint64_t>(result.columns()));
+
+    // Raw field bytes; no conversions, so NULLs and odd types can't throw
+    for (const auto& row : result) {
+        fingerprint.updateRow(row);
+    }
+
+    return fingerprint.digest();
+}
+
+uint64_t Fingerprint::ofRows(const pqxx::result& result, const std::vector<pqxx::result::size_type>& rows) {
+    Fingerprint fingerprint;
+    fingerprint.updateValue(rows.size());
+    fingerprint.updateValue(static_cast<uint64_t>(result.columns()));
+
+    for (auto index : rows) {
+        fingerprint.updateRow(result[index]);
+    }
+
+    return fingerprint.digest();
+}
+
+void Fingerprint::updateRow(const pqxx::row& row) {
+    for (const auto& field : row) {
+        if (field.is_null()) {
+            updateValue(kNullLength);
+        } else {
+            updateField(field.c_str(), field.size());
+        }
+    }
+}
+
+void Fingerprint::consumeStripe(const unsigned char* stripe) {
+    for (int lane = 0; lane < 4; ++lane) {
+        accumulators_[lane] = round(accumulators_[lane], read64(stripe + lane * 8));
+    }
+}
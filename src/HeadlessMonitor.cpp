@@ -0,0 +1,219 @@
+#include "HeadlessMonitor.h"
+#include "MonitorRuntime.h"
+#include "AlertSystem.h"
+#include "AlertExporter.h"
+#include "DatabaseManager.h"
+#include "QueryEngine.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QDebug>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+const int kShutdownPollMs = 200;
+const int kReconnectDelayMs = 5000;
+
+volatile std::sig_atomic_t shutdownRequested = 0;
+
+extern "C" void requestShutdown(int) {
+    shutdownRequested = 1;
+}
+}
+
+HeadlessMonitor::HeadlessMonitor(MonitorRuntime* runtime, HeadlessOutput output, QObject *parent)
+    : QObject(parent)
+    , runtime_(runtime)
+    , output_(output)
+    , shutdownPoll_(new QTimer(this))
+    , printedCount_(0)
+{
+    connect(runtime_->queryEngine(), &QueryEngine::alertGenerated,
+            this, &HeadlessMonitor::onAlertGenerated);
+    connect(runtime_->queryEngine(), &QueryEngine::queryError,
+            this, &HeadlessMonitor::onQueryError);
+    connect(runtime_->databaseManager(), &DatabaseManager::connectionStatusChanged,
+            this, &HeadlessMonitor::onConnectionStatusChanged);
+
+    // Any target coming up is enough to monitor; each one reconnects on its own
+    QueryEngine* engine = runtime_->queryEngine();
+    for (const std::string& name : engine->getTargetNames()) {
+        DatabaseManager* target = engine->getTarget(name);
+        if (target == runtime_->databaseManager()) {
+            continue;
+        }
+        connect(target, &DatabaseManager::connectionStatusChanged, this, [this, name](bool connected) {
+            std::cerr << "Database target " << name << (connected ? " connected.\n" : " disconnected.\n");
+            if (connected) {
+                startMonitoring();
+            }
+        });
+    }
+
+    // Signal handlers only set a flag; the event loop picks it up from here
+    connect(shutdownPoll_, &QTimer::timeout, this, &HeadlessMonitor::checkForShutdown);
+    shutdownPoll_->start(kShutdownPollMs);
+}
+
+HeadlessMonitor::~HeadlessMonitor() = default;
+
+int HeadlessMonitor::exec(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("PostgreSQL Monitor");
+    QCoreApplication::setApplicationVersion("1.0");
+    QCoreApplication::setOrganizationName("Database Monitoring Systems");
+    QCoreApplication::setOrganizationDomain("dbmonitor.local");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PostgreSQL Real-Time Monitor (headless)");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption configOption(QStringList() << "c" << "config",
+                                    "Path to configuration file", "file", "config.txt");
+    parser.addOption(configOption);
+
+    QCommandLineOption debugOption(QStringList() << "debug", "Enable debug output");
+    parser.addOption(debugOption);
+
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "Alerts on stdout: text, json or none", "format", "text");
+    parser.addOption(outputOption);
+
+    // Accepted so both executables take the same command line
+    QCommandLineOption headlessOption(QStringList() << "headless", "Run without the alert window");
+    parser.addOption(headlessOption);
+
+    parser.process(app);
+
+    HeadlessOutput output;
+    if (!parseOutput(parser.value(outputOption), output)) {
+        std::cerr << "Unknown output format: " << parser.value(outputOption).toStdString()
+                  << " (expected text, json or none)\n";
+        return 2;
+    }
+
+    bool debugMode = parser.isSet(debugOption);
+    if (debugMode) {
+        QLoggingCategory::setFilterRules("*.debug=true");
+        qDebug() << "Debug mode enabled";
+    }
+
+    std::cerr << "Starting PostgreSQL Real-Time Monitor (headless)...\n";
+
+    // stdout carries alerts only, so startup messages go to stderr
+    MonitorRuntime runtime(std::cerr);
+    runtime.loadConfig(parser.value(configOption));
+    runtime.start();
+
+    if (debugMode) {
+        runtime.printStartupInfo();
+    }
+
+    HeadlessMonitor monitor(&runtime, output);
+    installSignalHandlers();
+
+    bool connected = runtime.connectDatabase();
+    if (!connected) {
+        std::cerr << "Monitoring starts once the database is reachable.\n";
+        QTimer::singleShot(kReconnectDelayMs, runtime.databaseManager(), &DatabaseManager::attemptReconnect);
+    }
+    if (connected || runtime.connectedTargetCount() > 0) {
+        monitor.startMonitoring();
+    }
+
+    int result = app.exec();
+
+    runtime.shutdown();
+    std::cerr << "Headless monitor shutdown.\n";
+    return result;
+}
+
+bool HeadlessMonitor::parseOutput(const QString& name, HeadlessOutput& output) {
+    QString value = name.trimmed().toLower();
+    if (value == "text") {
+        output = HeadlessOutput::Text;
+    } else if (value == "json" || value == "jsonl") {
+        output = HeadlessOutput::JSONLines;
+    } else if (value == "none") {
+        output = HeadlessOutput::None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string HeadlessMonitor::formatTextLine(const Alert& alert) {
+    std::string line = alert.timestamp.toString("yyyy-MM-dd hh:mm:ss.zzz").toStdString();
+    line += ' ';
+    line += alert.getTypeString();
+    line += " [";
+    line += alert.querySource.view();
+    line += "] ";
+    line += alert.title.view();
+    line += ": ";
+
+    // One alert per line, whatever the query returned
+    for (char c : alert.message) {
+        line += (c == '\n' || c == '\r') ? ' ' : c;
+    }
+    line += '\n';
+    return line;
+}
+
+int HeadlessMonitor::getPrintedCount() const {
+    return printedCount_;
+}
+
+void HeadlessMonitor::onAlertGenerated(const Alert& alert) {
+    if (output_ == HeadlessOutput::None) {
+        return;
+    }
+
+    std::string line = output_ == HeadlessOutput::JSONLines ? AlertExporter::toJsonLine(alert)
+                                                            : formatTextLine(alert);
+    std::fwrite(line.data(), 1, line.size(), stdout);
+    std::fflush(stdout);
+    printedCount_++;
+}
+
+void HeadlessMonitor::onConnectionStatusChanged(bool connected) {
+    if (connected) {
+        std::cerr << "Database connected.\n";
+        startMonitoring();
+        return;
+    }
+
+    std::cerr << "Database disconnected; reconnecting in " << kReconnectDelayMs / 1000 << "s.\n";
+    QTimer::singleShot(kReconnectDelayMs, runtime_->databaseManager(), &DatabaseManager::attemptReconnect);
+}
+
+void HeadlessMonitor::onQueryError(const std::string& queryId, const std::string& error) {
+    if (queryId.empty()) {
+        std::cerr << "Monitoring: " << error << "\n";
+    } else {
+        std::cerr << "Query " << queryId << ": " << error << "\n";
+    }
+}
+
+void HeadlessMonitor::checkForShutdown() {
+    if (shutdownRequested) {
+        shutdownPoll_->stop();
+        std::cerr << "Shutdown requested.\n";
+        QCoreApplication::quit();
+    }
+}
+
+void HeadlessMonitor::installSignalHandlers() {
+    std::signal(SIGINT, requestShutdown);
+    std::signal(SIGTERM, requestShutdown);
+}
+
+void HeadlessMonitor::startMonitoring() {
+    QueryEngine* engine = runtime_->queryEngine();
+    if (!engine->isMonitoring()) {
+        engine->startMonitoring();
+    }
+}
@@ -0,0 +1,154 @@
+#include "KeywordMatcher.h"
+#include <algorithm>
+#include <queue>
+
+namespace {
+const uint32_t kNoState = UINT32_MAX;
+
+unsigned char foldCase(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+}
+}
+
+KeywordMatcher::KeywordMatcher()
+    : classCount_(1)
+    , stateCount_(1)
+    , compiled_(false)
+{
+    std::fill(std::begin(classOf_), std::end(classOf_), 0);
+}
+
+void KeywordMatcher::add(const std::string& keyword, int category) {
+    if (keyword.empty() || category < 0 || category >= kMaxCategories) {
+        return;
+    }
+
+    Keyword entry{keyword, category};
+    for (char& c : entry.text) {
+        c = static_cast<char>(foldCase(static_cast<unsigned char>(c)));
+    }
+    keywords_.push_back(std::move(entry));
+    compiled_ = false;
+}
+
+void KeywordMatcher::compile() {
+    // Byte classes: one per distinct keyword byte, shared by both cases of a letter
+    std::fill(std::begin(classOf_), std::end(classOf_), 0);
+    classCount_ = 1;
+    for (const auto& keyword : keywords_) {
+        for (char ch : keyword.text) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            if (classOf_[c] == 0) {
+                classOf_[c] = static_cast<uint8_t>(classCount_++);
+                if (c >= 'a' && c <= 'z') {
+                    classOf_[c - 'a' + 'A'] = classOf_[c];
+                }
+            }
+        }
+    }
+
+    // Trie of the keywords, state 0 the root: state * classCount_ + class -> state,
+    // and the categories ending at each state
+    std::vector<uint32_t> transitions(static_cast<size_t>(classCount_), kNoState);
+    std::vector<uint32_t> outputs(1, 0);
+    for (const auto& keyword : keywords_) {
+        uint32_t state = 0;
+        for (char ch : keyword.text) {
+            size_t slot = static_cast<size_t>(state) * classCount_ + classOf_[static_cast<unsigned char>(ch)];
+            if (transitions[slot] == kNoState) {
+                transitions[slot] = static_cast<uint32_t>(outputs.size());
+                outputs.push_back(0);
+                transitions.resize(transitions.size() + classCount_, kNoState);
+            }
+            state = transitions[slot];
+        }
+        outputs[state] |= uint32_t(1) << keyword.category;
+    }
+
+    // Breadth-first, so each state's failure link is complete before its children use it;
+    // missing edges are then filled in, turning the trie into a DFA
+    std::vector<uint32_t> failure(outputs.size(), 0);
+    std::queue<uint32_t> pending;
+    for (int c = 0; c < classCount_; ++c) {
+        uint32_t& next = transitions[c];
+        if (next == kNoState) {
+            next = 0;
+        } else {
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty()) {
+        uint32_t state = pending.front();
+        pending.pop();
+        outputs[state] |= outputs[failure[state]];
+
+        for (int c = 0; c < classCount_; ++c) {
+            size_t slot = static_cast<size_t>(state) * classCount_ + c;
+            uint32_t fallback = transitions[static_cast<size_t>(failure[state]) * classCount_ + c];
+            if (transitions[slot] == kNoState) {
+                transitions[slot] = fallback;
+            } else {
+                failure[transitions[slot]] = fallback;
+                pending.push(transitions[slot]);
+            }
+        }
+    }
+
+    const size_t classes = static_cast<size_t>(classCount_);
+    stateCount_ = outputs.size();
+    scanTable_.resize(transitions.size());
+    scanOutputs_.assign(transitions.size(), 0);
+    for (size_t slot = 0; slot < transitions.size(); ++slot) {
+        scanTable_[slot] = static_cast<uint32_t>(transitions[slot] * classes);
+    }
+    for (size_t state = 0; state < outputs.size(); ++state) {
+        scanOutputs_[state * classes] = outputs[state];
+    }
+
+    compiled_ = true;
+}
+
+uint32_t KeywordMatcher::scan(const char* data, size_t length, uint32_t stopOn) const {
+    if (!compiled_ || keywords_.empty()) {
+        return 0;
+    }
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const uint32_t* table = scanTable_.data();
+    const uint32_t* outputs = scanOutputs_.data();
+
+    uint32_t found = 0;
+    uint32_t offset = 0;
+    for (size_t i = 0; i < length; ++i) {
+        offset = table[offset + classOf_[bytes[i]]];
+        uint32_t output = outputs[offset];
+        if (output) {
+            found |= output;
+            if (found & stopOn) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+std::vector<std::string> KeywordMatcher::splitList(const std::string& list) {
+    std::vector<std::string> keywords;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) {
+            comma = list.size();
+        }
+
+        std::string keyword = list.substr(start, comma - start);
+        size_t first = keyword.find_first_not_of(" \t");
+        size_t last = keyword.find_last_not_of(" \t");
+        if (first != std::string::npos) {
+            keywords.push_back(keyword.substr(first, last - first + 1));
+        }
+        start = comma + 1;
+    }
+    return keywords;
+}
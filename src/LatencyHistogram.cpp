@@ -0,0 +1,139 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const uint64_t kSubBucketCount = uint64_t(1) << LatencyHistogram::kSubBucketBits;
+const uint64_t kMaxValue = (uint64_t(1) << LatencyHistogram::kMaxExponent) - 1;
+
+int highestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+double toMs(uint64_t micros) {
+    return static_cast<double>(micros) / 1000.0;
+}
+}
+
+LatencyHistogram::LatencyHistogram()
+    : count_(0)
+    , sumMicros_(0)
+    , maxMicros_(0)
+{
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(std::chrono::microseconds value) {
+    uint64_t micros = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+
+    buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sumMicros_.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t previous = maxMicros_.load(std::memory_order_relaxed);
+    while (micros > previous &&
+           !maxMicros_.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sumMicros_.store(0, std::memory_order_relaxed);
+    maxMicros_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const {
+    LatencySnapshot snapshot;
+    snapshot.buckets.resize(kBucketCount);
+
+    // The count is taken from the buckets so percentiles stay consistent with them
+    for (int i = 0; i < kBucketCount; ++i) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sumMicros = sumMicros_.load(std::memory_order_relaxed);
+    snapshot.maxMicros = maxMicros_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t micros) {
+    micros = std::min(micros, kMaxValue);
+    if (micros < kSubBucketCount) {
+        return static_cast<int>(micros);
+    }
+
+    int exponent = highestBit(micros);
+    int shift = exponent - kSubBucketBits;
+    uint64_t subBucket = (micros >> shift) - kSubBucketCount;
+    return ((shift + 1) << kSubBucketBits) + static_cast<int>(subBucket);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    int group = index >> kSubBucketBits;
+    uint64_t subBucket = static_cast<uint64_t>(index) & (kSubBucketCount - 1);
+    if (group == 0) {
+        return subBucket;
+    }
+
+    int shift = group - 1;
+    return ((kSubBucketCount + subBucket + 1) << shift) - 1;
+}
+
+void LatencySnapshot::add(const LatencySnapshot& other) {
+    if (buckets.size() < other.buckets.size()) {
+        buckets.resize(other.buckets.size());
+    }
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumMicros += other.sumMicros;
+    maxMicros = std::max(maxMicros, other.maxMicros);
+}
+
+uint64_t LatencySnapshot::percentileMicros(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    // Nearest rank; the bucket's upper bound never overstates the recorded maximum
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count)));
+    rank = std::clamp<uint64_t>(rank, 1, count);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(LatencyHistogram::bucketUpperBound(static_cast<int>(i)), maxMicros);
+        }
+    }
+    return maxMicros;
+}
+
+LatencySummary LatencySnapshot::summary() const {
+    LatencySummary summary;
+    summary.count = count;
+    if (count == 0) {
+        return summary;
+    }
+
+    summary.p50Ms = toMs(percentileMicros(50.0));
+    summary.p95Ms = toMs(percentileMicros(95.0));
+    summary.p99Ms = toMs(percentileMicros(99.0));
+    summary.maxMs = toMs(maxMicros);
+    summary.meanMs = toMs(sumMicros) / static_cast<double>(count);
+    return summary;
+}
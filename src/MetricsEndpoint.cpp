@@ -0,0 +1,295 @@
+#include "MetricsEndpoint.h"
+#include "AlertDispatcher.h"
+#include "AlertSystem.h"
+#include "QueryEngine.h"
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+#include <cctype>
+#include <cmath>
+
+namespace {
+const int kMaxRequestBytes = 8192;
+const int kRequestTimeoutMs = 10000;
+const char* const kMetricsContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+void respond(QTcpSocket* socket, int status, const char* reason, const char* contentType,
+             const QByteArray& body, bool headOnly) {
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n";
+    response += QByteArray("Content-Type: ") + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    if (!headOnly) {
+        response += body;
+    }
+
+    // One request per connection; later bytes are read and ignored
+    socket->setProperty("answered", true);
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+std::string formatValue(double value) {
+    if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        return std::to_string(static_cast<int64_t>(value));
+    }
+    return QByteArray::number(value, 'g', 10).toStdString();
+}
+
+// A label pair, with the value escaped as the text format asks
+std::string label(const char* key, const std::string& value) {
+    std::string pair = std::string(key) + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            pair += '\\';
+            pair += c;
+        } else if (c == '\n') {
+            pair += "\\n";
+        } else {
+            pair += c;
+        }
+    }
+    return pair + "\"";
+}
+
+void family(std::string& out, const std::string& name, const char* type, const char* help) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+void sample(std::string& out, const std::string& name, double value, const std::string& labels = std::string()) {
+    out += name;
+    if (!labels.empty()) {
+        out += "{" + labels + "}";
+    }
+    out += " " + formatValue(value) + "\n";
+}
+
+void metric(std::string& out, const std::string& name, const char* type, const char* help, double value) {
+    family(out, name, type, help);
+    sample(out, name, value);
+}
+
+void summary(std::string& out, const std::string& name, const char* help, const LatencySummary& latency) {
+    family(out, name, "summary", help);
+    sample(out, name, latency.p50Ms / 1000.0, "quantile=\"0.5\"");
+    sample(out, name, latency.p95Ms / 1000.0, "quantile=\"0.95\"");
+    sample(out, name, latency.p99Ms / 1000.0, "quantile=\"0.99\"");
+    sample(out, name + "_sum", latency.meanMs * static_cast<double>(latency.count) / 1000.0);
+    sample(out, name + "_count", static_cast<double>(latency.count));
+}
+
+std::string typeLabel(AlertType type) {
+    std::string name = Alert::typeToString(type);
+    for (char& c : name) {
+        c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+    }
+    return label("type", name);
+}
+}
+
+MetricsEndpoint::MetricsEndpoint(Renderer renderer)
+    : renderer_(std::move(renderer))
+    , thread_(nullptr)
+    , server_(nullptr)
+    , port_(0)
+    , scrapes_(0)
+{
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    stop();
+}
+
+bool MetricsEndpoint::start(const QString& address, int port, std::string& error) {
+    if (thread_) {
+        return true;
+    }
+
+    QHostAddress host(QHostAddress::Any);
+    if (!address.isEmpty() && !host.setAddress(address)) {
+        error = "Invalid metrics address: " + address.toStdString();
+        return false;
+    }
+
+    // The server and its sockets belong to the endpoint's thread and are
+    // deleted there when it finishes
+    thread_ = new QThread();
+    thread_->setObjectName("MetricsEndpoint");
+    server_ = new QTcpServer();
+    server_->moveToThread(thread_);
+    QObject::connect(thread_, &QThread::finished, server_, &QObject::deleteLater);
+    thread_->start();
+
+    QString listenError;
+    QMetaObject::invokeMethod(server_, [this, host, port, &listenError]() {
+        if (!server_->listen(host, static_cast<quint16>(port))) {
+            listenError = server_->errorString();
+            return;
+        }
+        port_ = server_->serverPort();
+
+        QObject::connect(server_, &QTcpServer::newConnection, server_, [this]() {
+            while (QTcpSocket* socket = server_->nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    serve(socket);
+                });
+                QTimer::singleShot(kRequestTimeoutMs, socket, [socket]() {
+                    socket->abort();
+                });
+            }
+        });
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listenError.isEmpty()) {
+        error = "Cannot listen on " + host.toString().toStdString() + ":" + std::to_string(port)
+              + ": " + listenError.toStdString();
+        stop();
+        return false;
+    }
+
+    qDebug() << "Metrics endpoint listening on" << host.toString() << "port" << port_;
+    return true;
+}
+
+void MetricsEndpoint::stop() {
+    if (!thread_) {
+        return;
+    }
+
+    thread_->quit();
+    thread_->wait();
+    delete thread_;
+    thread_ = nullptr;
+    server_ = nullptr;
+    port_ = 0;
+}
+
+bool MetricsEndpoint::isRunning() const {
+    return thread_ && thread_->isRunning();
+}
+
+void MetricsEndpoint::serve(QTcpSocket* socket) {
+    if (socket->property("answered").toBool()) {
+        socket->readAll();
+        return;
+    }
+
+    // Nothing here takes a body, so the request ends with its headers
+    QByteArray head = socket->peek(kMaxRequestBytes + 1);
+    int headerEnd = head.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (head.size() > kMaxRequestBytes) {
+            respond(socket, 431, "Request Header Fields Too Large", "text/plain", QByteArray(), false);
+        }
+        return;
+    }
+    socket->read(headerEnd + 4);
+
+    QList<QByteArray> requestLine = head.left(head.indexOf("\r\n")).split(' ');
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+    int queryStart = path.indexOf('?');
+    if (queryStart >= 0) {
+        path.truncate(queryStart);
+    }
+
+    bool headOnly = method == "HEAD";
+    if (method != "GET" && !headOnly) {
+        respond(socket, 405, "Method Not Allowed", "text/plain", "Method not allowed\n", false);
+    } else if (path != "/metrics") {
+        respond(socket, 404, "Not Found", "text/plain", "Metrics are at /metrics\n", headOnly);
+    } else {
+        scrapes_++;
+        respond(socket, 200, "OK", kMetricsContentType, QByteArray::fromStdString(renderer_()), headOnly);
+    }
+}
+
+std::string MetricsEndpoint::renderMetrics(const QueryEngine* engine, const AlertSystem* alertSystem,
+                                           const AlertDispatcher* dispatcher) {
+    std::string out;
+
+    if (engine) {
+        metric(out, "pgmonitor_queries_executed_total", "counter", "Query runs completed.",
+               engine->getExecutedQueriesCount());
+        metric(out, "pgmonitor_query_failures_total", "counter", "Query runs that failed.",
+               engine->getFailedQueriesCount());
+        metric(out, "pgmonitor_query_runs_dropped_total", "counter", "Runs dropped because the queue was full.",
+               engine->getDroppedQueriesCount());
+        metric(out, "pgmonitor_query_runs_skipped_total", "counter", "Runs skipped because the last one was still running.",
+               engine->getSkippedQueriesCount());
+        metric(out, "pgmonitor_query_runs_cancelled_total", "counter", "Runs cancelled on the server.",
+               engine->getCancelledQueriesCount());
+        metric(out, "pgmonitor_scheduler_tick_overruns_total", "counter", "Scheduler ticks that found runs still waiting for a worker.",
+               engine->getTickOverrunCount());
+        metric(out, "pgmonitor_scheduler_missed_runs_total", "counter", "Whole periods the scheduler skipped after falling behind.",
+               engine->getMissedRunCount());
+        metric(out, "pgmonitor_notifications_total", "counter", "LISTEN notifications received.",
+               engine->getNotificationCount());
+        metric(out, "pgmonitor_query_queue_depth", "gauge", "Runs waiting for a worker.",
+               engine->getQueueDepth());
+        metric(out, "pgmonitor_query_queue_depth_max", "gauge", "Deepest the run queue has been.",
+               engine->getMaxQueueDepth());
+        metric(out, "pgmonitor_active_workers", "gauge", "Workers running a query.",
+               engine->getActiveWorkerCount());
+
+        summary(out, "pgmonitor_query_duration_seconds", "Server round-trip of every query.",
+                engine->getOverallLatency());
+        summary(out, "pgmonitor_scheduler_lag_seconds", "How late the scheduler fired runs.",
+                engine->getSchedulerLag());
+        summary(out, "pgmonitor_queue_wait_seconds", "How long runs waited for a worker.",
+                engine->getQueueWait());
+
+        family(out, "pgmonitor_query_executions_total", "counter", "Runs completed, by query and target.");
+        for (const auto& pair : engine->getQueryExecutionCounts()) {
+            sample(out, "pgmonitor_query_executions_total", pair.second, label("query", pair.first));
+        }
+    }
+
+    const AlertType types[] = { AlertType::CRITICAL, AlertType::WARNING, AlertType::INFO };
+    if (alertSystem) {
+        family(out, "pgmonitor_alerts_stored", "gauge", "Alerts held in memory, by type.");
+        for (AlertType type : types) {
+            sample(out, "pgmonitor_alerts_stored", alertSystem->getAlertCountByType(type), typeLabel(type));
+        }
+    }
+
+    if (dispatcher) {
+        family(out, "pgmonitor_alerts_published_total", "counter", "Alerts published to the sinks, by type.");
+        for (AlertType type : types) {
+            sample(out, "pgmonitor_alerts_published_total", dispatcher->getPublishedCount(type), typeLabel(type));
+        }
+
+        std::vector<AlertSinkStats> sinks = dispatcher->getStats();
+        struct SinkMetric {
+            const char* name;
+            const char* type;
+            const char* help;
+            double (*value)(const AlertSinkStats&);
+        };
+        const SinkMetric sinkMetrics[] = {
+            { "pgmonitor_alert_sink_up", "gauge", "Whether the sink is open.",
+              [](const AlertSinkStats& s) { return s.open ? 1.0 : 0.0; } },
+            { "pgmonitor_alert_sink_pending", "gauge", "Alerts queued for the sink.",
+              [](const AlertSinkStats& s) { return static_cast<double>(s.pending); } },
+            { "pgmonitor_alert_sink_delivered_total", "counter", "Alerts the sink delivered.",
+              [](const AlertSinkStats& s) { return static_cast<double>(s.delivered); } },
+            { "pgmonitor_alert_sink_dropped_total", "counter", "Alerts the sink dropped undelivered.",
+              [](const AlertSinkStats& s) { return static_cast<double>(s.dropped); } },
+            { "pgmonitor_alert_sink_failures_total", "counter", "Failed attempts to open the sink or deliver a batch.",
+              [](const AlertSinkStats& s) { return static_cast<double>(s.failures); } },
+        };
+        for (const SinkMetric& sinkMetric : sinkMetrics) {
+            family(out, sinkMetric.name, sinkMetric.type, sinkMetric.help);
+            for (const AlertSinkStats& sink : sinks) {
+                sample(out, sinkMetric.name, sinkMetric.value(sink), label("sink", sink.name));
+            }
+        }
+    }
+
+    return out;
+}
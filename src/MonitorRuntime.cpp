@@ -0,0 +1,499 @@
+#include "MonitorRuntime.h"
+#include "AlertDispatcher.h"
+#include "AlertJournal.h"
+#include "AlertSystem.h"
+#include "ConfigWatcher.h"
+#include "DatabaseManager.h"
+#include "MetricsEndpoint.h"
+#include "QueryEngine.h"
+#include <QFileInfo>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+const int kReconnectIntervalMs = 5000;
+const int kSinkDrainTimeoutMs = 2000;
+}
+
+MonitorRuntime::MonitorRuntime(std::ostream& log)
+    : log_(log)
+    , configManager_(std::make_unique<ConfigManager>())
+    , configLoaded_(false)
+{
+}
+
+MonitorRuntime::~MonitorRuntime() {
+    shutdown();
+}
+
+bool MonitorRuntime::loadConfig(const QString& configFilePath) {
+    configLoaded_ = false;
+
+    if (QFileInfo::exists(configFilePath)) {
+        configLoaded_ = configManager_->loadFromFile(configFilePath);
+        if (configLoaded_) {
+            configFilePath_ = configFilePath;
+            log_ << "Loaded configuration from: " << configFilePath.toStdString() << "\n";
+        } else {
+            log_ << "Warning: Failed to load config from " << configFilePath.toStdString() << "\n";
+        }
+        return configLoaded_;
+    }
+
+    // Try to find config file in common locations
+    QStringList searchPaths = {
+        "config.txt",
+        "config/config.txt",
+        "../config.txt",
+        "../../config.txt"
+    };
+
+    for (const QString& path : searchPaths) {
+        if (QFileInfo::exists(path) && configManager_->loadFromFile(path)) {
+            configFilePath_ = path;
+            configLoaded_ = true;
+            log_ << "Loaded configuration from: " << path.toStdString() << "\n";
+            return true;
+        }
+    }
+
+    log_ << "No configuration file found. Using defaults and creating config.txt\n";
+    configManager_->saveToDefaultLocation();
+    return false;
+}
+
+void MonitorRuntime::start() {
+    if (queryEngine_) {
+        return;
+    }
+
+    // The journal and sinks outlive the alert system that writes to them.
+    // Scanning the journal's segments is the slow part of startup, so it runs
+    // alongside the rest; nothing can raise an alert before it is attached.
+    AlertConfig alertConfig = configManager_->getAlertConfig();
+    std::string journalError;
+    std::unique_ptr<QThread> journalOpener(QThread::create([this, &alertConfig, &journalError]() {
+        openJournal(alertConfig, journalError);
+    }));
+    journalOpener->setObjectName("AlertJournalOpen");
+    journalOpener->start();
+    openSinks(alertConfig);
+
+    alertSystem_ = std::make_unique<AlertSystem>();
+    alertSystem_->setDuplicateDetectionEnabled(alertConfig.duplicateDetectionEnabled);
+    alertSystem_->setDuplicateTimeWindow(alertConfig.duplicateTimeWindow);
+    alertSystem_->setMaxAlerts(alertConfig.maxAlerts);
+    alertSystem_->setClassificationKeywords(KeywordMatcher::splitList(alertConfig.criticalKeywords.toStdString()),
+                                            KeywordMatcher::splitList(alertConfig.warningKeywords.toStdString()));
+    alertSystem_->setDispatcher(dispatcher_.get());
+
+    databaseManager_ = std::make_unique<DatabaseManager>(configManager_.get());
+    databaseManager_->enableAutoReconnect(true, kReconnectIntervalMs);
+
+    queryEngine_ = std::make_unique<QueryEngine>(databaseManager_.get(), alertSystem_.get());
+
+    QueryEngineConfig queryConfig = configManager_->getQueryConfig();
+    openTargets(queryConfig);
+    queryEngine_->setWatermarkFile(queryConfig.watermarksFilePath);
+    queryEngine_->setInterval(queryConfig.executionInterval);
+    queryEngine_->setMaxConcurrentQueries(queryConfig.maxConcurrentQueries);
+    queryEngine_->setMaxQueuedQueries(queryConfig.maxQueuedQueries);
+    queryEngine_->setBatchExecution(queryConfig.batchExecution);
+    queryEngine_->setAdaptiveMaxInterval(queryConfig.adaptiveMaxInterval);
+    queryEngine_->setAdaptiveScheduling(queryConfig.adaptiveScheduling);
+    loadQueries(queryConfig);
+
+    journalOpener->wait();
+    if (!journalError.empty()) {
+        log_ << "Warning: Alert journal disabled: " << journalError << "\n";
+    }
+    alertSystem_->setJournal(journal_.get());
+    startMetrics(alertConfig);
+
+    if (queryConfig.watchConfigFiles) {
+        watchConfigFiles(queryConfig);
+    }
+}
+
+bool MonitorRuntime::connectDatabase() {
+    if (!databaseManager_) {
+        return false;
+    }
+
+    // Targets come from their own file, so they connect even without a config.txt
+    for (const Target& target : targets_) {
+        connectTarget(target);
+    }
+
+    if (!configLoaded_ && !configManager_->validateDatabaseConfig()) {
+        log_ << "Warning: Invalid database configuration.\n";
+        return false;
+    }
+
+    if (!databaseManager_->connect()) {
+        log_ << "Warning: Could not connect to database.\n";
+        log_ << "Error: " << databaseManager_->getLastError() << "\n";
+        return false;
+    }
+
+    log_ << "Successfully connected to database.\n";
+    return true;
+}
+
+bool MonitorRuntime::connectDatabaseAsync() {
+    if (!databaseManager_) {
+        return false;
+    }
+
+    for (const Target& target : targets_) {
+        connectTargetAsync(target);
+    }
+
+    if (!configLoaded_ && !configManager_->validateDatabaseConfig()) {
+        log_ << "Warning: Invalid database configuration.\n";
+        return false;
+    }
+
+    DatabaseManager* manager = databaseManager_.get();
+    if (!manager->connectAsync()) {
+        log_ << "Warning: Could not connect to database.\n";
+        log_ << "Error: " << manager->getLastError() << "\n";
+        return false;
+    }
+
+    QObject::connect(manager, &DatabaseManager::connectFinished, manager, [this, manager](bool connected) {
+        if (connected) {
+            log_ << "Successfully connected to database.\n";
+        } else {
+            log_ << "Warning: Could not connect to database.\n";
+            log_ << "Error: " << manager->getLastError() << "\n";
+        }
+    }, Qt::SingleShotConnection);
+    return true;
+}
+
+int MonitorRuntime::connectedTargetCount() const {
+    int connected = 0;
+    for (const Target& target : targets_) {
+        if (target.manager->isConnected()) {
+            connected++;
+        }
+    }
+    return connected;
+}
+
+void MonitorRuntime::reloadTargets() {
+    if (!queryEngine_) {
+        return;
+    }
+
+    const std::string& targetsFile = configManager_->getQueryConfig().targetsFilePath;
+    QString filePath = QString::fromStdString(targetsFile);
+    bool valid = configManager_->loadDatabaseTargets(filePath);
+    std::vector<DatabaseTarget> wanted = configManager_->getDatabaseTargets();
+
+    // Nothing read from a file that is there is a failed read, not an emptied file
+    if (!valid && wanted.empty() && QFileInfo::exists(filePath)) {
+        log_ << "Warning: Database targets not reloaded from " << targetsFile << "\n";
+        return;
+    }
+    if (!valid) {
+        log_ << "Warning: Some database targets in " << targetsFile << " were skipped\n";
+    }
+
+    for (auto it = targets_.begin(); it != targets_.end();) {
+        bool kept = std::any_of(wanted.begin(), wanted.end(), [&it](const DatabaseTarget& target) {
+            return target.name == it->name;
+        });
+        if (kept) {
+            ++it;
+            continue;
+        }
+
+        // Its pool closes once running queries return; runs still queued fail to connect
+        queryEngine_->removeTarget(it->name);
+        it->manager->enableAutoReconnect(false);
+        it->manager->disconnect();
+        log_ << "Removed database target: " << it->name << "\n";
+        retiredTargets_.push_back(std::move(it->manager));
+        it = targets_.erase(it);
+    }
+
+    for (const DatabaseTarget& target : wanted) {
+        auto existing = std::find_if(targets_.begin(), targets_.end(), [&target](const Target& running) {
+            return running.name == target.name;
+        });
+
+        if (existing == targets_.end()) {
+            addTarget(target);
+            log_ << "Added database target: " << target.name << "\n";
+            connectTargetAsync(targets_.back());
+        } else if (existing->manager->applyConnectionConfig(target.config)) {
+            log_ << "Reconnecting database target with its new settings: " << target.name << "\n";
+
+            // A failed reconnect is retried by the manager's own timer
+            DatabaseManager* manager = existing->manager.get();
+            const std::string name = target.name;
+            QObject::connect(manager, &DatabaseManager::connectFinished, manager, [this, manager, name](bool connected) {
+                if (connected) {
+                    log_ << "Reconnected database target: " << name << "\n";
+                } else {
+                    log_ << "Warning: Could not reconnect database target " << name
+                         << ": " << manager->getLastError() << "\n";
+                }
+            }, Qt::SingleShotConnection);
+        }
+    }
+}
+
+void MonitorRuntime::shutdown() {
+    if (queryEngine_) {
+        queryEngine_->stopMonitoring();
+        queryEngine_->saveWatermarks();
+    }
+    if (metrics_) {
+        metrics_->stop();
+    }
+    if (dispatcher_) {
+        dispatcher_->stop(kSinkDrainTimeoutMs);
+    }
+    if (journal_) {
+        journal_->flush();
+    }
+}
+
+QString MonitorRuntime::configFilePath() const {
+    return configLoaded_ ? configFilePath_ : configManager_->getDefaultConfigPath();
+}
+
+void MonitorRuntime::printStartupInfo() const {
+    log_ << "\n=== PostgreSQL Monitor Startup ===\n";
+    log_ << "Configuration loaded from: " << configFilePath().toStdString() << "\n";
+
+    DatabaseConfig dbConfig = configManager_->getDatabaseConfig();
+    log_ << "Database: " << dbConfig.username << "@" << dbConfig.host << ":" << dbConfig.port << "/" << dbConfig.database << "\n";
+    log_ << "SSL Mode: " << dbConfig.sslMode << "\n";
+
+    if (configManager_->useEnvironmentVariables()) {
+        log_ << "Using environment variables for database connection\n";
+    }
+
+    log_ << "Database targets: " << targets_.size() << "\n";
+    for (const Target& target : targets_) {
+        DatabaseConfig config = target.manager->getConnectionConfig();
+        log_ << "  " << target.name << ": " << config.username << "@" << config.host << ":"
+             << config.port << "/" << config.database << "\n";
+    }
+
+    log_ << "Max alerts: " << configManager_->getAlertConfig().maxAlerts << "\n";
+    log_ << "Query interval: " << configManager_->getQueryConfig().executionInterval << "ms\n";
+    log_ << "Alert journal: " << (journal_ ? "enabled" : "disabled") << "\n";
+    if (dispatcher_) {
+        log_ << "Alert sinks:";
+        for (const AlertSinkStats& sink : dispatcher_->getStats()) {
+            log_ << " " << sink.name;
+        }
+        log_ << "\n";
+    }
+    if (metrics_) {
+        log_ << "Metrics endpoint: port " << metrics_->port() << "\n";
+    }
+    log_ << "================================\n\n";
+}
+
+bool MonitorRuntime::openJournal(const AlertConfig& config, std::string& error) {
+    if (!config.journalEnabled) {
+        return false;
+    }
+
+    AlertJournalOptions options;
+    options.directory = config.journalDirectory.toStdString();
+    options.segmentBytes = static_cast<int64_t>(config.journalSegmentSizeMb) * 1024 * 1024;
+    options.maxSegments = config.journalMaxSegments;
+    options.retentionDays = config.journalRetentionDays;
+    options.syncIntervalMs = config.journalSyncIntervalMs;
+
+    journal_ = std::make_unique<AlertJournal>(options);
+    if (!journal_->open()) {
+        error = journal_->getLastError();
+        journal_.reset();
+        return false;
+    }
+    return true;
+}
+
+void MonitorRuntime::openSinks(const AlertConfig& config) {
+    AlertSinkOptions options;
+    options.queueCapacity = static_cast<size_t>(std::max(1, config.sinkQueueSize));
+    options.batchSize = static_cast<size_t>(std::max(1, config.sinkBatchSize));
+    options.batchDelayMs = config.sinkBatchDelayMs;
+    options.retryMaxMs = config.sinkRetryMaxMs;
+    options.maxAttempts = config.sinkMaxAttempts;
+
+    auto dispatcher = std::make_unique<AlertDispatcher>();
+    if (!config.webhookUrl.isEmpty()) {
+        dispatcher->addSink(std::make_unique<WebhookSink>(config.webhookUrl, config.webhookTimeoutMs), options);
+    }
+    if (!config.syslogHost.isEmpty()) {
+        dispatcher->addSink(std::make_unique<SyslogSink>(config.syslogHost, config.syslogPort,
+                                                         config.syslogFacility), options);
+    }
+    if (dispatcher->sinkCount() == 0) {
+        return;
+    }
+
+    dispatcher->start();
+    dispatcher_ = std::move(dispatcher);
+}
+
+void MonitorRuntime::startMetrics(const AlertConfig& config) {
+    if (config.metricsPort <= 0) {
+        return;
+    }
+
+    // Renders on the endpoint's thread; shutdown() stops it before the engine goes
+    metrics_ = std::make_unique<MetricsEndpoint>([this]() {
+        return MetricsEndpoint::renderMetrics(queryEngine_.get(), alertSystem_.get(), dispatcher_.get());
+    });
+
+    std::string error;
+    if (!metrics_->start(config.metricsAddress, config.metricsPort, error)) {
+        log_ << "Warning: Metrics endpoint disabled: " << error << "\n";
+        metrics_.reset();
+    }
+}
+
+void MonitorRuntime::openTargets(const QueryEngineConfig& config) {
+    QString targetsFile = QString::fromStdString(config.targetsFilePath);
+    if (!configManager_->loadDatabaseTargets(targetsFile)) {
+        log_ << "Warning: Some database targets in " << config.targetsFilePath << " were skipped\n";
+    }
+
+    for (const DatabaseTarget& target : configManager_->getDatabaseTargets()) {
+        addTarget(target);
+    }
+}
+
+void MonitorRuntime::addTarget(const DatabaseTarget& target) {
+    // Each target has its own connection pool; the engine's workers are shared
+    auto manager = std::make_unique<DatabaseManager>(nullptr);
+    manager->setConnectionConfig(target.config);
+    manager->enableAutoReconnect(true, kReconnectIntervalMs);
+    queryEngine_->addTarget(target.name, manager.get());
+    targets_.push_back(Target{target.name, std::move(manager)});
+}
+
+bool MonitorRuntime::connectTarget(const Target& target) {
+    if (target.manager->connect()) {
+        log_ << "Connected to database target: " << target.name << "\n";
+        return true;
+    }
+
+    log_ << "Warning: Could not connect to database target " << target.name
+         << ": " << target.manager->getLastError() << "\n";
+    QTimer::singleShot(kReconnectIntervalMs, target.manager.get(), &DatabaseManager::attemptReconnect);
+    return false;
+}
+
+void MonitorRuntime::connectTargetAsync(const Target& target) {
+    DatabaseManager* manager = target.manager.get();
+    const std::string name = target.name;
+    if (!manager->connectAsync()) {
+        log_ << "Warning: Could not connect to database target " << name
+             << ": " << manager->getLastError() << "\n";
+        return;
+    }
+
+    QObject::connect(manager, &DatabaseManager::connectFinished, manager, [this, manager, name](bool connected) {
+        if (connected) {
+            log_ << "Connected to database target: " << name << "\n";
+            return;
+        }
+
+        log_ << "Warning: Could not connect to database target " << name
+             << ": " << manager->getLastError() << "\n";
+        QTimer::singleShot(kReconnectIntervalMs, manager, &DatabaseManager::attemptReconnect);
+    }, Qt::SingleShotConnection);
+}
+
+void MonitorRuntime::loadQueries(const QueryEngineConfig& config) {
+    const std::string& queriesFile = config.queriesFilePath;
+    if (!QFileInfo::exists(QString::fromStdString(queriesFile))) {
+        log_ << "Queries file not found: " << queriesFile << "\n";
+        log_ << "Loading default queries...\n";
+        loadDefaultQueries(queryEngine_.get());
+        return;
+    }
+
+    if (queryEngine_->loadQueriesFromFile(queriesFile)) {
+        log_ << "Loaded queries from: " << queriesFile << "\n";
+    } else {
+        log_ << "Warning: Failed to load queries from " << queriesFile << "\n";
+        loadDefaultQueries(queryEngine_.get());
+    }
+}
+
+void MonitorRuntime::watchConfigFiles(const QueryEngineConfig& config) {
+    // Both files are watched even when missing, so creating one is picked up too
+    configWatcher_ = std::make_unique<ConfigWatcher>();
+    const QString queriesFile = QString::fromStdString(config.queriesFilePath);
+    const QString targetsFile = QString::fromStdString(config.targetsFilePath);
+    configWatcher_->watch(queriesFile);
+    configWatcher_->watch(targetsFile);
+
+    // The engine parses on a thread of its own and swaps in only what changed
+    const QString queriesPath = QFileInfo(queriesFile).absoluteFilePath();
+    const QString targetsPath = QFileInfo(targetsFile).absoluteFilePath();
+    QObject::connect(configWatcher_.get(), &ConfigWatcher::fileChanged, configWatcher_.get(),
+                     [this, queriesPath, targetsPath](const QString& filePath) {
+        if (filePath == queriesPath) {
+            log_ << "Queries file changed, reloading: " << filePath.toStdString() << "\n";
+            queryEngine_->reloadQueriesFromFile(filePath.toStdString());
+        } else if (filePath == targetsPath) {
+            log_ << "Database targets file changed, reloading: " << filePath.toStdString() << "\n";
+            reloadTargets();
+        }
+    });
+}
+
+bool MonitorRuntime::loadDefaultQueries(QueryEngine* queryEngine) {
+    const std::string defaultQueries = R"(
+[SecurityBreach]
+name=Security Breach Detection
+sql=SELECT 'BREACH DETECTED' as alert_message, severity FROM security_events WHERE created_at > NOW() - INTERVAL '1 second'
+alert_type=critical
+
+[FailedLogins]
+name=Failed Login Count
+sql=SELECT CONCAT('Failed login attempts: ', COUNT(*)) as alert_message FROM login_attempts WHERE success=false AND timestamp > NOW() - INTERVAL '1 second'
+alert_type=warning
+threshold=3
+
+[HighCPU]
+name=High CPU Usage
+sql=SELECT CASE WHEN AVG(cpu_usage) > 80 THEN CONCAT('High CPU usage detected: ', ROUND(AVG(cpu_usage), 2), '%') ELSE 'Normal CPU usage' END as alert_message FROM system_metrics WHERE timestamp > NOW() - INTERVAL '1 second' AND metric_type='cpu'
+alert_type=warning
+threshold=1
+
+[Source:Activity]
+name=Session Activity Snapshot
+sql=SELECT pid, state, client_addr FROM pg_stat_activity WHERE pid <> pg_backend_pid()
+
+[DatabaseConnections]
+name=Database Connection Count
+source=Activity
+where=state = 'active'
+aggregate=count
+alert_type=info
+threshold=10
+
+[NewUsers]
+name=New User Registrations
+sql=SELECT CONCAT('New user registered: ', username) as alert_message FROM user_logins WHERE login_time > NOW() - INTERVAL '1 second' AND is_new_user = true
+alert_type=info
+)";
+
+    return queryEngine->loadQueriesFromString(defaultQueries);
+}
@@ -0,0 +1,189 @@
+#include "NotificationListener.h"
+#include <QDebug>
+#include <pqxx/pqxx>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace {
+// How long one wait on the socket may block before stop and channel changes are checked
+const long kWaitSliceMicros = 250 * 1000;
+const int kInitialRetryMs = 1000;
+const int kMaxRetryMs = 30000;
+
+// Forwards one channel's notifications; pqxx issues LISTEN/UNLISTEN as receivers come and go
+class ChannelReceiver : public pqxx::notification_receiver {
+public:
+    using Handler = std::function<void(const std::string&, const std::string&, int)>;
+
+    ChannelReceiver(pqxx::connection& connection, const std::string& channel, Handler handler)
+        : pqxx::notification_receiver(connection, channel)
+        , handler_(std::move(handler))
+    {
+    }
+
+    void operator()(const std::string& payload, int backendPid) override {
+        handler_(channel(), payload, backendPid);
+    }
+
+private:
+    Handler handler_;
+};
+}
+
+NotificationListener::NotificationListener(const std::string& connectionString, QObject *parent)
+    : QObject(parent)
+    , connectionString_(connectionString)
+    , thread_(nullptr)
+    , stopping_(false)
+    , connected_(false)
+    , received_(0)
+    , channelsChanged_(false)
+{
+}
+
+NotificationListener::~NotificationListener() {
+    stop();
+}
+
+void NotificationListener::setChannels(const std::set<std::string>& channels) {
+    QMutexLocker locker(&mutex_);
+    if (channels != channels_) {
+        channels_ = channels;
+        channelsChanged_ = true;
+    }
+}
+
+std::set<std::string> NotificationListener::getChannels() const {
+    QMutexLocker locker(&mutex_);
+    return channels_;
+}
+
+void NotificationListener::start() {
+    if (isRunning()) {
+        return;
+    }
+    stop();
+
+    stopping_ = false;
+    {
+        QMutexLocker locker(&mutex_);
+        channelsChanged_ = true;
+    }
+
+    thread_ = QThread::create([this]() { run(); });
+    thread_->setObjectName("NotificationListener");
+    thread_->start();
+}
+
+void NotificationListener::stop() {
+    if (!thread_) {
+        return;
+    }
+
+    stopping_ = true;
+    thread_->wait();
+    delete thread_;
+    thread_ = nullptr;
+}
+
+bool NotificationListener::isRunning() const {
+    return thread_ && thread_->isRunning();
+}
+
+bool NotificationListener::isConnected() const {
+    return connected_;
+}
+
+int64_t NotificationListener::getReceivedCount() const {
+    return received_;
+}
+
+std::string NotificationListener::getLastError() const {
+    QMutexLocker locker(&mutex_);
+    return lastError_;
+}
+
+void NotificationListener::run() {
+    auto deliver = [this](const std::string& channel, const std::string& payload, int backendPid) {
+        received_++;
+        emit notificationReceived(channel, payload, backendPid);
+    };
+
+    std::unique_ptr<pqxx::connection> connection;
+    std::map<std::string, std::unique_ptr<ChannelReceiver>> receivers;
+    int retryDelayMs = kInitialRetryMs;
+
+    while (!stopping_) {
+        try {
+            if (!connection) {
+                connection = std::make_unique<pqxx::connection>(connectionString_);
+                QMutexLocker locker(&mutex_);
+                channelsChanged_ = true;
+            }
+
+            std::set<std::string> wanted;
+            bool changed;
+            {
+                QMutexLocker locker(&mutex_);
+                changed = channelsChanged_;
+                channelsChanged_ = false;
+                wanted = channels_;
+            }
+
+            if (changed) {
+                for (auto it = receivers.begin(); it != receivers.end();) {
+                    it = wanted.count(it->first) ? std::next(it) : receivers.erase(it);
+                }
+                for (const auto& channel : wanted) {
+                    if (!receivers.count(channel)) {
+                        receivers[channel] = std::make_unique<ChannelReceiver>(*connection, channel, deliver);
+                    }
+                }
+                qDebug() << "Listening on" << receivers.size() << "notification channels";
+            }
+
+            if (!connected_) {
+                setConnected(true);
+                retryDelayMs = kInitialRetryMs;
+            }
+
+            // Blocks in the socket until a notification arrives or the slice ends
+            connection->await_notification(0, kWaitSliceMicros);
+
+        } catch (const std::exception& e) {
+            // Receivers unregister from their connection, so they go first
+            receivers.clear();
+            connection.reset();
+            setError(e.what());
+            setConnected(false);
+
+            qWarning() << "Notification listener failed, retrying in" << retryDelayMs << "ms:" << e.what();
+            sleepUnlessStopping(retryDelayMs);
+            retryDelayMs = std::min(retryDelayMs * 2, kMaxRetryMs);
+        }
+    }
+
+    receivers.clear();
+    connection.reset();
+    setConnected(false);
+}
+
+void NotificationListener::setConnected(bool connected) {
+    if (connected_.exchange(connected) != connected) {
+        emit connectionStatusChanged(connected);
+    }
+}
+
+void NotificationListener::setError(const std::string& error) {
+    QMutexLocker locker(&mutex_);
+    lastError_ = error;
+}
+
+void NotificationListener::sleepUnlessStopping(int milliseconds) {
+    const int sliceMs = static_cast<int>(kWaitSliceMicros / 1000);
+    for (int slept = 0; slept < milliseconds && !stopping_; slept += sliceMs) {
+        QThread::msleep(static_cast<unsigned long>(std::min(sliceMs, milliseconds - slept)));
+    }
+}
@@ -1,34 +1,100 @@
 #include "QueryEngine.h"
-#include <QApplication>
+#include "NotificationListener.h"
 #include <QDebug>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
-#include <openssl/md5.h>  // For hash calculation
+#include <cctype>
+#include <limits>
+
+const char* const QueryEngine::DEFAULT_TARGET = "default";
+
+namespace {
+// Watermarks reach the disk at most this long after a run advances them
+const int kWatermarkSaveIntervalMs = 1000;
+
+// Alert levels as written in queries.conf: 10, not 10.000000
+std::string trimNumber(double value) {
+    std::ostringstream out;
+    out << std::setprecision(15) << value;
+    return out.str();
+}
+
+// What a reload compares to decide how much of a changed query to redo
+bool sameStatement(const QueryConfig& a, const QueryConfig& b) {
+    return a.sql == b.sql && a.aggregate == b.aggregate && a.target == b.target &&
+           a.channel == b.channel && a.source == b.source && a.snapshot == b.snapshot;
+}
+
+bool sameSchedule(const QueryConfig& a, const QueryConfig& b) {
+    return a.enabled == b.enabled && a.intervalMs == b.intervalMs && a.jitterMs == b.jitterMs &&
+           a.phaseMs == b.phaseMs && a.adaptive == b.adaptive && a.minIntervalMs == b.minIntervalMs &&
+           a.maxIntervalMs == b.maxIntervalMs;
+}
+
+bool sameQuery(const QueryConfig& a, const QueryConfig& b) {
+    return sameStatement(a, b) && sameSchedule(a, b) && a.name == b.name && a.alertType == b.alertType &&
+           a.threshold == b.threshold && a.timeoutSeconds == b.timeoutSeconds &&
+           a.cursorColumn == b.cursorColumn && a.cursorStart == b.cursorStart &&
+           a.warningLevel == b.warningLevel && a.criticalLevel == b.criticalLevel &&
+           a.filter == b.filter && a.message == b.message;
+}
+}
 
 QueryEngine::QueryEngine(DatabaseManager* dbManager, AlertSystem* alertSystem, QObject *parent)
     : QObject(parent)
     , databaseManager_(dbManager)
     , alertSystem_(alertSystem)
+    , strings_(std::make_shared<StringInterner>())
+    , queries_(std::make_shared<const QueryTable>())
+    , watermarks_(std::make_unique<WatermarkStore>())
+    , watermarkTimer_(new QTimer(this))
     , timer_(new QTimer(this))
     , isMonitoring_(false)
     , interval_(1000)  // 1 second default
     , maxConcurrentQueries_(5)
+    , maxQueuedQueries_(100)
+    , batchExecution_(false)
+    , adaptiveScheduling_(false)
+    , adaptiveMaxInterval_(60000)
+    , workerPool_(new QueryWorkerPool(this))
+    , reloadThread_(nullptr)
     , totalExecutions_(0)
     , totalFailures_(0)
+    , droppedExecutions_(0)
+    , skippedExecutions_(0)
+    , tickOverruns_(0)
+    , notificationsReceived_(0)
     , totalExecutionTime_(0)
 {
+    // The timer is re-armed for whichever query is due next
+    timer_->setSingleShot(true);
+    timer_->setTimerType(Qt::PreciseTimer);
     connect(timer_, &QTimer::timeout, this, &QueryEngine::onTimerTimeout);
+    connect(workerPool_, &QueryWorkerPool::completed, this, &QueryEngine::onQueryCompleted);
+    workerPool_->setMaxQueueSize(maxQueuedQueries_);
+
+    watermarkTimer_->setInterval(kWatermarkSaveIntervalMs);
+    connect(watermarkTimer_, &QTimer::timeout, this, &QueryEngine::onWatermarkTimer);
+
+    // Alerts from this engine carry handles into our table
+    if (alertSystem_) {
+        alertSystem_->setStringTable(strings_);
+    }
 
     if (databaseManager_) {
+        targets_[DEFAULT_TARGET] = databaseManager_;
         connect(databaseManager_, &DatabaseManager::connectionStatusChanged,
                 this, &QueryEngine::onDatabaseConnectionChanged);
     }
 }
 
 QueryEngine::~QueryEngine() {
+    waitForReload();
     stopMonitoring();
+    workerPool_->stop();
+    saveWatermarks();
 }
 
 bool QueryEngine::loadQueriesFromFile(const std::string& filePath) {
@@ -45,77 +111,316 @@ bool QueryEngine::loadQueriesFromFile(const std::string& filePath) {
 }
 
 bool QueryEngine::loadQueriesFromString(const std::string& configData) {
+    // Parsed before taking the lock, so running queries only wait for the swap
+    std::map<std::string, QueryConfig> parsed;
+    bool loaded = parseConfigFile(configData, parsed);
+
     QMutexLocker locker(&queriesMutex_);
-    queries_.clear();
+    applyQueries(std::move(parsed));
+    return loaded;
+}
 
-    return parseConfigFile(configData);
+void QueryEngine::reloadQueriesFromFile(const std::string& filePath) {
+    // One parse at a time; edits arriving meanwhile collapse into one more
+    if (reloadThread_) {
+        pendingReload_ = filePath;
+        return;
+    }
+
+    reloadThread_ = QThread::create([this, filePath]() {
+        auto parsed = std::make_shared<std::map<std::string, QueryConfig>>();
+        std::string error;
+
+        std::ifstream file(filePath);
+        if (!file.is_open()) {
+            error = "cannot open " + filePath;
+        } else {
+            std::string content((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+            if (!parseConfigFile(content, *parsed)) {
+                error = filePath + " has no queries";
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, parsed, error]() {
+            finishReload(std::move(*parsed), error);
+        }, Qt::QueuedConnection);
+    });
+    reloadThread_->setObjectName("QueryReload");
+    reloadThread_->start();
+}
+
+void QueryEngine::finishReload(std::map<std::string, QueryConfig> queries, const std::string& error) {
+    waitForReload();
+
+    // A half-written or emptied file is more likely a save in progress than the intent
+    if (!error.empty()) {
+        qWarning() << "Queries not reloaded:" << error.c_str();
+    } else {
+        QueryTableChanges changes;
+        {
+            QMutexLocker locker(&queriesMutex_);
+            changes = applyQueries(std::move(queries));
+        }
+        qInfo() << "Reloaded queries:" << changes.added << "added," << changes.changed << "changed,"
+                << changes.removed << "removed";
+        emit queriesReloaded(changes.added, changes.changed, changes.removed);
+    }
+
+    if (!pendingReload_.empty()) {
+        std::string filePath;
+        filePath.swap(pendingReload_);
+        reloadQueriesFromFile(filePath);
+    }
+}
+
+void QueryEngine::waitForReload() {
+    if (reloadThread_) {
+        reloadThread_->wait();
+        delete reloadThread_;
+        reloadThread_ = nullptr;
+    }
 }
 
 void QueryEngine::addQuery(const QueryConfig& query) {
+    QueryConfig added = query;
+    std::string error;
+    if (!compileRule(added, error)) {
+        qWarning() << "Query" << query.id.c_str() << "not added:" << error.c_str();
+        return;
+    }
+
     QMutexLocker locker(&queriesMutex_);
-    queries_[query.id] = query;
+    QueryTable::Entry entry = entryOf(added);
+    publishQueries(queries_->with(entry));
+    registerStatement(*entry);
+
+    if (isMonitoring_ && added.enabled) {
+        scheduleQuery(*entry, QueryScheduler::Clock::now());
+        armTimer();
+        syncListeners();
+    }
 
     qDebug() << "Added query:" << query.id.c_str() << query.name.c_str();
 }
 
 void QueryEngine::removeQuery(const std::string& queryId) {
     QMutexLocker locker(&queriesMutex_);
-    queries_.erase(queryId);
+    publishQueries(queries_->without(queryId));
+    unregisterStatement(queryId);
+
+    if (isMonitoring_) {
+        unscheduleQuery(queryId);
+        armTimer();
+        syncListeners();
+    }
 
     qDebug() << "Removed query:" << queryId.c_str();
 }
 
 void QueryEngine::updateQuery(const QueryConfig& query) {
+    QueryConfig updated = query;
+    std::string error;
+    if (!compileRule(updated, error)) {
+        qWarning() << "Query" << query.id.c_str() << "not updated:" << error.c_str();
+        return;
+    }
+
     QMutexLocker locker(&queriesMutex_);
-    queries_[query.id] = query;
+
+    // The target list may have changed, so drop the old statements and runs first
+    unregisterStatement(query.id);
+    if (isMonitoring_) {
+        unscheduleQuery(query.id);
+    }
+    QueryTable::Entry entry = entryOf(updated);
+    publishQueries(queries_->with(entry));
+
+    // Pooled connections re-prepare on next use once the SQL differs
+    registerStatement(*entry);
+
+    if (isMonitoring_) {
+        if (entry->enabled) {
+            scheduleQuery(*entry, QueryScheduler::Clock::now());
+        }
+        armTimer();
+        syncListeners();
+    }
 }
 
 void QueryEngine::enableQuery(const std::string& queryId, bool enabled) {
     QMutexLocker locker(&queriesMutex_);
-    auto it = queries_.find(queryId);
-    if (it != queries_.end()) {
-        it->second.enabled = enabled;
+    const QueryConfig* current = queries_->find(queryId);
+    if (!current || current->enabled == enabled) {
+        return;
+    }
+
+    QueryConfig changed = *current;
+    changed.enabled = enabled;
+    QueryTable::Entry entry = entryOf(std::move(changed));
+    publishQueries(queries_->with(entry));
+
+    if (isMonitoring_) {
+        if (enabled) {
+            scheduleQuery(*entry, QueryScheduler::Clock::now());
+        } else {
+            unscheduleQuery(queryId);
+        }
+        armTimer();
+        syncListeners();
     }
 }
 
-QueryConfig* QueryEngine::getQuery(const std::string& queryId) {
-    QMutexLocker locker(&queriesMutex_);
-    auto it = queries_.find(queryId);
-    return (it != queries_.end()) ? &(it->second) : nullptr;
+std::shared_ptr<const QueryConfig> QueryEngine::getQuery(const std::string& queryId) const {
+    return getQueryTable()->entry(queryId);
 }
 
 std::vector<QueryConfig> QueryEngine::getAllQueries() const {
-    QMutexLocker locker(&queriesMutex_);
+    std::shared_ptr<const QueryTable> queries = getQueryTable();
     std::vector<QueryConfig> result;
-    for (const auto& pair : queries_) {
-        result.push_back(pair.second);
+    result.reserve(queries->size());
+    for (const auto& query : *queries) {
+        result.push_back(*query);
     }
     return result;
 }
 
+std::shared_ptr<const QueryTable> QueryEngine::getQueryTable() const {
+    return std::atomic_load(&queries_);
+}
+
+QueryTable::Entry QueryEngine::entryOf(QueryConfig query) const {
+    query.handle = strings_->intern(query.id);
+    return std::make_shared<const QueryConfig>(std::move(query));
+}
+
+void QueryEngine::publishQueries(std::shared_ptr<const QueryTable> queries) {
+    // Readers holding the old table keep it, and its queries, until they let go
+    std::atomic_store(&queries_, std::move(queries));
+}
+
+void QueryEngine::addTarget(const std::string& name, DatabaseManager* dbManager) {
+    if (name.empty() || name == DEFAULT_TARGET || name == "*" ||
+        name.find_first_of("@,") != std::string::npos || !dbManager) {
+        qWarning() << "Invalid database target name:" << name.c_str();
+        return;
+    }
+
+    QMutexLocker locker(&queriesMutex_);
+    if (targets_.count(name)) {
+        qWarning() << "Database target already exists:" << name.c_str();
+        return;
+    }
+    targets_[name] = dbManager;
+
+    // Queries loaded before the target existed may already name it
+    auto now = QueryScheduler::Clock::now();
+    for (const auto& query : *queries_) {
+        std::vector<std::string> targets = targetsOf(*query);
+        if (std::find(targets.begin(), targets.end(), name) == targets.end()) {
+            continue;
+        }
+        if (query->isListener() || query->isRule()) {
+            continue;
+        }
+        std::string sql;
+        std::string error;
+        if (statementSql(*query, sql, error)) {
+            dbManager->registerStatement(query->id, sql);
+        }
+        if (isMonitoring_ && query->enabled) {
+            scheduleRun(*query, name, now);
+        }
+    }
+    armTimer();
+    if (isMonitoring_) {
+        syncListeners();
+    }
+
+    qDebug() << "Added database target:" << name.c_str();
+}
+
+void QueryEngine::removeTarget(const std::string& name) {
+    if (name == DEFAULT_TARGET) {
+        qWarning() << "The default database target cannot be removed";
+        return;
+    }
+
+    QMutexLocker locker(&queriesMutex_);
+    auto it = targets_.find(name);
+    if (it == targets_.end()) {
+        return;
+    }
+
+    for (const auto& query : *queries_) {
+        std::vector<std::string> targets = targetsOf(*query);
+        if (std::find(targets.begin(), targets.end(), name) != targets.end()) {
+            it->second->unregisterStatement(query->id);
+            scheduler_.unschedule(runKey(query->id, name));
+        }
+    }
+    targets_.erase(it);
+    armTimer();
+
+    auto listener = listeners_.find(name);
+    if (listener != listeners_.end()) {
+        delete listener->second;
+        listeners_.erase(listener);
+    }
+
+    qDebug() << "Removed database target:" << name.c_str();
+}
+
+DatabaseManager* QueryEngine::getTarget(const std::string& name) const {
+    QMutexLocker locker(&queriesMutex_);
+    auto it = targets_.find(name.empty() ? DEFAULT_TARGET : name);
+    return it != targets_.end() ? it->second : nullptr;
+}
+
+std::vector<std::string> QueryEngine::getTargetNames() const {
+    QMutexLocker locker(&queriesMutex_);
+    std::vector<std::string> names;
+    for (const auto& pair : targets_) {
+        names.push_back(pair.first);
+    }
+    return names;
+}
+
+std::string QueryEngine::runKey(const std::string& queryId, const std::string& target) {
+    if (target.empty() || target == DEFAULT_TARGET) {
+        return queryId;
+    }
+    return queryId + "@" + target;
+}
+
 void QueryEngine::startMonitoring() {
     if (isMonitoring_) {
         qWarning() << "Monitoring is already started";
         return;
     }
 
-    if (!databaseManager_ || !databaseManager_->isConnected()) {
+    QMutexLocker locker(&queriesMutex_);
+    if (!anyTargetConnected()) {
         qWarning() << "Cannot start monitoring: database not connected";
+        locker.unlock();
         emit queryError("", "Database not connected");
         return;
     }
 
-    QMutexLocker locker(&queriesMutex_);
-    if (queries_.empty()) {
+    if (queries_->empty()) {
         qWarning() << "Cannot start monitoring: no queries configured";
         emit queryError("", "No queries configured");
         return;
     }
 
     isMonitoring_ = true;
-    timer_->start(interval_);
+    workerPool_->start(maxConcurrentQueries_);
+    rescheduleAll();
+    syncListeners();
+    watermarkTimer_->start();
 
-    qDebug() << "Started monitoring with" << queries_.size() << "queries, interval" << interval_ << "ms";
+    qDebug() << "Started monitoring with" << scheduler_.size() << "scheduled queries, default interval"
+             << interval_ << "ms," << maxConcurrentQueries_ << "workers";
     emit monitoringStarted();
 }
 
@@ -126,6 +431,17 @@ void QueryEngine::stopMonitoring() {
 
     isMonitoring_ = false;
     timer_->stop();
+    {
+        QMutexLocker locker(&queriesMutex_);
+        scheduler_.clear();
+        stopListeners();
+    }
+    workerPool_->stop();
+    clearInFlight();
+
+    // Runs that finished before the pool stopped have already advanced theirs
+    watermarkTimer_->stop();
+    saveWatermarks();
 
     qDebug() << "Stopped monitoring";
     emit monitoringStopped();
@@ -137,8 +453,17 @@ bool QueryEngine::isMonitoring() const {
 
 void QueryEngine::setInterval(int milliseconds) {
     interval_ = milliseconds;
-    if (timer_->isActive()) {
-        timer_->setInterval(interval_);
+
+    // Queries without their own interval follow the engine default
+    if (isMonitoring_) {
+        QMutexLocker locker(&queriesMutex_);
+        auto now = QueryScheduler::Clock::now();
+        for (const auto& query : *queries_) {
+            if (query->enabled && query->intervalMs <= 0) {
+                scheduleQuery(*query, now);
+            }
+        }
+        armTimer();
     }
 }
 
@@ -147,13 +472,110 @@ int QueryEngine::getInterval() const {
 }
 
 void QueryEngine::setMaxConcurrentQueries(int maxQueries) {
-    maxConcurrentQueries_ = maxQueries;
+    maxConcurrentQueries_ = std::max(1, maxQueries);
+
+    // Resize a running pool by restarting it with the new worker count
+    if (workerPool_->isRunning() && workerPool_->getWorkerCount() != maxConcurrentQueries_) {
+        workerPool_->stop();
+        clearInFlight();
+        workerPool_->start(maxConcurrentQueries_);
+    }
 }
 
 int QueryEngine::getMaxConcurrentQueries() const {
     return maxConcurrentQueries_;
 }
 
+void QueryEngine::setMaxQueuedQueries(int maxQueued) {
+    maxQueuedQueries_ = std::max(1, maxQueued);
+    workerPool_->setMaxQueueSize(maxQueuedQueries_);
+}
+
+int QueryEngine::getMaxQueuedQueries() const {
+    return maxQueuedQueries_;
+}
+
+void QueryEngine::setBatchExecution(bool enabled) {
+    batchExecution_ = enabled;
+}
+
+bool QueryEngine::isBatchExecutionEnabled() const {
+    return batchExecution_;
+}
+
+void QueryEngine::setAdaptiveScheduling(bool enabled) {
+    QMutexLocker locker(&queriesMutex_);
+    if (adaptiveScheduling_ == enabled) {
+        return;
+    }
+    adaptiveScheduling_ = enabled;
+
+    // Backed-off intervals start over from the configured ones
+    if (isMonitoring_) {
+        rescheduleAll();
+    }
+}
+
+bool QueryEngine::isAdaptiveSchedulingEnabled() const {
+    return adaptiveScheduling_;
+}
+
+void QueryEngine::setAdaptiveMaxInterval(int milliseconds) {
+    QMutexLocker locker(&queriesMutex_);
+    adaptiveMaxInterval_ = std::max(1, milliseconds);
+}
+
+int QueryEngine::getAdaptiveMaxInterval() const {
+    return adaptiveMaxInterval_;
+}
+
+int QueryEngine::getCurrentInterval(const std::string& runKey) const {
+    QMutexLocker locker(&queriesMutex_);
+    return static_cast<int>(scheduler_.getInterval(runKey).count());
+}
+
+bool QueryEngine::setWatermarkFile(const std::string& filePath) {
+    saveWatermarks();
+
+    auto store = std::make_unique<WatermarkStore>(filePath);
+    bool loaded = store->load();
+    if (!store->getLastError().empty()) {
+        qWarning() << "Watermarks:" << store->getLastError().c_str();
+    }
+    qDebug() << "Loaded" << store->size() << "query watermarks from" << filePath.c_str();
+
+    watermarks_ = std::move(store);
+    return loaded;
+}
+
+bool QueryEngine::saveWatermarks() {
+    if (watermarks_->save()) {
+        return true;
+    }
+    qWarning() << "Failed to save query watermarks:" << watermarks_->getLastError().c_str();
+    return false;
+}
+
+std::optional<std::string> QueryEngine::getWatermark(const std::string& runKey) const {
+    std::string queryId;
+    std::string target;
+    QMutexLocker locker(&queriesMutex_);
+    if (!splitRunKey(runKey, queryId, target)) {
+        return std::nullopt;
+    }
+
+    const QueryConfig* query = queries_->find(queryId);
+    if (!query || !query->hasCursor()) {
+        return std::nullopt;
+    }
+    return watermarks_->get(runKey, query->cursorColumn);
+}
+
+void QueryEngine::resetWatermark(const std::string& runKey) {
+    // The next run starts again from cursor_start
+    watermarks_->remove(runKey);
+}
+
 int QueryEngine::getExecutedQueriesCount() const {
     QMutexLocker locker(&statsMutex_);
     return totalExecutions_;
@@ -164,6 +586,48 @@ int QueryEngine::getFailedQueriesCount() const {
     return totalFailures_;
 }
 
+int QueryEngine::getDroppedQueriesCount() const {
+    QMutexLocker locker(&statsMutex_);
+    return droppedExecutions_;
+}
+
+int QueryEngine::getSkippedQueriesCount() const {
+    QMutexLocker locker(&statsMutex_);
+    return skippedExecutions_;
+}
+
+int QueryEngine::getCancelledQueriesCount() const {
+    QMutexLocker locker(&queriesMutex_);
+    int cancelled = 0;
+    for (const auto& pair : targets_) {
+        cancelled += pair.second->getCancelledQueryCount();
+    }
+    return cancelled;
+}
+
+int QueryEngine::getTickOverrunCount() const {
+    QMutexLocker locker(&statsMutex_);
+    return tickOverruns_;
+}
+
+int QueryEngine::getMissedRunCount() const {
+    QMutexLocker locker(&queriesMutex_);
+    return scheduler_.getMissedRunCount();
+}
+
+int QueryEngine::getQueueDepth() const {
+    return workerPool_->getQueueDepth();
+}
+
+int QueryEngine::getActiveWorkerCount() const {
+    return workerPool_->getActiveCount();
+}
+
+int QueryEngine::getNotificationCount() const {
+    QMutexLocker locker(&statsMutex_);
+    return notificationsReceived_;
+}
+
 QDateTime QueryEngine::getLastExecutionTime() const {
     QMutexLocker locker(&statsMutex_);
     return lastExecutionTime_;
@@ -182,62 +646,284 @@ std::map<std::string, int> QueryEngine::getQueryExecutionCounts() const {
     return queryExecutionCounts_;
 }
 
-void QueryEngine::executeAllQueries() {
-    if (!databaseManager_ || !databaseManager_->isConnected()) {
-        qWarning() << "Cannot execute queries: database not connected";
-        return;
+std::map<std::string, QueryLatencyStats> QueryEngine::getQueryLatencies() const {
+    QMutexLocker locker(&statsMutex_);
+    std::map<std::string, QueryLatencyStats> stats;
+    for (const auto& pair : latencies_) {
+        QueryLatencyStats& entry = stats[pair.first];
+        entry.connectionWait = pair.second->connectionWait.summary();
+        entry.execution = pair.second->execution.summary();
+        entry.processing = pair.second->processing.summary();
+    }
+    return stats;
+}
+
+LatencySummary QueryEngine::getOverallLatency() const {
+    QMutexLocker locker(&statsMutex_);
+    LatencySnapshot overall;
+    for (const auto& pair : latencies_) {
+        overall.add(pair.second->execution.snapshot());
+    }
+    return overall.summary();
+}
+
+LatencySummary QueryEngine::getSchedulerLag() const {
+    return schedulerLag_.summary();
+}
+
+LatencySummary QueryEngine::getQueueWait() const {
+    return workerPool_->getQueueWait();
+}
+
+int QueryEngine::getMaxQueueDepth() const {
+    return workerPool_->getMaxQueueDepth();
+}
+
+void QueryEngine::resetLatencyStatistics() {
+    {
+        QMutexLocker locker(&statsMutex_);
+        for (auto& pair : latencies_) {
+            pair.second->connectionWait.reset();
+            pair.second->execution.reset();
+            pair.second->processing.reset();
+        }
     }
+    schedulerLag_.reset();
+    workerPool_->resetStatistics();
+}
 
-    std::vector<QueryConfig> enabledQueries;
+void QueryEngine::executeAllQueries() {
+    std::vector<QueryRun> runs;
     {
         QMutexLocker locker(&queriesMutex_);
-        for (const auto& pair : queries_) {
-            if (pair.second.enabled) {
-                enabledQueries.push_back(pair.second);
+        if (!anyTargetConnected()) {
+            qWarning() << "Cannot execute queries: database not connected";
+            return;
+        }
+
+        for (const auto& query : *queries_) {
+            if (query->enabled && !query->isListener() && !query->isRule()) {
+                std::vector<QueryRun> queryRuns = runsOf(*query);
+                runs.insert(runs.end(), queryRuns.begin(), queryRuns.end());
             }
         }
     }
 
-    if (enabledQueries.empty()) {
+    submitRuns(runs);
+}
+
+std::vector<QueryEngine::QueryRun> QueryEngine::runsOf(const QueryConfig& query) const {
+    std::vector<QueryRun> runs;
+    if (query.isListener()) {
+        return runs;
+    }
+
+    // Running a rule by hand runs its source, and so every rule on it
+    if (query.isRule()) {
+        const QueryConfig* source = queries_->find(query.source);
+        if (!source || !source->isSource()) {
+            qWarning() << "Rule" << query.id.c_str() << "names unknown source" << query.source.c_str();
+            return runs;
+        }
+        return runsOf(*source);
+    }
+
+    std::vector<QueryConfig> rules = rulesOf(query);
+    for (const auto& target : targetsOf(query)) {
+        DatabaseManager* database = targets_.at(target);
+
+        // A target that is down is skipped; the rest of the fleet keeps running
+        if (!database->isConnected()) {
+            qDebug() << "Skipping" << runKey(query.id, target).c_str() << ": target not connected";
+            continue;
+        }
+        runs.push_back(QueryRun{query, target, database, rules});
+    }
+    return runs;
+}
+
+bool QueryEngine::compileRule(QueryConfig& query, std::string& error) {
+    if (!query.isRule()) {
+        query.rule.reset();
+        return true;
+    }
+    query.rule = SnapshotRule::compile(query.filter, query.message, query.aggregate, error);
+    return query.rule != nullptr;
+}
+
+std::vector<QueryConfig> QueryEngine::rulesOf(const QueryConfig& source) const {
+    std::vector<QueryConfig> rules;
+    if (!source.isSource()) {
+        return rules;
+    }
+
+    // Listed when the table was built, so a source's run no longer scans every query
+    for (const auto& rule : queries_->rulesOf(source)) {
+        rules.push_back(*rule);
+    }
+    return rules;
+}
+
+std::vector<QueryConfig> QueryEngine::rulesDue(const QueryConfig& source, const std::string& target,
+                                               QueryScheduler::Clock::time_point now) {
+    std::vector<QueryConfig> due;
+    const auto sourceInterval = scheduler_.getInterval(runKey(source.id, target));
+
+    for (auto& rule : rulesOf(source)) {
+        if (rule.intervalMs <= 0 || std::chrono::milliseconds(rule.intervalMs) <= sourceInterval) {
+            due.push_back(std::move(rule));
+            continue;
+        }
+
+        // A rule slower than its source takes the first snapshot within half a source
+        // interval of its own being due, so drift in the source's runs never skips one
+        auto& last = ruleRuns_[runKey(rule.id, target)];
+        if (last == std::chrono::steady_clock::time_point() ||
+            now - last + sourceInterval / 2 >= std::chrono::milliseconds(rule.intervalMs)) {
+            last = now;
+            due.push_back(std::move(rule));
+        }
+    }
+    return due;
+}
+
+void QueryEngine::submitRuns(const std::vector<QueryRun>& runs) {
+    if (runs.empty()) {
+        return;
+    }
+
+    // Runs still waiting for a worker when more come due means we are not keeping up
+    int backlog = workerPool_->getQueueDepth();
+    if (backlog > 0) {
+        {
+            QMutexLocker locker(&statsMutex_);
+            tickOverruns_++;
+        }
+        qWarning() << "Tick overrun:" << backlog << "queries are still waiting for a worker";
+        emit tickOverrun(backlog);
+    }
+
+    qDebug() << "Executing" << runs.size() << "queries";
+
+    if (!batchExecution_ || runs.size() == 1) {
+        for (const auto& run : runs) {
+            submitRun(run);
+        }
+        return;
+    }
+
+    // Read-only queries on the same target share one pipelined round-trip; anything else runs on its own
+    std::map<std::string, QueryJob> batches;
+    for (const auto& run : runs) {
+        // EXECUTE in a pipeline binds no parameters, so cursor queries run on their own
+        if (!isReadOnlySql(run.query.sql) || run.query.hasCursor() || run.query.isSource()) {
+            submitRun(run);
+        } else if (run.query.enabled && markInFlight(runKey(run.query.id, run.target))) {
+            QueryJob& batch = batches[run.target];
+            batch.target = run.target;
+            batch.database = run.database;
+            batch.queries.push_back(run.query);
+            batch.latencies.push_back(latencyOf(runKey(run.query.id, run.target)));
+        }
+    }
+
+    if (batches.empty()) {
         return;
     }
 
-    qDebug() << "Executing" << enabledQueries.size() << "queries";
+    if (!workerPool_->isRunning()) {
+        workerPool_->start(maxConcurrentQueries_);
+    }
 
-    for (const auto& query : enabledQueries) {
-        executeQuery(query.id);
+    for (auto& pair : batches) {
+        QueryJob& batch = pair.second;
+        int batchSize = static_cast<int>(batch.queries.size());
+        std::vector<std::string> batchKeys;
+        for (const auto& query : batch.queries) {
+            batchKeys.push_back(runKey(query.id, batch.target));
+        }
+
+        if (!workerPool_->submit(std::move(batch))) {
+            for (const auto& key : batchKeys) {
+                clearInFlight(key);
+            }
+            {
+                QMutexLocker locker(&statsMutex_);
+                droppedExecutions_ += batchSize;
+            }
+            qWarning() << "Query queue full, dropping batch of" << batchSize << "queries on" << pair.first.c_str();
+        }
     }
 }
 
 void QueryEngine::executeQuery(const std::string& queryId) {
-    QueryConfig* query = getQuery(queryId);
-    if (!query) {
-        qWarning() << "Query not found:" << queryId.c_str();
-        return;
+    std::vector<QueryRun> runs;
+    {
+        QMutexLocker locker(&queriesMutex_);
+        const QueryConfig* query = queries_->find(queryId);
+        if (!query) {
+            qWarning() << "Query not found:" << queryId.c_str();
+            return;
+        }
+        runs = runsOf(*query);
+    }
+
+    for (const auto& run : runs) {
+        submitRun(run);
     }
+}
 
-    if (!query->enabled) {
+void QueryEngine::submitRun(const QueryRun& run) {
+    if (!run.query.enabled) {
         return;
     }
 
-    // Execute in a separate thread to avoid blocking
-    QThread* workerThread = new QThread();
-    QueryWorker* worker = new QueryWorker(databaseManager_);
-    worker->setQuery(*query);
+    // A run still in flight covers this one; stacking another behind it only adds load
+    std::string key = runKey(run.query.id, run.target);
+    if (!markInFlight(key)) {
+        return;
+    }
 
-    worker->moveToThread(workerThread);
+    if (!workerPool_->isRunning()) {
+        workerPool_->start(maxConcurrentQueries_);
+    }
 
-    connect(workerThread, &QThread::started, worker, &QueryWorker::execute);
-    connect(worker, &QueryWorker::completed, this, &QueryEngine::onQueryCompleted);
-    connect(worker, &QueryWorker::completed, workerThread, &QThread::quit);
-    connect(worker, &QueryWorker::completed, worker, &QueryWorker::deleteLater);
-    connect(workerThread, &QThread::finished, workerThread, &QThread::deleteLater);
+    QueryJob job(run.query, run.target, run.database);
+    job.latencies.push_back(latencyOf(key));
+    job.rules = run.rules;
+    for (const auto& rule : run.rules) {
+        job.latencies.push_back(latencyOf(runKey(rule.id, run.target)));
+    }
+    if (run.query.hasCursor()) {
+        job.watermark = watermarks_->get(key, run.query.cursorColumn);
+        if (!job.watermark && !run.query.cursorStart.empty()) {
+            job.watermark = run.query.cursorStart;
+        }
+    }
 
-    workerThread->start();
+    if (!workerPool_->submit(std::move(job))) {
+        clearInFlight(key);
+        {
+            QMutexLocker locker(&statsMutex_);
+            droppedExecutions_++;
+        }
+        qWarning() << "Query queue full, dropping execution of" << key.c_str();
+    }
 }
 
 void QueryEngine::onDatabaseConnectionChanged(bool connected) {
-    if (!connected && isMonitoring_) {
+    if (connected || !isMonitoring_) {
+        return;
+    }
+
+    // Other targets keep monitoring; runs on the default one are skipped while it is down
+    bool otherTargetConnected;
+    {
+        QMutexLocker locker(&queriesMutex_);
+        otherTargetConnected = anyTargetConnected();
+    }
+
+    if (!otherTargetConnected) {
         qWarning() << "Database connection lost, stopping monitoring";
         stopMonitoring();
         emit queryError("", "Database connection lost");
@@ -245,22 +931,373 @@ void QueryEngine::onDatabaseConnectionChanged(bool connected) {
 }
 
 void QueryEngine::onTimerTimeout() {
-    executeAllQueries();
+    std::vector<QueryRun> dueRuns;
+    std::vector<QueryScheduler::Clock::duration> lateness;
+    {
+        QMutexLocker locker(&queriesMutex_);
+        auto now = QueryScheduler::Clock::now();
+        for (const auto& key : scheduler_.takeDue(now, &lateness)) {
+            std::string queryId;
+            std::string target;
+            if (!splitRunKey(key, queryId, target)) {
+                continue;
+            }
+
+            const QueryConfig* query = queries_->find(queryId);
+            if (!query || !query->enabled) {
+                continue;
+            }
+
+            DatabaseManager* database = targets_[target];
+            if (!database->isConnected()) {
+                qDebug() << "Skipping" << key.c_str() << ": target not connected";
+                continue;
+            }
+            dueRuns.push_back(QueryRun{*query, target, database, rulesDue(*query, target, now)});
+        }
+        armTimer();
+    }
+
+    for (const auto& late : lateness) {
+        schedulerLag_.record(std::chrono::duration_cast<std::chrono::microseconds>(late));
+    }
+    submitRuns(dueRuns);
+}
+
+void QueryEngine::scheduleQuery(const QueryConfig& query, QueryScheduler::Clock::time_point now) {
+    // Listeners are pushed to, never polled, and rules ride on their source's runs
+    if (query.isListener() || query.isRule()) {
+        return;
+    }
+
+    for (const auto& target : targetsOf(query)) {
+        scheduleRun(query, target, now);
+    }
+}
+
+void QueryEngine::scheduleRun(const QueryConfig& query, const std::string& target,
+                              QueryScheduler::Clock::time_point now) {
+    QuerySchedule schedule;
+    schedule.interval = std::chrono::milliseconds(baseInterval(query));
+    schedule.jitter = std::chrono::milliseconds(query.jitterMs);
+    schedule.phase = std::chrono::milliseconds(query.phaseMs);
+
+    // Derived phases hash the run key, so a fanned-out query is spread across targets
+    std::string key = runKey(query.id, target);
+    scheduler_.schedule(key, schedule, now);
+    lastFingerprints_.erase(key);
+}
+
+void QueryEngine::unscheduleQuery(const std::string& queryId) {
+    for (const auto& pair : targets_) {
+        std::string key = runKey(queryId, pair.first);
+        scheduler_.unschedule(key);
+        lastFingerprints_.erase(key);
+        ruleRuns_.erase(key);
+    }
+}
+
+QueryEngine::QueryTableChanges QueryEngine::applyQueries(std::map<std::string, QueryConfig> queries) {
+    QueryTableChanges changes;
+    auto now = QueryScheduler::Clock::now();
+
+    for (const auto& current : *queries_) {
+        if (!queries.count(current->id)) {
+            unregisterStatement(current->id);
+            if (isMonitoring_) {
+                unscheduleQuery(current->id);
+            }
+            changes.removed++;
+        }
+    }
+
+    std::vector<QueryTable::Entry> entries;
+    entries.reserve(queries.size());
+    for (auto& pair : queries) {
+        QueryTable::Entry current = queries_->entry(pair.first);
+        if (current && sameQuery(*current, pair.second)) {
+            entries.push_back(std::move(current));
+            continue;
+        }
+        QueryTable::Entry query = entryOf(std::move(pair.second));
+        entries.push_back(query);
+
+        // The target list may have changed, so the old statements go first;
+        // pooled connections re-prepare on next use once the SQL differs
+        bool statementChanged = !current || !sameStatement(*current, *query);
+        if (statementChanged) {
+            if (current) {
+                unregisterStatement(query->id);
+            }
+            registerStatement(*query);
+        }
+
+        // Everything else keeps its place in the schedule and any backed-off interval
+        if (isMonitoring_ && (statementChanged || !sameSchedule(*current, *query))) {
+            if (current) {
+                unscheduleQuery(query->id);
+            }
+            if (query->enabled) {
+                scheduleQuery(*query, now);
+            }
+        }
+
+        if (current) {
+            changes.changed++;
+        } else {
+            changes.added++;
+        }
+    }
+
+    // Unchanged queries are shared with the old table, which goes once its last reader lets go
+    publishQueries(std::make_shared<const QueryTable>(std::move(entries)));
+
+    if (isMonitoring_) {
+        armTimer();
+        syncListeners();
+    }
+    return changes;
+}
+
+void QueryEngine::rescheduleAll() {
+    scheduler_.clear();
+    lastFingerprints_.clear();
+    ruleRuns_.clear();
+
+    auto now = QueryScheduler::Clock::now();
+    for (const auto& query : *queries_) {
+        if (query->enabled) {
+            scheduleQuery(*query, now);
+        }
+    }
+    armTimer();
+}
+
+void QueryEngine::armTimer() {
+    if (!isMonitoring_) {
+        return;
+    }
+
+    auto next = scheduler_.nextDueTime();
+    if (next == QueryScheduler::Clock::time_point::max()) {
+        timer_->stop();
+        return;
+    }
+
+    // Round up so the timer never fires before the query is due
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - QueryScheduler::Clock::now());
+    timer_->start(static_cast<int>(std::max<long long>(0, wait.count())));
+}
+
+bool QueryEngine::isAdaptive(const QueryConfig& query) const {
+    return query.adaptive.value_or(adaptiveScheduling_);
+}
+
+int QueryEngine::baseInterval(const QueryConfig& query) const {
+    int interval = query.intervalMs > 0 ? query.intervalMs : interval_;
+    if (isAdaptive(query) && query.minIntervalMs > 0) {
+        interval = query.minIntervalMs;
+    }
+    return interval;
+}
+
+void QueryEngine::adaptInterval(const std::string& key, const QueryResult& result, bool alerted) {
+    const QueryConfig* scheduled = queries_->find(result.handle);
+    if (!scheduled) {
+        return;
+    }
+
+    // A rule's alert speeds up the source it rides on; the source's own results back it off
+    std::string scheduledKey = key;
+    if (scheduled->isRule()) {
+        if (!alerted) {
+            return;
+        }
+        scheduledKey = runKey(scheduled->source, result.target);
+        scheduled = queries_->find(scheduled->source);
+        if (!scheduled) {
+            return;
+        }
+    }
+
+    if (!isAdaptive(*scheduled) || !scheduler_.isScheduled(scheduledKey)) {
+        return;
+    }
+    const QueryConfig& query = *scheduled;
+
+    // Failures hold the interval: a struggling server is not polled harder, nor ignored
+    if (!result.success) {
+        return;
+    }
+
+    const int minInterval = baseInterval(query);
+    const int maxInterval = std::max(minInterval, query.maxIntervalMs > 0 ? query.maxIntervalMs
+                                                                          : adaptiveMaxInterval_);
+    const int current = static_cast<int>(scheduler_.getInterval(scheduledKey).count());
+
+    int next = current;
+    if (alerted) {
+        next = minInterval;
+    } else {
+        auto last = lastFingerprints_.find(scheduledKey);
+        bool unchanged = last != lastFingerprints_.end() && last->second == result.summary.fingerprint;
+        if (result.summary.empty() || unchanged) {
+            next = static_cast<int>(std::min<long long>(2LL * current, maxInterval));
+        }
+    }
+
+    // Only the scheduled query's own rows count as its previous result
+    if (scheduledKey == key) {
+        lastFingerprints_[key] = result.summary.fingerprint;
+    }
+
+    if (next != current) {
+        scheduler_.setInterval(scheduledKey, std::chrono::milliseconds(next), QueryScheduler::Clock::now());
+        armTimer();
+        qDebug() << "Adaptive interval of" << scheduledKey.c_str() << "is now" << next << "ms";
+    }
+}
+
+std::shared_ptr<QueryLatency> QueryEngine::latencyOf(const std::string& runKey) {
+    QMutexLocker locker(&statsMutex_);
+    std::shared_ptr<QueryLatency>& latency = latencies_[runKey];
+    if (!latency) {
+        latency = std::make_shared<QueryLatency>();
+    }
+    return latency;
+}
+
+bool QueryEngine::markInFlight(const std::string& runKey) {
+    bool inserted;
+    {
+        QMutexLocker locker(&inFlightMutex_);
+        inserted = inFlight_.insert(runKey).second;
+    }
+
+    if (!inserted) {
+        QMutexLocker locker(&statsMutex_);
+        skippedExecutions_++;
+        qDebug() << "Skipping" << runKey.c_str() << ": previous run is still in flight";
+    }
+    return inserted;
+}
+
+void QueryEngine::clearInFlight(const std::string& runKey) {
+    QMutexLocker locker(&inFlightMutex_);
+    inFlight_.erase(runKey);
+}
+
+void QueryEngine::clearInFlight() {
+    QMutexLocker locker(&inFlightMutex_);
+    inFlight_.clear();
 }
 
 void QueryEngine::onQueryCompleted(const QueryResult& result) {
+    auto startTime = std::chrono::steady_clock::now();
+    std::string key = runKey(result.queryId, result.target);
+    clearInFlight(key);
+
+    // One lookup by handle serves the whole result, and holding the table keeps
+    // the query alive through it; a query removed meanwhile raises nothing
+    std::shared_ptr<const QueryTable> queries = getQueryTable();
+    const QueryConfig* query = queries->find(result.handle);
+
+    // Advanced before the next run of this key can be submitted, since it was in flight until now
+    if (result.watermark && query && query->hasCursor()) {
+        watermarks_->set(key, query->cursorColumn, *result.watermark);
+    }
+
+    // Same rows as a moment ago: count the run but don't raise the alert again
+    bool duplicate = result.success && !result.summary.empty() &&
+                     isRecentDuplicate(key, result.summary.fingerprint);
+
     updateStatistics(result);
-    processQueryResult(result);
+    bool alerted = !duplicate && query && processQueryResult(*query, result);
     cleanupQueryHistory();
 
+    if (isMonitoring_) {
+        QMutexLocker locker(&queriesMutex_);
+        adaptInterval(key, result, alerted);
+    }
+
+    if (result.latency) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime);
+        result.latency->processing.record(result.processingTime + elapsed);
+    }
+
     emit queryExecuted(result);
 }
 
-bool QueryEngine::parseConfigFile(const std::string& content) {
+void QueryEngine::onWatermarkTimer() {
+    if (watermarks_->isDirty()) {
+        saveWatermarks();
+    }
+}
+
+void QueryEngine::onNotification(const std::string& target, const std::string& channel,
+                                 const std::string& payload, int backendPid) {
+    // Notifications queued before monitoring stopped are dropped with it
+    if (!isMonitoring_) {
+        return;
+    }
+
+    std::vector<QueryConfig> listening;
+    {
+        QMutexLocker locker(&queriesMutex_);
+        for (const auto& query : *queries_) {
+            if (!query->enabled || query->channel != channel) {
+                continue;
+            }
+            std::vector<std::string> targets = targetsOf(*query);
+            if (std::find(targets.begin(), targets.end(), target) != targets.end()) {
+                listening.push_back(*query);
+            }
+        }
+    }
+
+    {
+        QMutexLocker locker(&statsMutex_);
+        notificationsReceived_++;
+    }
+
+    for (const auto& query : listening) {
+        generateNotificationAlert(query, target, payload, backendPid);
+    }
+}
+
+bool QueryEngine::parseConfigFile(const std::string& content, std::map<std::string, QueryConfig>& queries) {
     std::istringstream stream(content);
     std::string line;
     QueryConfig currentQuery;
 
+    auto saveQuery = [&queries](QueryConfig& query) {
+        if (query.id.empty()) {
+            return;
+        }
+
+        // A rule reads its source's rows, so it has no statement, cursor or channel of its own
+        if (query.isRule() && (query.isSource() || query.hasCursor() || query.isListener())) {
+            qWarning() << "Query" << query.id.c_str() << ": source= cannot be combined with a source section, cursor= or listen=, ignoring those";
+            query.snapshot = false;
+            query.cursorColumn.clear();
+            query.channel.clear();
+        }
+
+        // The aggregate's single row has no cursor column to carry forward, nor rows left for rules
+        if (query.isAggregate() && (query.hasCursor() || query.isSource())) {
+            qWarning() << "Query" << query.id.c_str() << ": aggregate= cannot be combined with cursor= or a source section, ignoring the aggregate";
+            query.aggregate.clear();
+        }
+
+        std::string error;
+        if (!compileRule(query, error)) {
+            qWarning() << "Rule" << query.id.c_str() << "skipped:" << error.c_str();
+            return;
+        }
+        queries[query.id] = query;
+    };
+
     while (std::getline(stream, line)) {
         line = trimString(line);
 
@@ -272,13 +1309,15 @@ bool QueryEngine::parseConfigFile(const std::string& content) {
         // Check for section header
         if (line[0] == '[' && line.back() == ']') {
             // Save previous query if exists
-            if (!currentQuery.id.empty()) {
-                queries_[currentQuery.id] = currentQuery;
-            }
+            saveQuery(currentQuery);
 
-            // Start new query
+            // Start new query; [Source:<name>] starts a shared snapshot named <name>
             currentQuery = QueryConfig();
             currentQuery.id = line.substr(1, line.length() - 2);
+            if (currentQuery.id.compare(0, 7, "Source:") == 0) {
+                currentQuery.id = trimString(currentQuery.id.substr(7));
+                currentQuery.snapshot = true;
+            }
             continue;
         }
 
@@ -308,20 +1347,205 @@ bool QueryEngine::parseConfigFile(const std::string& content) {
                 } catch (const std::exception&) {
                     currentQuery.timeoutSeconds = 5;
                 }
+            } else if (key == "interval") {
+                currentQuery.intervalMs = parseDuration(value, 0);
+            } else if (key == "jitter") {
+                currentQuery.jitterMs = parseDuration(value, 0);
+            } else if (key == "phase") {
+                currentQuery.phaseMs = parseDuration(value, -1);
+            } else if (key == "target") {
+                currentQuery.target = value;
+            } else if (key == "listen") {
+                currentQuery.channel = value;
+            } else if (key == "cursor") {
+                currentQuery.cursorColumn = value;
+            } else if (key == "cursor_start") {
+                currentQuery.cursorStart = value;
+            } else if (key == "aggregate") {
+                currentQuery.aggregate = value;
+            } else if (key == "source") {
+                currentQuery.source = value;
+            } else if (key == "where") {
+                currentQuery.filter = value;
+            } else if (key == "message") {
+                currentQuery.message = value;
+            } else if (key == "adaptive") {
+                currentQuery.adaptive = (value == "true" || value == "1" || value == "yes");
+            } else if (key == "min_interval") {
+                currentQuery.minIntervalMs = parseDuration(value, 0);
+            } else if (key == "max_interval") {
+                currentQuery.maxIntervalMs = parseDuration(value, 0);
+            } else if (key == "warning" || key == "critical") {
+                try {
+                    (key == "warning" ? currentQuery.warningLevel : currentQuery.criticalLevel) = std::stod(value);
+                } catch (const std::exception&) {
+                    qWarning() << "Query" << currentQuery.id.c_str() << ": ignoring non-numeric" << key.c_str() << "level";
+                }
             }
         }
     }
 
     // Save last query
-    if (!currentQuery.id.empty()) {
-        queries_[currentQuery.id] = currentQuery;
+    saveQuery(currentQuery);
+
+    for (const auto& pair : queries) {
+        if (pair.second.isRule()) {
+            auto source = queries.find(pair.second.source);
+            if (source == queries.end() || !source->second.isSource()) {
+                qWarning() << "Rule" << pair.first.c_str() << "names unknown source" << pair.second.source.c_str();
+            }
+        }
+    }
+
+    qDebug() << "Loaded" << queries.size() << "queries from configuration";
+    return !queries.empty();
+}
+
+void QueryEngine::registerStatement(const QueryConfig& query) {
+    if (query.isListener() || query.isRule()) {
+        return;
+    }
+
+    // Left unregistered, each run fails and raises an error alert naming the problem
+    std::string sql;
+    std::string error;
+    if (!statementSql(query, sql, error)) {
+        qWarning() << "Query" << query.id.c_str() << "not prepared:" << error.c_str();
+        return;
+    }
+
+    for (const auto& target : targetsOf(query)) {
+        targets_[target]->registerStatement(query.id, sql);
+    }
+}
+
+bool QueryEngine::statementSql(const QueryConfig& query, std::string& sql, std::string& error) {
+    if (!query.isAggregate()) {
+        sql = query.sql;
+        return true;
+    }
+
+    std::string function;
+    std::string column;
+    if (!SnapshotRule::parseAggregate(query.aggregate, function, column, error)) {
+        return false;
+    }
+
+    // A trailing semicolon would end the subquery early
+    std::string inner = trimString(query.sql);
+    while (!inner.empty() && inner.back() == ';') {
+        inner = trimString(inner.substr(0, inner.size() - 1));
+    }
+    if (inner.empty()) {
+        error = "aggregate query has no sql";
+        return false;
+    }
+
+    sql = "SELECT " + function + "(" + column + ") AS value FROM (" + inner + ") AS monitored";
+    return true;
+}
+
+void QueryEngine::unregisterStatement(const std::string& queryId) {
+    // Unregistering a name a manager never had is harmless
+    for (const auto& pair : targets_) {
+        pair.second->unregisterStatement(queryId);
+    }
+}
+
+std::vector<std::string> QueryEngine::targetsOf(const QueryConfig& query) const {
+    std::vector<std::string> targets;
+    std::string spec = trimString(query.target);
+
+    if (spec == "*") {
+        for (const auto& pair : targets_) {
+            targets.push_back(pair.first);
+        }
+        return targets;
+    }
+
+    if (spec.empty()) {
+        spec = DEFAULT_TARGET;
+    }
+
+    std::istringstream stream(spec);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        name = trimString(name);
+        if (name.empty() || std::find(targets.begin(), targets.end(), name) != targets.end()) {
+            continue;
+        }
+        if (targets_.count(name)) {
+            targets.push_back(name);
+        }
+    }
+    return targets;
+}
+
+bool QueryEngine::splitRunKey(const std::string& key, std::string& queryId, std::string& target) const {
+    // Target names never contain '@', so the last one separates them from the id
+    size_t separator = key.rfind('@');
+    if (separator != std::string::npos && targets_.count(key.substr(separator + 1))) {
+        queryId = key.substr(0, separator);
+        target = key.substr(separator + 1);
+    } else {
+        queryId = key;
+        target = DEFAULT_TARGET;
+    }
+    return targets_.count(target) > 0;
+}
+
+bool QueryEngine::anyTargetConnected() const {
+    for (const auto& pair : targets_) {
+        if (pair.second->isConnected()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QueryEngine::syncListeners() {
+    std::map<std::string, std::set<std::string>> channels;
+    for (const auto& query : *queries_) {
+        if (query->enabled && query->isListener()) {
+            for (const auto& target : targetsOf(*query)) {
+                channels[target].insert(query->channel);
+            }
+        }
+    }
+
+    for (const auto& pair : targets_) {
+        const std::string& target = pair.first;
+        auto wanted = channels.find(target);
+        auto it = listeners_.find(target);
+
+        if (wanted == channels.end()) {
+            if (it != listeners_.end()) {
+                it->second->stop();
+            }
+            continue;
+        }
+
+        // The listener has its own connection, opened with the target's settings
+        if (it == listeners_.end()) {
+            auto* listener = new NotificationListener(pair.second->getConnectionConfig().toConnectionString(), this);
+            connect(listener, &NotificationListener::notificationReceived, this,
+                    [this, target](const std::string& channel, const std::string& payload, int backendPid) {
+                        onNotification(target, channel, payload, backendPid);
+                    });
+            it = listeners_.emplace(target, listener).first;
+        }
+        it->second->setChannels(wanted->second);
+        it->second->start();
     }
+}
 
-    qDebug() << "Loaded" << queries_.size() << "queries from configuration";
-    return !queries_.empty();
+void QueryEngine::stopListeners() {
+    for (const auto& pair : listeners_) {
+        pair.second->stop();
+    }
 }
 
-AlertType QueryEngine::parseAlertType(const std::string& typeStr) const {
+AlertType QueryEngine::parseAlertType(const std::string& typeStr) {
     std::string lowerType = typeStr;
     std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(), ::tolower);
 
@@ -334,7 +1558,60 @@ AlertType QueryEngine::parseAlertType(const std::string& typeStr) const {
     }
 }
 
-std::string QueryEngine::trimString(const std::string& str) const {
+bool QueryEngine::isReadOnlySql(const std::string& sql) {
+    size_t start = sql.find_first_not_of(" \t\n\r(");
+    if (start == std::string::npos) {
+        return false;
+    }
+
+    size_t end = start;
+    while (end < sql.size() && std::isalpha(static_cast<unsigned char>(sql[end]))) {
+        ++end;
+    }
+
+    std::string keyword = sql.substr(start, end - start);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(), ::tolower);
+
+    // WITH can hide data-modifying CTEs, so only plain reads qualify
+    return keyword == "select" || keyword == "values" || keyword == "table" || keyword == "show";
+}
+
+int QueryEngine::parseDuration(const std::string& value, int defaultMs) {
+    // Bare numbers are seconds, like timeout=; ms, s, m and h suffixes are accepted
+    long long amount;
+    size_t unitPos = 0;
+    try {
+        amount = std::stoll(value, &unitPos);
+    } catch (const std::exception&) {
+        return defaultMs;
+    }
+
+    if (amount < 0) {
+        return defaultMs;
+    }
+    amount = std::min<long long>(amount, std::numeric_limits<int>::max());
+
+    std::string unit = value.substr(unitPos);
+    unit.erase(0, unit.find_first_not_of(" \t"));
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::tolower);
+
+    long long milliseconds;
+    if (unit.empty() || unit == "s") {
+        milliseconds = amount * 1000;
+    } else if (unit == "ms") {
+        milliseconds = amount;
+    } else if (unit == "m") {
+        milliseconds = amount * 60 * 1000;
+    } else if (unit == "h") {
+        milliseconds = amount * 60 * 60 * 1000;
+    } else {
+        return defaultMs;
+    }
+
+    return static_cast<int>(std::min<long long>(milliseconds, std::numeric_limits<int>::max()));
+}
+
+std::string QueryEngine::trimString(const std::string& str) {
     const std::string whitespace = " \t\n\r\f\v";
     size_t start = str.find_first_not_of(whitespace);
     if (start == std::string::npos) {
@@ -345,21 +1622,13 @@ std::string QueryEngine::trimString(const std::string& str) const {
 }
 
 QueryResult QueryEngine::executeQueryInternal(const QueryConfig& query) {
-    QueryResult result(query.id, query.name);
+    QueryResult result(query);
     auto startTime = std::chrono::high_resolution_clock::now();
 
     try {
-        result.data = databaseManager_->executeQuery(query.sql);
+        result.summary = ResultSummary::of(databaseManager_->executeQuery(query.sql));
         result.success = true;
 
-        // Check for duplicate results
-        std::string dataHash = calculateResultHash(result.data);
-        if (isRecentDuplicate(query.id, dataHash)) {
-            result.success = false;
-            result.errorMessage = "Duplicate result ignored";
-            return result;
-        }
-
     } catch (const std::exception& e) {
         result.success = false;
         result.errorMessage = e.what();
@@ -371,130 +1640,186 @@ QueryResult QueryEngine::executeQueryInternal(const QueryConfig& query) {
     return result;
 }
 
-void QueryEngine::processQueryResult(const QueryResult& result) {
-    if (result.success && !result.data.empty()) {
-        generateDataAlert(result);
+bool QueryEngine::processQueryResult(const QueryConfig& query, const QueryResult& result) {
+    if (result.success && !result.summary.empty()) {
+        return generateDataAlert(query, result);
     } else if (!result.success) {
-        generateErrorAlert(result);
+        return generateErrorAlert(query, result);
     }
+    return false;
 }
 
 void QueryEngine::generateAlerts(const QueryResult& result) {
     // This method can be extended to generate multiple types of alerts
-    generateDataAlert(result);
+    std::shared_ptr<const QueryTable> queries = getQueryTable();
+    if (const QueryConfig* query = queries->find(result.handle)) {
+        generateDataAlert(*query, result);
+    }
 }
 
-void QueryEngine::generateDataAlert(const QueryResult& result) {
-    QueryConfig* query = getQuery(result.queryId);
-    if (!query) {
-        return;
+bool QueryEngine::generateDataAlert(const QueryConfig& query, const QueryResult& result) {
+    // A source's rows are there for its rules
+    if (query.isSource()) {
+        return false;
+    }
+
+    if (query.isAggregate()) {
+        return generateAggregateAlert(query, result);
     }
 
-    AlertType alertType = query->alertType;
+    AlertType alertType = query.alertType;
 
     // Apply threshold logic
-    if (query->threshold > 0) {
-        alertType = alertSystem_->classifyFromThreshold(result.data, query->threshold, alertType);
+    if (query.threshold > 0) {
+        alertType = alertSystem_->classifyFromThreshold(result.summary, query.threshold, alertType);
     }
 
     // Create alert message
-    std::string message = formatAlertMessage(*query, result.data);
+    std::string message = formatAlertMessage(query, result.summary);
 
     // Add alert
     if (alertSystem_) {
-        int alertId = alertSystem_->addAlert(alertType, query->name, message,
-                                           query->id, "Data returned from query");
+        InternedString title = strings_->handle(query.name);
+        InternedString source = strings_->handle(runKey(query.id, result.target));
+
+        int alertId = alertSystem_->addAlert(alertType, title, message,
+                                           source, "Data returned from query");
         if (alertId > 0) {
-            emit alertGenerated(Alert(alertId, alertType, query->name, message,
-                                    query->id, "Query executed successfully"));
+            emit alertGenerated(Alert(alertId, alertType, title, message,
+                                    source, "Query executed successfully"));
+            return true;
         }
     }
+    return false;
 }
 
-void QueryEngine::generateErrorAlert(const QueryResult& result) {
-    QueryConfig* query = getQuery(result.queryId);
-    if (!query) {
-        return;
+bool QueryEngine::generateAggregateAlert(const QueryConfig& query, const QueryResult& result) {
+    // sum, min, max and avg over no rows are NULL: nothing to report
+    if (!alertSystem_ || !result.summary.firstValue) {
+        return false;
+    }
+
+    const std::string& text = *result.summary.firstValue;
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str()) {
+        qWarning() << "Aggregate of" << query.id.c_str() << "is not numeric:" << text.c_str();
+        return false;
+    }
+
+    std::optional<double> warning = query.warningLevel;
+    std::optional<double> critical = query.criticalLevel;
+    if (!warning && !critical && query.threshold > 0) {
+        warning = query.threshold;
+        critical = 2.0 * query.threshold;
+    }
+
+    AlertType alertType;
+    std::string level;
+    if (critical && value >= *critical) {
+        alertType = AlertType::CRITICAL;
+        level = " (critical at " + trimNumber(*critical) + ")";
+    } else if (warning && value >= *warning) {
+        alertType = AlertType::WARNING;
+        level = " (warning at " + trimNumber(*warning) + ")";
+    } else if (!warning && !critical && value > 0) {
+        alertType = query.alertType;
+    } else {
+        return false;
+    }
+
+    std::string message = query.aggregate + " = " + text + level;
+    InternedString title = strings_->handle(query.name);
+    InternedString source = strings_->handle(runKey(query.id, result.target));
+
+    int alertId = alertSystem_->addAlert(alertType, title, message, source, "Aggregated on the server");
+    if (alertId > 0) {
+        emit alertGenerated(Alert(alertId, alertType, title, message, source, "Aggregated on the server"));
+        return true;
     }
+    return false;
+}
 
+bool QueryEngine::generateErrorAlert(const QueryConfig& query, const QueryResult& result) {
     std::string message = "Query execution failed: " + result.errorMessage;
 
     if (alertSystem_) {
-        int alertId = alertSystem_->addAlert(AlertType::WARNING, query->name, message,
-                                           query->id, "Query error: " + result.errorMessage);
+        InternedString title = strings_->handle(query.name);
+        InternedString source = strings_->handle(runKey(query.id, result.target));
+
+        int alertId = alertSystem_->addAlert(AlertType::WARNING, title, message,
+                                           source, "Query error: " + result.errorMessage);
         if (alertId > 0) {
-            emit alertGenerated(Alert(alertId, AlertType::WARNING, query->name, message,
-                                    query->id, result.errorMessage));
+            emit alertGenerated(Alert(alertId, AlertType::WARNING, title, message,
+                                    source, result.errorMessage));
+            return true;
         }
     }
+    return false;
 }
 
-std::string QueryEngine::formatAlertMessage(const QueryConfig& query, const pqxx::result& result) {
-    if (result.empty()) {
-        return "No results returned from query";
+void QueryEngine::generateNotificationAlert(const QueryConfig& query, const std::string& target,
+                                            const std::string& payload, int backendPid) {
+    if (!alertSystem_) {
+        return;
     }
 
-    // Try to format the first column of the first row
-    try {
-        const auto& firstRow = result[0];
-        if (firstRow.size() > 0) {
-            std::string firstValue = firstRow[0].as<std::string>();
-            if (result.size() == 1) {
-                return firstValue;
-            } else {
-                return firstValue + " (and " + std::to_string(result.size() - 1) + " more rows)";
+    // A numeric payload is held to the threshold the way a count column is
+    AlertType alertType = query.alertType;
+    if (query.threshold > 0) {
+        try {
+            size_t used = 0;
+            long long value = std::stoll(payload, &used);
+            if (used == payload.size() && value >= query.threshold) {
+                alertType = (value >= 2LL * query.threshold) ? AlertType::CRITICAL : AlertType::WARNING;
             }
+        } catch (const std::exception&) {
+            // Not a number, keep the configured type
         }
-    } catch (const std::exception&) {
-        // Fall back to count
     }
 
-    return "Query returned " + std::to_string(result.size()) + " row(s)";
-}
+    std::string message = payload.empty() ? "Notification on channel " + query.channel : payload;
+    std::string rawResult = "NOTIFY " + query.channel + " from backend " + std::to_string(backendPid);
 
-void QueryEngine::lockQueries() {
-    queriesMutex_.lock();
-}
+    InternedString title = strings_->handle(query.name);
+    InternedString source = strings_->handle(runKey(query.id, target));
 
-void QueryEngine::unlockQueries() {
-    queriesMutex_.unlock();
+    int alertId = alertSystem_->addAlert(alertType, title, message, source, rawResult);
+    if (alertId > 0) {
+        emit alertGenerated(Alert(alertId, alertType, title, message, source, rawResult));
+    }
 }
 
-std::string QueryEngine::calculateResultHash(const pqxx::result& result) const {
-    if (result.empty()) {
-        return "empty";
+std::string QueryEngine::formatAlertMessage(const QueryConfig& query, const ResultSummary& summary) {
+    if (summary.empty()) {
+        return "No results returned from query";
     }
 
-    std::stringstream hashStream;
-    hashStream << result.size() << "_";
-
-    // Hash the first few rows and columns
-    int maxRows = std::min(3, static_cast<int>(result.size()));
-    for (int i = 0; i < maxRows; ++i) {
-        const auto& row = result[i];
-        int maxCols = std::min(3, static_cast<int>(row.size()));
-        for (int j = 0; j < maxCols; ++j) {
-            try {
-                hashStream << row[j].as<std::string>() << "|";
-            } catch (const std::exception&) {
-                hashStream << "NULL|";
-            }
+    // The first column of the first row, unless it was NULL
+    if (summary.firstValue) {
+        if (summary.rows == 1) {
+            return *summary.firstValue;
         }
-        hashStream << ";";
+        return *summary.firstValue + " (and " + std::to_string(summary.rows - 1) + " more rows)";
     }
 
-    // Simple hash (in production, use proper cryptographic hash)
-    std::string hashInput = hashStream.str();
-    std::hash<std::string> hasher;
-    return std::to_string(hasher(hashInput));
+    return "Query returned " + std::to_string(summary.rows) + " row(s)";
+}
+
+void QueryEngine::lockQueries() {
+    queriesMutex_.lock();
+}
+
+void QueryEngine::unlockQueries() {
+    queriesMutex_.unlock();
 }
 
-bool QueryEngine::isRecentDuplicate(const std::string& queryId, const std::string& dataHash, int timeWindowSeconds) const {
+bool QueryEngine::isRecentDuplicate(const std::string& runKey, uint64_t fingerprint, int timeWindowSeconds) const {
     QMutexLocker locker(&historyMutex_);
     QDateTime cutoff = QDateTime::currentDateTime().addSecs(-timeWindowSeconds);
 
     for (const auto& entry : queryHistory_) {
-        if (entry.queryId == queryId && entry.dataHash == dataHash && entry.timestamp >= cutoff) {
+        if (entry.fingerprint == fingerprint && entry.timestamp >= cutoff && entry.runKey == runKey) {
             return true;
         }
     }
@@ -531,71 +1856,340 @@ void QueryEngine::updateStatistics(const QueryResult& result) {
     totalExecutionTime_ += result.executionTime;
     lastExecutionTime_ = result.timestamp;
 
-    queryExecutionCounts_[result.queryId]++;
+    std::string key = runKey(result.queryId, result.target);
+    queryExecutionCounts_[key]++;
 
     // Update query history for duplicate detection
-    if (result.success && !result.data.empty()) {
+    if (result.success && !result.summary.empty()) {
         QMutexLocker historyLocker(&historyMutex_);
-        std::string dataHash = calculateResultHash(result.data);
-        queryHistory_.emplace_back(result.queryId, dataHash);
+        queryHistory_.emplace_back(key, result.summary.fingerprint);
     }
 }
 
 // QueryWorker implementation
-QueryWorker::QueryWorker(DatabaseManager* dbManager, QObject *parent)
+QueryWorker::QueryWorker(QueryWorkerPool* pool, QObject *parent)
     : QObject(parent)
-    , databaseManager_(dbManager)
-    , shouldStop_(false)
+    , pool_(pool)
 {
 }
 
 QueryWorker::~QueryWorker() = default;
 
-void QueryWorker::setQuery(const QueryConfig& query) {
-    QMutexLocker locker(&queryMutex_);
-    query_ = query;
-    shouldStop_ = false;
+void QueryWorker::run() {
+    QueryJob job;
+    while (pool_->takeNext(job)) {
+        std::vector<QueryResult> results;
+        if (!job.rules.empty()) {
+            results = executeSource(job.database, job.queries.front(), job.rules, job.watermark);
+        } else if (job.queries.size() == 1) {
+            results.push_back(execute(job.database, job.queries.front(), job.watermark));
+        } else {
+            results = executeBatch(job.database, job.queries);
+        }
+        pool_->markFinished();
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            QueryResult& result = results[i];
+            result.target = job.target;
+            if (i < job.latencies.size() && job.latencies[i]) {
+                result.latency = job.latencies[i];
+                result.latency->connectionWait.record(result.timing.connectionWait);
+                result.latency->execution.record(result.timing.execution);
+            }
+            emit completed(result);
+        }
+    }
+
+    // The event loop has not started yet; make it return immediately
+    QThread::currentThread()->quit();
 }
 
-void QueryWorker::stop() {
-    QMutexLocker locker(&queryMutex_);
-    shouldStop_ = true;
+QueryResult QueryWorker::execute(DatabaseManager* database, const QueryConfig& query,
+                                 const std::optional<std::string>& watermark, pqxx::result* rows) {
+    QueryResult result(query);
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    try {
+        if (!database || !database->isConnected()) {
+            throw std::runtime_error("Database not connected");
+        }
+
+        // Statements are registered under the query id when the query is loaded
+        std::vector<std::optional<std::string>> params;
+        if (query.hasCursor()) {
+            params.push_back(watermark);
+        }
+        pqxx::result data = database->executePrepared(query.id, params, std::chrono::seconds(query.timeoutSeconds),
+                                                      &result.timing);
+        auto processingStart = std::chrono::steady_clock::now();
+        result.summary = ResultSummary::of(data);
+        result.success = true;
+
+        // Rows come back in cursor order, so the last one holds the new watermark
+        if (query.hasCursor() && !data.empty()) {
+            const auto& field = data[data.size() - 1][query.cursorColumn];
+            if (!field.is_null()) {
+                result.watermark = field.as<std::string>();
+            }
+        }
+        result.processingTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - processingStart);
+
+        if (rows) {
+            *rows = std::move(data);
+        }
+
+    } catch (const pqxx::query_cancelled& e) {
+        result.success = false;
+        result.errorMessage = "Query exceeded its " + std::to_string(query.timeoutSeconds) +
+                              "s timeout: " + e.what();
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.errorMessage = e.what();
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.executionTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+
+    return result;
 }
 
-void QueryWorker::execute() {
-    QueryResult result;
-    QueryConfig query;
+std::vector<QueryResult> QueryWorker::executeSource(DatabaseManager* database, const QueryConfig& source,
+                                                    const std::vector<QueryConfig>& rules,
+                                                    const std::optional<std::string>& watermark) {
+    std::vector<QueryResult> results;
+    results.reserve(rules.size() + 1);
 
-    {
-        QMutexLocker locker(&queryMutex_);
-        if (shouldStop_) {
-            return;
+    pqxx::result snapshot;
+    results.push_back(execute(database, source, watermark, &snapshot));
+
+    // A failed snapshot is reported once, by the source; its rules have nothing to read
+    const QueryResult& sourceResult = results.front();
+    if (!sourceResult.success) {
+        return results;
+    }
+
+    // Each rule is charged the snapshot's round-trip, which it would have made alone
+    for (const auto& rule : rules) {
+        QueryResult result(rule);
+        auto evaluationStart = std::chrono::steady_clock::now();
+        std::string error;
+        if (!rule.rule) {
+            error = "rule was not compiled";
+        } else if (rule.rule->evaluate(snapshot, result.summary, error)) {
+            result.success = true;
         }
-        query = query_;
-        result.queryId = query.id;
-        result.queryName = query.name;
+        result.errorMessage = error;
+        result.timing = sourceResult.timing;
+        result.executionTime = sourceResult.executionTime;
+        result.processingTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - evaluationStart);
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+std::vector<QueryResult> QueryWorker::executeBatch(DatabaseManager* database, const std::vector<QueryConfig>& queries) {
+    std::vector<QueryResult> results;
+    results.reserve(queries.size());
+    for (const auto& query : queries) {
+        results.emplace_back(query);
     }
 
-    result.timestamp = QDateTime::currentDateTime();
     auto startTime = std::chrono::high_resolution_clock::now();
 
     try {
-        if (!databaseManager_ || !databaseManager_->isConnected()) {
+        if (!database || !database->isConnected()) {
             throw std::runtime_error("Database not connected");
         }
 
-        result.data = databaseManager_->executeQuery(query.sql);
-        result.success = true;
+        std::vector<std::string> names;
+        names.reserve(queries.size());
+        int timeoutSeconds = 0;
+        for (const auto& query : queries) {
+            names.push_back(query.id);
+            timeoutSeconds = std::max(timeoutSeconds, query.timeoutSeconds);
+        }
+
+        // One session setting covers the batch, so the most lenient timeout wins
+        QueryTiming timing;
+        std::vector<PreparedBatchResult> batchResults =
+            database->executePreparedBatch(names, std::chrono::seconds(timeoutSeconds), &timing);
+        for (size_t i = 0; i < batchResults.size(); ++i) {
+            auto processingStart = std::chrono::steady_clock::now();
+            results[i].timing = timing;
+            results[i].success = batchResults[i].success;
+            results[i].errorMessage = std::move(batchResults[i].errorMessage);
+            if (results[i].success) {
+                results[i].summary = ResultSummary::of(batchResults[i].data);
+            }
+            results[i].processingTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - processingStart);
+        }
 
     } catch (const std::exception& e) {
-        result.success = false;
-        result.errorMessage = e.what();
+        for (auto& result : results) {
+            result.success = false;
+            result.errorMessage = e.what();
+        }
     }
 
+    // The whole batch shares one round-trip, so every query reports its duration
     auto endTime = std::chrono::high_resolution_clock::now();
-    result.executionTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    for (auto& result : results) {
+        result.executionTime = elapsed;
+    }
+
+    return results;
+}
+
+// QueryWorkerPool implementation
+QueryWorkerPool::QueryWorkerPool(QObject *parent)
+    : QObject(parent)
+    , maxQueueSize_(100)
+    , activeCount_(0)
+    , maxQueueDepth_(0)
+    , stopping_(false)
+{
+}
+
+QueryWorkerPool::~QueryWorkerPool() {
+    stop();
+}
+
+void QueryWorkerPool::start(int workerCount) {
+    if (isRunning()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&queueMutex_);
+        stopping_ = false;
+    }
+
+    workerCount = std::max(1, workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        QThread* thread = new QThread();
+        thread->setObjectName(QString("QueryWorker-%1").arg(i));
+
+        QueryWorker* worker = new QueryWorker(this);
+        worker->moveToThread(thread);
+
+        connect(thread, &QThread::started, worker, &QueryWorker::run);
+        connect(worker, &QueryWorker::completed, this, &QueryWorkerPool::completed);
+
+        threads_.push_back(thread);
+        workers_.push_back(worker);
+        thread->start();
+    }
+
+    qDebug() << "Query worker pool started with" << workerCount << "workers";
+}
+
+void QueryWorkerPool::stop() {
+    if (!isRunning()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&queueMutex_);
+        stopping_ = true;
+        pending_.clear();
+    }
+    queueNotEmpty_.wakeAll();
+
+    // Workers finish their current query before exiting
+    for (QThread* thread : threads_) {
+        thread->wait();
+    }
+
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        delete workers_[i];
+        delete threads_[i];
+    }
+    workers_.clear();
+    threads_.clear();
+
+    qDebug() << "Query worker pool stopped";
+}
+
+bool QueryWorkerPool::isRunning() const {
+    return !threads_.empty();
+}
+
+bool QueryWorkerPool::submit(QueryJob job) {
+    {
+        QMutexLocker locker(&queueMutex_);
+        if (stopping_ || static_cast<int>(pending_.size()) >= maxQueueSize_) {
+            return false;
+        }
+        job.enqueuedAt = std::chrono::steady_clock::now();
+        pending_.push_back(std::move(job));
+        maxQueueDepth_ = std::max(maxQueueDepth_, static_cast<int>(pending_.size()));
+    }
+    queueNotEmpty_.wakeOne();
+    return true;
+}
+
+bool QueryWorkerPool::takeNext(QueryJob& job) {
+    QMutexLocker locker(&queueMutex_);
+    while (pending_.empty() && !stopping_) {
+        queueNotEmpty_.wait(&queueMutex_);
+    }
+
+    if (stopping_) {
+        return false;
+    }
+
+    job = std::move(pending_.front());
+    pending_.pop_front();
+    activeCount_++;
+    queueWait_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - job.enqueuedAt));
+    return true;
+}
+
+void QueryWorkerPool::markFinished() {
+    QMutexLocker locker(&queueMutex_);
+    activeCount_--;
+}
+
+void QueryWorkerPool::setMaxQueueSize(int maxQueueSize) {
+    QMutexLocker locker(&queueMutex_);
+    maxQueueSize_ = std::max(1, maxQueueSize);
+}
+
+int QueryWorkerPool::getMaxQueueSize() const {
+    QMutexLocker locker(&queueMutex_);
+    return maxQueueSize_;
+}
+
+int QueryWorkerPool::getWorkerCount() const {
+    return static_cast<int>(threads_.size());
+}
+
+int QueryWorkerPool::getQueueDepth() const {
+    QMutexLocker locker(&queueMutex_);
+    return static_cast<int>(pending_.size());
+}
+
+int QueryWorkerPool::getActiveCount() const {
+    QMutexLocker locker(&queueMutex_);
+    return activeCount_;
+}
+
+LatencySummary QueryWorkerPool::getQueueWait() const {
+    return queueWait_.summary();
+}
 
-    emit completed(result);
+int QueryWorkerPool::getMaxQueueDepth() const {
+    QMutexLocker locker(&queueMutex_);
+    return maxQueueDepth_;
 }
 
-#include "QueryEngine.moc"
\ No newline at end of file
+void QueryWorkerPool::resetStatistics() {
+    QMutexLocker locker(&queueMutex_);
+    maxQueueDepth_ = static_cast<int>(pending_.size());
+    queueWait_.reset();
+}
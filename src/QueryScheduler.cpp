@@ -0,0 +1,153 @@
+#include "QueryScheduler.h"
+#include <algorithm>
+
+QueryScheduler::QueryScheduler()
+    : nextGeneration_(1)
+    , missedRuns_(0)
+    , rng_(std::random_device{}())
+{
+}
+
+void QueryScheduler::schedule(const std::string& queryId, const QuerySchedule& schedule, Clock::time_point now) {
+    State state;
+    state.schedule = schedule;
+    state.schedule.interval = std::max(std::chrono::milliseconds(1), schedule.interval);
+    state.schedule.jitter = std::clamp(schedule.jitter, std::chrono::milliseconds(0), state.schedule.interval);
+
+    std::chrono::milliseconds phase = schedule.phase.count() < 0
+        ? derivePhase(queryId, state.schedule.interval)
+        : std::chrono::milliseconds(schedule.phase.count() % state.schedule.interval.count());
+
+    state.slot = now + phase;
+    state.generation = nextGeneration_++;
+
+    // Any entry left from a previous schedule is now stale and skipped on pop
+    State& stored = states_[queryId];
+    stored = state;
+    push(queryId, stored);
+    dropStaleEntries();
+}
+
+void QueryScheduler::unschedule(const std::string& queryId) {
+    states_.erase(queryId);
+    dropStaleEntries();
+}
+
+void QueryScheduler::clear() {
+    states_.clear();
+    heap_ = decltype(heap_)();
+}
+
+bool QueryScheduler::isScheduled(const std::string& queryId) const {
+    return states_.count(queryId) > 0;
+}
+
+bool QueryScheduler::setInterval(const std::string& queryId, std::chrono::milliseconds interval,
+                                 Clock::time_point now) {
+    auto it = states_.find(queryId);
+    if (it == states_.end()) {
+        return false;
+    }
+
+    State& state = it->second;
+    const auto previous = state.schedule.interval;
+    state.schedule.interval = std::max(std::chrono::milliseconds(1), interval);
+    state.schedule.jitter = std::min(state.schedule.jitter, state.schedule.interval);
+    if (state.schedule.interval == previous) {
+        return true;
+    }
+
+    // The queued slot is one old interval after the last one; re-space it with
+    // the new interval, but never into the past or further out than a full interval
+    Clock::time_point slot = std::clamp(state.slot - previous + state.schedule.interval,
+                                        now, now + state.schedule.interval);
+    if (slot != state.slot) {
+        state.slot = slot;
+        state.generation = nextGeneration_++;
+        push(queryId, state);
+        dropStaleEntries();
+    }
+    return true;
+}
+
+std::chrono::milliseconds QueryScheduler::getInterval(const std::string& queryId) const {
+    auto it = states_.find(queryId);
+    return it != states_.end() ? it->second.schedule.interval : std::chrono::milliseconds(0);
+}
+
+std::vector<std::string> QueryScheduler::takeDue(Clock::time_point now, std::vector<Clock::duration>* lateness) {
+    std::vector<std::string> due;
+
+    while (!heap_.empty() && heap_.top().due <= now) {
+        Entry entry = heap_.top();
+        heap_.pop();
+
+        auto it = states_.find(entry.queryId);
+        if (it == states_.end() || it->second.generation != entry.generation) {
+            continue;
+        }
+
+        State& state = it->second;
+        due.push_back(entry.queryId);
+        if (lateness) {
+            lateness->push_back(now - entry.due);
+        }
+
+        // Periods that have fully elapsed are skipped rather than run back to back
+        const auto interval = state.schedule.interval;
+        state.slot += interval;
+        while (state.slot + interval <= now) {
+            state.slot += interval;
+            missedRuns_++;
+        }
+
+        push(entry.queryId, state);
+    }
+
+    dropStaleEntries();
+    return due;
+}
+
+QueryScheduler::Clock::time_point QueryScheduler::nextDueTime() const {
+    return heap_.empty() ? Clock::time_point::max() : heap_.top().due;
+}
+
+size_t QueryScheduler::size() const {
+    return states_.size();
+}
+
+int QueryScheduler::getMissedRunCount() const {
+    return missedRuns_;
+}
+
+void QueryScheduler::push(const std::string& queryId, State& state) {
+    std::chrono::milliseconds offset(0);
+    if (state.schedule.jitter.count() > 0) {
+        std::uniform_int_distribution<long long> distribution(0, state.schedule.jitter.count());
+        offset = std::chrono::milliseconds(distribution(rng_));
+    }
+
+    heap_.push(Entry{state.slot + offset, queryId, state.generation});
+}
+
+void QueryScheduler::dropStaleEntries() {
+    // Keeps the heap top valid so nextDueTime() never reports an unscheduled query
+    while (!heap_.empty()) {
+        const Entry& top = heap_.top();
+        auto it = states_.find(top.queryId);
+        if (it != states_.end() && it->second.generation == top.generation) {
+            break;
+        }
+        heap_.pop();
+    }
+}
+
+std::chrono::milliseconds QueryScheduler::derivePhase(const std::string& queryId, std::chrono::milliseconds interval) const {
+    // FNV-1a gives each query a stable offset so equal intervals don't fire together
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : queryId) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return std::chrono::milliseconds(static_cast<long long>(hash % static_cast<uint64_t>(interval.count())));
+}
@@ -0,0 +1,111 @@
+#include "QueryTable.h"
+#include <algorithm>
+
+namespace {
+const std::vector<QueryTable::Entry> kNoRules;
+
+bool idLess(const QueryTable::Entry& entry, const std::string& id) {
+    return entry->id < id;
+}
+}
+
+QueryTable::QueryTable(std::vector<Entry> entries)
+    : entries_(std::move(entries))
+{
+    entries_.erase(std::remove(entries_.begin(), entries_.end(), nullptr), entries_.end());
+
+    // Stable, so of two entries with one id the later one is kept
+    std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+        return a->id < b->id;
+    });
+    auto last = std::unique(entries_.rbegin(), entries_.rend(), [](const Entry& a, const Entry& b) {
+        return a->id == b->id;
+    });
+    entries_.erase(entries_.begin(), last.base());
+
+    size_t capacity = 8;
+    while (capacity < entries_.size() * 2) {
+        capacity *= 2;
+    }
+    slots_.resize(capacity);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        Slot& slot = slots_[slotOf(entries_[i]->handle)];
+        slot.handle = entries_[i]->handle;
+        slot.index = static_cast<uint32_t>(i);
+    }
+
+    rules_.resize(entries_.size());
+    for (const auto& entry : entries_) {
+        if (!entry->isRule() || !entry->enabled) {
+            continue;
+        }
+        size_t source = indexOf(entry->source);
+        if (source < entries_.size() && entries_[source]->isSource()) {
+            rules_[source].push_back(entry);
+        }
+    }
+}
+
+const QueryConfig* QueryTable::find(QueryHandle handle) const {
+    size_t index = indexOf(handle);
+    return index < entries_.size() ? entries_[index].get() : nullptr;
+}
+
+const QueryConfig* QueryTable::find(const std::string& id) const {
+    size_t index = indexOf(id);
+    return index < entries_.size() ? entries_[index].get() : nullptr;
+}
+
+QueryTable::Entry QueryTable::entry(const std::string& id) const {
+    size_t index = indexOf(id);
+    return index < entries_.size() ? entries_[index] : nullptr;
+}
+
+const std::vector<QueryTable::Entry>& QueryTable::rulesOf(const QueryConfig& source) const {
+    size_t index = indexOf(source.handle);
+    return index < rules_.size() ? rules_[index] : kNoRules;
+}
+
+std::shared_ptr<const QueryTable> QueryTable::with(Entry query) const {
+    std::vector<Entry> entries = entries_;
+    entries.push_back(std::move(query));
+    return std::make_shared<const QueryTable>(std::move(entries));
+}
+
+std::shared_ptr<const QueryTable> QueryTable::without(const std::string& id) const {
+    std::vector<Entry> entries;
+    entries.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        if (entry->id != id) {
+            entries.push_back(entry);
+        }
+    }
+    return std::make_shared<const QueryTable>(std::move(entries));
+}
+
+size_t QueryTable::indexOf(const std::string& id) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), id, idLess);
+    if (it == entries_.end() || (*it)->id != id) {
+        return entries_.size();
+    }
+    return static_cast<size_t>(it - entries_.begin());
+}
+
+size_t QueryTable::indexOf(QueryHandle handle) const {
+    if (slots_.empty() || handle == InvalidQueryHandle) {
+        return entries_.size();
+    }
+    const Slot& slot = slots_[slotOf(handle)];
+    return slot.handle == handle ? slot.index : entries_.size();
+}
+
+size_t QueryTable::slotOf(QueryHandle handle) const {
+    // Fibonacci hashing spreads the interner's sequential ids over the slots;
+    // the table is at most half full, so a probe always ends at an empty slot
+    const size_t mask = slots_.size() - 1;
+    size_t slot = (static_cast<uint64_t>(handle) * 0x9E3779B97F4A7C15ull >> 32) & mask;
+    while (slots_[slot].handle != handle && slots_[slot].handle != InvalidQueryHandle) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
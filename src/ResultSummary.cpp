@@ -0,0 +1,33 @@
+#include "ResultSummary.h"
+#include "Fingerprint.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+ResultSummary ResultSummary::of(const pqxx::result& result) {
+    ResultSummary summary;
+    summary.rows = result.size();
+    summary.columns = static_cast<uint64_t>(result.columns());
+    summary.fingerprint = Fingerprint::ofResult(result);
+
+    if (!result.empty() && result.columns() > 0) {
+        const auto& field = result[0][0];
+        if (!field.is_null()) {
+            summary.firstValue = std::string(field.c_str(), field.size());
+            summary.firstCount = parseCount(*summary.firstValue);
+        }
+    }
+    return summary;
+}
+
+std::optional<int> ResultSummary::parseCount(const std::string& value) {
+    const char* begin = value.c_str();
+    char* end = nullptr;
+
+    errno = 0;
+    long parsed = std::strtol(begin, &end, 10);
+    if (end == begin || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) {
+        return std::nullopt;
+    }
+    return static_cast<int>(parsed);
+}
@@ -0,0 +1,735 @@
+#include "SnapshotRule.h"
+#include "Fingerprint.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+
+namespace {
+char foldCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string upper(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(start, end - start + 1);
+}
+
+// The whole of a NUL-terminated cell as a number; "12abc" is not one
+bool toNumber(const char* data, size_t length, double& value) {
+    if (length == 0) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(data, &end);
+    return end == data + length;
+}
+
+std::string formatNumber(double value) {
+    std::ostringstream out;
+    out << std::setprecision(15) << value;
+    return out.str();
+}
+
+struct Token {
+    enum Kind { End, Name, QuotedName, String, Number, Operator, Open, Close } kind;
+    std::string text;
+    size_t position;
+};
+
+bool tokenize(const std::string& input, std::vector<Token>& tokens, std::string& error) {
+    size_t i = 0;
+    while (i < input.size()) {
+        char c = input[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+            continue;
+        }
+
+        size_t start = i;
+        if (c == '(' || c == ')') {
+            tokens.push_back({c == '(' ? Token::Open : Token::Close, std::string(1, c), start});
+            ++i;
+        } else if (c == '\'' || c == '"') {
+            // SQL quoting: a doubled quote stands for itself
+            std::string text;
+            ++i;
+            while (true) {
+                if (i >= input.size()) {
+                    error = "unterminated " + std::string(c == '\'' ? "string" : "name") +
+                            " at position " + std::to_string(start);
+                    return false;
+                }
+                if (input[i] == c) {
+                    if (i + 1 < input.size() && input[i + 1] == c) {
+                        text += c;
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                text += input[i++];
+            }
+            tokens.push_back({c == '\'' ? Token::String : Token::QuotedName, text, start});
+        } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.' ||
+                   ((c == '-' || c == '+') && i + 1 < input.size() &&
+                    (std::isdigit(static_cast<unsigned char>(input[i + 1])) || input[i + 1] == '.'))) {
+            const char* begin = input.c_str() + i;
+            char* end = nullptr;
+            std::strtod(begin, &end);
+            if (end == begin) {
+                error = "malformed number at position " + std::to_string(start);
+                return false;
+            }
+            i += static_cast<size_t>(end - begin);
+            tokens.push_back({Token::Number, input.substr(start, i - start), start});
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            while (i < input.size() && (std::isalnum(static_cast<unsigned char>(input[i])) || input[i] == '_')) {
+                ++i;
+            }
+            tokens.push_back({Token::Name, input.substr(start, i - start), start});
+        } else if (c == '=' || c == '<' || c == '>' || c == '!') {
+            ++i;
+            if (i < input.size() && (input[i] == '=' || (c == '<' && input[i] == '>'))) {
+                ++i;
+            }
+            std::string op = input.substr(start, i - start);
+            if (op == "!") {
+                error = "unexpected '!' at position " + std::to_string(start);
+                return false;
+            }
+            tokens.push_back({Token::Operator, op, start});
+        } else {
+            error = "unexpected '" + std::string(1, c) + "' at position " + std::to_string(start);
+            return false;
+        }
+    }
+    tokens.push_back({Token::End, "", input.size()});
+    return true;
+}
+}
+
+// Recursive descent over the where= expression, emitting postfix instructions:
+//
+//   or         := and { OR and }
+//   and        := not { AND not }
+//   not        := NOT not | '(' or ')' | comparison
+//   comparison := operand IS [NOT] NULL | operand [NOT] [I]LIKE 'pattern' | operand op operand
+class SnapshotRule::Parser {
+public:
+    Parser(SnapshotRule& rule, std::vector<Token> tokens)
+        : rule_(rule), tokens_(std::move(tokens)), next_(0), depth_(0) {}
+
+    bool parse(std::string& error) {
+        if (peek().kind != Token::End && (!parseOr() || !expectEnd())) {
+            error = error_;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const Token& peek() const { return tokens_[next_]; }
+
+    bool isKeyword(const char* keyword) const {
+        return peek().kind == Token::Name && upper(peek().text) == keyword;
+    }
+
+    bool accept(const char* keyword) {
+        if (isKeyword(keyword)) {
+            ++next_;
+            return true;
+        }
+        return false;
+    }
+
+    bool fail(const std::string& expected) {
+        const Token& token = peek();
+        error_ = "expected " + expected + (token.kind == Token::End
+            ? " at the end" : " before '" + token.text + "' at position " + std::to_string(token.position));
+        return false;
+    }
+
+    bool expectEnd() {
+        return peek().kind == Token::End || fail("AND, OR or the end");
+    }
+
+    void emit(Instruction instruction) {
+        // Tests push a result and AND/OR pop two for one; NOT works in place
+        if (instruction.op == Op::And || instruction.op == Op::Or) {
+            --depth_;
+        } else if (instruction.op != Op::Not) {
+            rule_.stackDepth_ = std::max(rule_.stackDepth_, ++depth_);
+        }
+        rule_.program_.push_back(std::move(instruction));
+    }
+
+    void emit(Op op) {
+        Instruction instruction;
+        instruction.op = op;
+        emit(std::move(instruction));
+    }
+
+    bool parseOr() {
+        if (!parseAnd()) {
+            return false;
+        }
+        while (accept("OR")) {
+            if (!parseAnd()) {
+                return false;
+            }
+            emit(Op::Or);
+        }
+        return true;
+    }
+
+    bool parseAnd() {
+        if (!parseNot()) {
+            return false;
+        }
+        while (accept("AND")) {
+            if (!parseNot()) {
+                return false;
+            }
+            emit(Op::And);
+        }
+        return true;
+    }
+
+    bool parseNot() {
+        if (accept("NOT")) {
+            if (!parseNot()) {
+                return false;
+            }
+            emit(Op::Not);
+            return true;
+        }
+
+        if (peek().kind == Token::Open) {
+            ++next_;
+            if (!parseOr()) {
+                return false;
+            }
+            if (peek().kind != Token::Close) {
+                return fail("')'");
+            }
+            ++next_;
+            return true;
+        }
+        return parseComparison();
+    }
+
+    bool parseOperand(Operand& operand) {
+        const Token& token = peek();
+        if (token.kind == Token::Name && !isReserved(token.text)) {
+            operand.column = rule_.columnIndex(token.text);
+        } else if (token.kind == Token::QuotedName) {
+            operand.column = rule_.columnIndex(token.text);
+        } else if (token.kind == Token::String) {
+            operand.text = token.text;
+        } else if (token.kind == Token::Number) {
+            operand.text = token.text;
+            operand.number = std::strtod(token.text.c_str(), nullptr);
+            operand.numeric = true;
+        } else {
+            return fail("a column name or a value");
+        }
+        ++next_;
+        return true;
+    }
+
+    bool parseComparison() {
+        Instruction instruction;
+        if (!parseOperand(instruction.left)) {
+            return false;
+        }
+
+        if (accept("IS")) {
+            bool negate = accept("NOT");
+            if (!accept("NULL")) {
+                return fail("NULL");
+            }
+            instruction.op = Op::IsNull;
+            emit(std::move(instruction));
+            if (negate) {
+                emit(Op::Not);
+            }
+            return true;
+        }
+
+        bool negate = accept("NOT");
+        if (isKeyword("LIKE") || isKeyword("ILIKE")) {
+            instruction.caseInsensitive = isKeyword("ILIKE");
+            ++next_;
+            if (peek().kind != Token::String) {
+                return fail("a quoted pattern");
+            }
+            instruction.op = Op::Like;
+            instruction.pattern = compilePattern(peek().text, instruction.caseInsensitive);
+            ++next_;
+            emit(std::move(instruction));
+            if (negate) {
+                emit(Op::Not);
+            }
+            return true;
+        }
+        if (negate) {
+            return fail("LIKE or ILIKE");
+        }
+
+        if (peek().kind != Token::Operator) {
+            return fail("a comparison");
+        }
+        const std::string& op = peek().text;
+        if (op == "=") {
+            instruction.comparison = Comparison::Equal;
+        } else if (op == "!=" || op == "<>") {
+            instruction.comparison = Comparison::NotEqual;
+        } else if (op == "<") {
+            instruction.comparison = Comparison::Less;
+        } else if (op == "<=") {
+            instruction.comparison = Comparison::LessEqual;
+        } else if (op == ">") {
+            instruction.comparison = Comparison::Greater;
+        } else if (op == ">=") {
+            instruction.comparison = Comparison::GreaterEqual;
+        } else {
+            return fail("a comparison");
+        }
+        ++next_;
+
+        if (!parseOperand(instruction.right)) {
+            return false;
+        }
+        instruction.op = Op::Compare;
+        emit(std::move(instruction));
+        return true;
+    }
+
+    static bool isReserved(const std::string& name) {
+        std::string word = upper(name);
+        return word == "AND" || word == "OR" || word == "NOT" || word == "IS" ||
+               word == "NULL" || word == "LIKE" || word == "ILIKE";
+    }
+
+    static std::vector<PatternToken> compilePattern(const std::string& pattern, bool caseInsensitive) {
+        std::vector<PatternToken> tokens;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            char c = pattern[i];
+            if (c == '\\' && i + 1 < pattern.size()) {
+                c = pattern[++i];
+                tokens.push_back({PatternToken::Byte, caseInsensitive ? foldCase(c) : c});
+            } else if (c == '%') {
+                if (tokens.empty() || tokens.back().kind != PatternToken::AnyRun) {
+                    tokens.push_back({PatternToken::AnyRun, 0});
+                }
+            } else if (c == '_') {
+                tokens.push_back({PatternToken::AnyByte, 0});
+            } else {
+                tokens.push_back({PatternToken::Byte, caseInsensitive ? foldCase(c) : c});
+            }
+        }
+        return tokens;
+    }
+
+    SnapshotRule& rule_;
+    std::vector<Token> tokens_;
+    size_t next_;
+    size_t depth_;
+    std::string error_;
+};
+
+std::shared_ptr<const SnapshotRule> SnapshotRule::compile(const std::string& where, const std::string& message,
+                                                          const std::string& aggregate, std::string& error) {
+    std::shared_ptr<SnapshotRule> rule(new SnapshotRule());
+
+    std::vector<Token> tokens;
+    if (!tokenize(where, tokens, error)) {
+        error = "where: " + error;
+        return nullptr;
+    }
+    Parser parser(*rule, std::move(tokens));
+    if (!parser.parse(error)) {
+        error = "where: " + error;
+        return nullptr;
+    }
+
+    if (!rule->compileMessage(message, error)) {
+        error = "message: " + error;
+        return nullptr;
+    }
+
+    if (!trim(aggregate).empty()) {
+        std::string function;
+        std::string column;
+        if (!parseAggregate(aggregate, function, column, error)) {
+            return nullptr;
+        }
+
+        if (function == "count") {
+            rule->aggregate_ = column == "*" ? Aggregate::Count : Aggregate::CountColumn;
+        } else if (function == "sum") {
+            rule->aggregate_ = Aggregate::Sum;
+        } else if (function == "min") {
+            rule->aggregate_ = Aggregate::Min;
+        } else if (function == "max") {
+            rule->aggregate_ = Aggregate::Max;
+        } else {
+            rule->aggregate_ = Aggregate::Avg;
+        }
+
+        if (column != "*") {
+            if (column.front() == '"') {
+                column = column.substr(1, column.size() - 2);
+            }
+            rule->aggregateColumn_ = rule->columnIndex(column);
+        }
+    }
+
+    return rule;
+}
+
+bool SnapshotRule::parseAggregate(const std::string& spec, std::string& function, std::string& column,
+                                  std::string& error) {
+    // count, count(*), or function(column) with a plain or double-quoted column name
+    std::string text = trim(spec);
+    function = text;
+    column.clear();
+    size_t open = text.find('(');
+    if (open != std::string::npos) {
+        if (text.back() != ')') {
+            error = "malformed aggregate '" + spec + "'";
+            return false;
+        }
+        function = trim(text.substr(0, open));
+        column = trim(text.substr(open + 1, text.size() - open - 2));
+    }
+    std::transform(function.begin(), function.end(), function.begin(), ::tolower);
+
+    if (function == "count" && (column.empty() || column == "*")) {
+        column = "*";
+    } else if (function != "count" && function != "sum" && function != "min" &&
+               function != "max" && function != "avg") {
+        error = "unknown aggregate function '" + function + "'";
+        return false;
+    } else if (column.empty()) {
+        error = "aggregate " + function + " needs a column";
+        return false;
+    } else if (column.size() >= 2 && column.front() == '"' && column.back() == '"') {
+        if (column.find('"', 1) != column.size() - 1) {
+            error = "malformed column name " + column;
+            return false;
+        }
+    } else {
+        bool identifier = std::isalpha(static_cast<unsigned char>(column[0])) || column[0] == '_';
+        for (char c : column) {
+            identifier = identifier && (std::isalnum(static_cast<unsigned char>(c)) || c == '_');
+        }
+        if (!identifier) {
+            error = "column '" + column + "' is not a plain name; double-quote it";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SnapshotRule::evaluate(const pqxx::result& snapshot, ResultSummary& summary, std::string& error) const {
+    // Columns are looked up by name on every snapshot, since the source's SQL may change under the rule
+    std::vector<pqxx::row::size_type> columns(columns_.size());
+    const auto columnCount = snapshot.columns();
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        pqxx::row::size_type found = columnCount;
+        for (pqxx::row::size_type c = 0; c < columnCount; ++c) {
+            if (columns_[i] == snapshot.column_name(c)) {
+                found = c;
+                break;
+            }
+        }
+        if (found == columnCount) {
+            error = "source has no column '" + columns_[i] + "'";
+            return false;
+        }
+        columns[i] = found;
+    }
+
+    std::vector<char> stack(std::max<size_t>(1, stackDepth_));
+    std::vector<pqxx::result::size_type> matched;
+    const auto rowCount = snapshot.size();
+    for (pqxx::result::size_type r = 0; r < rowCount; ++r) {
+        if (program_.empty() || matches(snapshot[r], columns, stack)) {
+            matched.push_back(r);
+        }
+    }
+
+    summary = ResultSummary();
+    if (aggregate_ != Aggregate::None) {
+        aggregateOver(snapshot, matched, columns, summary);
+        return true;
+    }
+
+    summary.rows = matched.size();
+    summary.columns = static_cast<uint64_t>(columnCount);
+    summary.fingerprint = Fingerprint::ofRows(snapshot, matched);
+
+    if (!matched.empty()) {
+        const pqxx::row row = snapshot[matched.front()];
+        if (!message_.empty()) {
+            summary.firstValue = render(row, columns);
+        } else if (columnCount > 0 && !row[0].is_null()) {
+            summary.firstValue = std::string(row[0].c_str(), row[0].size());
+        }
+        if (summary.firstValue) {
+            summary.firstCount = ResultSummary::parseCount(*summary.firstValue);
+        }
+    }
+    return true;
+}
+
+int SnapshotRule::columnIndex(const std::string& name) {
+    auto it = std::find(columns_.begin(), columns_.end(), name);
+    if (it != columns_.end()) {
+        return static_cast<int>(it - columns_.begin());
+    }
+    columns_.push_back(name);
+    return static_cast<int>(columns_.size() - 1);
+}
+
+bool SnapshotRule::compileMessage(const std::string& message, std::string& error) {
+    // {column} is replaced by the cell; {{ and }} stand for the braces themselves
+    std::string literal;
+    for (size_t i = 0; i < message.size(); ++i) {
+        char c = message[i];
+        if ((c == '{' || c == '}') && i + 1 < message.size() && message[i + 1] == c) {
+            literal += c;
+            ++i;
+        } else if (c == '{') {
+            size_t close = message.find('}', i + 1);
+            if (close == std::string::npos) {
+                error = "unterminated '{' at position " + std::to_string(i);
+                return false;
+            }
+            std::string name = trim(message.substr(i + 1, close - i - 1));
+            if (name.empty()) {
+                error = "empty column name at position " + std::to_string(i);
+                return false;
+            }
+            if (!literal.empty()) {
+                message_.push_back({literal, -1});
+                literal.clear();
+            }
+            message_.push_back({"", columnIndex(name)});
+            i = close;
+        } else {
+            literal += c;
+        }
+    }
+    if (!literal.empty()) {
+        message_.push_back({literal, -1});
+    }
+    return true;
+}
+
+bool SnapshotRule::matches(const pqxx::row& row, const std::vector<pqxx::row::size_type>& columns,
+                           std::vector<char>& stack) const {
+    size_t top = 0;
+    for (const auto& instruction : program_) {
+        switch (instruction.op) {
+        case Op::Compare:
+            stack[top++] = compare(instruction, row, columns);
+            break;
+        case Op::IsNull:
+            stack[top++] = instruction.left.column < 0 ? false
+                : row[columns[instruction.left.column]].is_null();
+            break;
+        case Op::Like:
+            if (instruction.left.column < 0) {
+                stack[top++] = like(instruction.left.text.data(), instruction.left.text.size(),
+                                    instruction.pattern, instruction.caseInsensitive);
+            } else {
+                const auto field = row[columns[instruction.left.column]];
+                stack[top++] = !field.is_null() &&
+                               like(field.c_str(), field.size(), instruction.pattern, instruction.caseInsensitive);
+            }
+            break;
+        case Op::And:
+            --top;
+            stack[top - 1] = stack[top - 1] && stack[top];
+            break;
+        case Op::Or:
+            --top;
+            stack[top - 1] = stack[top - 1] || stack[top];
+            break;
+        case Op::Not:
+            stack[top - 1] = !stack[top - 1];
+            break;
+        }
+    }
+    return stack[0] != 0;
+}
+
+bool SnapshotRule::compare(const Instruction& instruction, const pqxx::row& row,
+                           const std::vector<pqxx::row::size_type>& columns) const {
+    // A NULL cell compares false either way round, as NULL = x is never true in SQL
+    struct Value {
+        const char* data;
+        size_t size;
+    };
+    auto valueOf = [&](const Operand& operand, Value& value) {
+        if (operand.column < 0) {
+            value = {operand.text.c_str(), operand.text.size()};
+            return true;
+        }
+        const auto field = row[columns[operand.column]];
+        if (field.is_null()) {
+            return false;
+        }
+        value = {field.c_str(), field.size()};
+        return true;
+    };
+
+    const Operand& left = instruction.left;
+    const Operand& right = instruction.right;
+    Value leftValue;
+    Value rightValue;
+    if (!valueOf(left, leftValue) || !valueOf(right, rightValue)) {
+        return false;
+    }
+
+    // Numbers compare as numbers when either side is a numeric literal, or both cells read as one
+    int order;
+    double leftNumber = left.number;
+    double rightNumber = right.number;
+    bool leftIsNumber = left.numeric || (left.column >= 0 && toNumber(leftValue.data, leftValue.size, leftNumber));
+    bool rightIsNumber = right.numeric || (right.column >= 0 && toNumber(rightValue.data, rightValue.size, rightNumber));
+    if (left.numeric || right.numeric) {
+        if (!leftIsNumber || !rightIsNumber) {
+            return false;
+        }
+        order = leftNumber < rightNumber ? -1 : (leftNumber > rightNumber ? 1 : 0);
+    } else if (left.column >= 0 && right.column >= 0 && leftIsNumber && rightIsNumber) {
+        order = leftNumber < rightNumber ? -1 : (leftNumber > rightNumber ? 1 : 0);
+    } else {
+        order = std::string_view(leftValue.data, leftValue.size).compare(
+            std::string_view(rightValue.data, rightValue.size));
+    }
+
+    switch (instruction.comparison) {
+    case Comparison::Equal: return order == 0;
+    case Comparison::NotEqual: return order != 0;
+    case Comparison::Less: return order < 0;
+    case Comparison::LessEqual: return order <= 0;
+    case Comparison::Greater: return order > 0;
+    case Comparison::GreaterEqual: return order >= 0;
+    }
+    return false;
+}
+
+bool SnapshotRule::like(const char* data, size_t length, const std::vector<PatternToken>& pattern,
+                        bool caseInsensitive) {
+    // Greedy wildcard match, backtracking only to the most recent '%'
+    size_t text = 0;
+    size_t token = 0;
+    size_t starToken = std::string::npos;
+    size_t starText = 0;
+    while (text < length) {
+        if (token < pattern.size() && pattern[token].kind != PatternToken::AnyRun &&
+            (pattern[token].kind == PatternToken::AnyByte ||
+             pattern[token].byte == (caseInsensitive ? foldCase(data[text]) : data[text]))) {
+            ++token;
+            ++text;
+        } else if (token < pattern.size() && pattern[token].kind == PatternToken::AnyRun) {
+            starToken = token++;
+            starText = text;
+        } else if (starToken != std::string::npos) {
+            token = starToken + 1;
+            text = ++starText;
+        } else {
+            return false;
+        }
+    }
+    while (token < pattern.size() && pattern[token].kind == PatternToken::AnyRun) {
+        ++token;
+    }
+    return token == pattern.size();
+}
+
+std::string SnapshotRule::render(const pqxx::row& row, const std::vector<pqxx::row::size_type>& columns) const {
+    std::string text;
+    for (const auto& segment : message_) {
+        if (segment.column < 0) {
+            text += segment.text;
+            continue;
+        }
+        const auto field = row[columns[segment.column]];
+        if (!field.is_null()) {
+            text.append(field.c_str(), field.size());
+        }
+    }
+    return text;
+}
+
+void SnapshotRule::aggregateOver(const pqxx::result& snapshot, const std::vector<pqxx::result::size_type>& rows,
+                                 const std::vector<pqxx::row::size_type>& columns, ResultSummary& summary) const {
+    // One row holding the value, as SELECT <aggregate> FROM (...) would return; NULLs
+    // and cells that are not numbers are skipped, and no values at all is NULL
+    summary.rows = 1;
+    summary.columns = 1;
+
+    if (aggregate_ == Aggregate::Count) {
+        summary.firstValue = std::to_string(rows.size());
+    } else {
+        uint64_t count = 0;
+        double total = 0.0;
+        double lowest = 0.0;
+        double highest = 0.0;
+        for (auto index : rows) {
+            const auto field = snapshot[index][columns[aggregateColumn_]];
+            if (field.is_null()) {
+                continue;
+            }
+            if (aggregate_ == Aggregate::CountColumn) {
+                ++count;
+                continue;
+            }
+            double value;
+            if (!toNumber(field.c_str(), field.size(), value)) {
+                continue;
+            }
+            lowest = count == 0 ? value : std::min(lowest, value);
+            highest = count == 0 ? value : std::max(highest, value);
+            total += value;
+            ++count;
+        }
+
+        if (aggregate_ == Aggregate::CountColumn) {
+            summary.firstValue = std::to_string(count);
+        } else if (count > 0) {
+            switch (aggregate_) {
+            case Aggregate::Sum: summary.firstValue = formatNumber(total); break;
+            case Aggregate::Min: summary.firstValue = formatNumber(lowest); break;
+            case Aggregate::Max: summary.firstValue = formatNumber(highest); break;
+            case Aggregate::Avg: summary.firstValue = formatNumber(total / static_cast<double>(count)); break;
+            default: break;
+            }
+        }
+    }
+
+    Fingerprint fingerprint;
+    if (summary.firstValue) {
+        fingerprint.updateField(*summary.firstValue);
+        summary.firstCount = ResultSummary::parseCount(*summary.firstValue);
+    }
+    summary.fingerprint = fingerprint.digest();
+}
@@ -0,0 +1,60 @@
+#include "StringInterner.h"
+#include <mutex>
+
+uint32_t StringInterner::intern(std::string_view value) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(value);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // Another thread may have added it between the two locks
+    auto it = ids_.find(value);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(strings_.size());
+    strings_.emplace_back(value);
+    ids_.emplace(std::string_view(strings_.back()), id);
+    return id;
+}
+
+uint32_t StringInterner::find(std::string_view value) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(value);
+    return it != ids_.end() ? it->second : InvalidId;
+}
+
+InternedString StringInterner::handle(std::string_view value) {
+    return handleOf(intern(value));
+}
+
+InternedString StringInterner::handleOf(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id >= strings_.size()) {
+        return InternedString();
+    }
+    return InternedString(&strings_[id], id, this);
+}
+
+InternedString StringInterner::adopt(const InternedString& value) {
+    if (value.table() == this) {
+        return value;
+    }
+    return handle(value.view());
+}
+
+std::string_view StringInterner::view(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return id < strings_.size() ? std::string_view(strings_[id]) : std::string_view();
+}
+
+size_t StringInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return strings_.size();
+}
@@ -0,0 +1,188 @@
+#include "WatermarkStore.h"
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace {
+void appendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+        case '\\': out += "\\\\"; break;
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        default: out += c; break;
+        }
+    }
+}
+
+bool unescape(const std::string& field, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] != '\\') {
+            out += field[i];
+            continue;
+        }
+        if (++i == field.size()) {
+            return false;
+        }
+        switch (field[i]) {
+        case '\\': out += '\\'; break;
+        case 't': out += '\t'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        default: return false;
+        }
+    }
+    return true;
+}
+}
+
+WatermarkStore::WatermarkStore(const std::string& filePath)
+    : filePath_(filePath)
+    , dirty_(false)
+{
+}
+
+bool WatermarkStore::load() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    dirty_ = false;
+
+    if (filePath_.empty()) {
+        return true;
+    }
+
+    std::ifstream file(filePath_);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::string runKey;
+        std::string column;
+        std::string value;
+        if (!parseLine(line, runKey, column, value)) {
+            lastError_ = filePath_ + ": malformed line " + std::to_string(lineNumber);
+            continue;
+        }
+        entries_[runKey] = Entry{column, value};
+    }
+    return true;
+}
+
+bool WatermarkStore::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_ || filePath_.empty()) {
+        return true;
+    }
+
+    // Written beside the target and renamed over it, so readers never see half a file
+    std::string tempPath = filePath_ + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) {
+            lastError_ = "Cannot write " + tempPath;
+            return false;
+        }
+
+        file << "# Query watermarks: run key, cursor column, last value\n";
+        for (const auto& pair : entries_) {
+            file << formatLine(pair.first, pair.second.column, pair.second.value) << '\n';
+        }
+
+        file.flush();
+        if (!file) {
+            lastError_ = "Failed writing " + tempPath;
+            return false;
+        }
+    }
+
+    if (std::rename(tempPath.c_str(), filePath_.c_str()) != 0) {
+        lastError_ = "Cannot replace " + filePath_;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    dirty_ = false;
+    return true;
+}
+
+std::optional<std::string> WatermarkStore::get(const std::string& runKey, const std::string& column) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(runKey);
+    if (it == entries_.end() || it->second.column != column) {
+        return std::nullopt;
+    }
+    return it->second.value;
+}
+
+void WatermarkStore::set(const std::string& runKey, const std::string& column, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[runKey];
+    if (entry.column != column || entry.value != value) {
+        entry.column = column;
+        entry.value = value;
+        dirty_ = true;
+    }
+}
+
+void WatermarkStore::remove(const std::string& runKey) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.erase(runKey) > 0) {
+        dirty_ = true;
+    }
+}
+
+bool WatermarkStore::isDirty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirty_;
+}
+
+size_t WatermarkStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::string WatermarkStore::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+std::string WatermarkStore::formatLine(const std::string& runKey, const std::string& column, const std::string& value) {
+    std::string line;
+    appendEscaped(line, runKey);
+    line += '\t';
+    appendEscaped(line, column);
+    line += '\t';
+    appendEscaped(line, value);
+    return line;
+}
+
+bool WatermarkStore::parseLine(const std::string& line, std::string& runKey, std::string& column, std::string& value) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t tab = line.find('\t', start);
+        if (tab == std::string::npos) {
+            fields.push_back(line.substr(start));
+            break;
+        }
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+
+    // Escaping keeps tabs out of fields, so any other count means a damaged line
+    if (fields.size() != 3) {
+        return false;
+    }
+    return unescape(fields[0], runKey) && !runKey.empty() &&
+           unescape(fields[1], column) && unescape(fields[2], value);
+}
@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+#include "AlertSystem.h"
+#include "AlertDispatcher.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+// Fills the store to its retention limit with distinct alerts
+void fill(AlertSystem& alerts, int count) {
+    alerts.setMaxAlerts(count);
+    for (int i = 0; i < count; ++i) {
+        alerts.addAlert(AlertType::WARNING, "Prefill " + std::to_string(i), "Row count over threshold",
+                        "BenchmarkQuery");
+    }
+}
+
+// Holds its first batch until released, like a receiver that stopped answering
+class StalledSink : public AlertSink {
+public:
+    explicit StalledSink(const std::atomic<bool>& released) : released_(released) {}
+
+    std::string name() const override { return "stalled"; }
+
+    Delivery deliver(const std::vector<SinkAlert>&, std::string&) override {
+        while (!released_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return Delivery::Delivered;
+    }
+
+private:
+    const std::atomic<bool>& released_;
+};
+}
+
+// New alerts against a full store: duplicate lookup, append and eviction
+static void BM_AddAlertUnique(benchmark::State& state) {
+    AlertSystem alerts;
+    fill(alerts, static_cast<int>(state.range(0)));
+
+    int64_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(alerts.addAlert(AlertType::WARNING, "Alert " + std::to_string(next++),
+                                                 "Row count over threshold", "BenchmarkQuery"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddAlertUnique)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// The same alert again within the window, rejected as a duplicate
+static void BM_AddAlertDuplicate(benchmark::State& state) {
+    AlertSystem alerts;
+    fill(alerts, static_cast<int>(state.range(0)));
+    alerts.addAlert(AlertType::CRITICAL, "Repeated", "Same rows as before", "BenchmarkQuery");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(alerts.addAlert(AlertType::CRITICAL, "Repeated", "Same rows as before",
+                                                 "BenchmarkQuery"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddAlertDuplicate)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Every alert distinct, with duplicate detection switched off, for comparison
+static void BM_AddAlertNoDuplicateDetection(benchmark::State& state) {
+    AlertSystem alerts;
+    alerts.setDuplicateDetectionEnabled(false);
+    fill(alerts, static_cast<int>(state.range(0)));
+
+    int64_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(alerts.addAlert(AlertType::WARNING, "Alert " + std::to_string(next++),
+                                                 "Row count over threshold", "BenchmarkQuery"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddAlertNoDuplicateDetection)->Arg(1000)->Arg(100000);
+
+// The newest alerts out of a full store of 10000
+static void BM_GetRecentAlerts(benchmark::State& state) {
+    AlertSystem alerts;
+    fill(alerts, 10000);
+    const int maxCount = static_cast<int>(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<Alert> recent = alerts.getRecentAlerts(maxCount);
+        benchmark::DoNotOptimize(recent.data());
+    }
+    state.SetItemsProcessed(state.iterations() * maxCount);
+}
+BENCHMARK(BM_GetRecentAlerts)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+// New alerts with sinks attached that have stopped taking them: once their
+// queues fill, every alert is dropped for them without waiting
+static void BM_AddAlertStalledSinks(benchmark::State& state) {
+    AlertSystem alerts;
+    alerts.setDuplicateDetectionEnabled(false);
+    fill(alerts, 1000);
+
+    std::atomic<bool> released(false);
+    AlertDispatcher dispatcher;
+    for (int i = 0; i < state.range(0); ++i) {
+        dispatcher.addSink(std::make_unique<StalledSink>(released));
+    }
+    dispatcher.start();
+    alerts.setDispatcher(&dispatcher);
+
+    int64_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(alerts.addAlert(AlertType::WARNING, "Alert " + std::to_string(next++),
+                                                 "Row count over threshold", "BenchmarkQuery"));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    alerts.setDispatcher(nullptr);
+    released = true;
+    dispatcher.stop(0);
+}
+BENCHMARK(BM_AddAlertStalledSinks)->Arg(1)->Arg(3);
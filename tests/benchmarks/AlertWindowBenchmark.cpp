@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include "AlertWindow.h"
+#include <QApplication>
+#include <QLoggingCategory>
+#include <string>
+
+// Bursts of alerts into the window, including the coalesced list refresh
+// that shows them; runs on the offscreen platform under ctest
+static void BM_AlertWindowBulkInsert(benchmark::State& state) {
+    AlertWindow window;
+    window.setMaxRefreshRate(0);
+    window.show();
+
+    // Handles from another table are adopted by the window's own store, as engine alerts are
+    StringInterner strings;
+    InternedString source = strings.handle("BenchmarkQuery");
+
+    const int burst = static_cast<int>(state.range(0));
+    int64_t next = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < burst; ++i) {
+            Alert alert;
+            alert.type = i % 3 == 0 ? AlertType::CRITICAL : AlertType::WARNING;
+            alert.title = strings.handle("Alert " + std::to_string(next++));
+            alert.message = "Row count over threshold";
+            alert.querySource = source;
+            window.addAlertToUI(alert);
+        }
+        QCoreApplication::processEvents();
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+    state.counters["flushes"] = window.getFlushCount();
+}
+BENCHMARK(BM_AlertWindowBulkInsert)->Arg(1)->Arg(100)->Arg(1000);
+
+int main(int argc, char** argv) {
+    QApplication app(argc, argv);
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
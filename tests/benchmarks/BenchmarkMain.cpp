@@ -0,0 +1,18 @@
+#include <benchmark/benchmark.h>
+#include <QCoreApplication>
+#include <QLoggingCategory>
+
+// QueryEngine's timers want an application object, and per-alert debug
+// output would otherwise dominate the timings
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include "Fingerprint.h"
+#include <string>
+#include <vector>
+
+namespace {
+const int kColumns = 8;
+
+// A pqxx::result can't be built without a server, so the benchmark feeds
+// Fingerprint the same sequence Fingerprint::ofResult does for a result of
+// this shape
+std::vector<std::string> syntheticFields(int rows) {
+    std::vector<std::string> fields;
+    fields.reserve(static_cast<size_t>(rows) * kColumns);
+    for (int row = 0; row < rows; ++row) {
+        fields.push_back(std::to_string(100000 + row));
+        fields.push_back("user_" + std::to_string(row % 97));
+        fields.push_back("2024-01-01 12:00:00.000000+00");
+        fields.push_back("192.168.1." + std::to_string(row % 255));
+        fields.push_back("failed_login");
+        fields.push_back(std::to_string(row * 7 % 1000));
+        fields.push_back("t");
+        fields.push_back("Authentication failed for user from a remote host");
+    }
+    return fields;
+}
+}
+
+static void BM_ResultFingerprint(benchmark::State& state) {
+    const int rows = static_cast<int>(state.range(0));
+    std::vector<std::string> fields = syntheticFields(rows);
+
+    size_t bytes = 0;
+    for (const auto& field : fields) {
+        bytes += field.size();
+    }
+
+    for (auto _ : state) {
+        Fingerprint fingerprint;
+        fingerprint.updateValue(static_cast<uint64_t>(rows));
+        fingerprint.updateValue(static_cast<uint64_t>(kColumns));
+        for (const auto& field : fields) {
+            fingerprint.updateField(field.data(), field.size());
+        }
+        benchmark::DoNotOptimize(fingerprint.digest());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_ResultFingerprint)->Arg(1)->Arg(100)->Arg(10000);
+
+static void BM_FingerprintBytes(benchmark::State& state) {
+    std::string data(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _ : state) {
+        Fingerprint fingerprint;
+        fingerprint.update(data.data(), data.size());
+        benchmark::DoNotOptimize(fingerprint.digest());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FingerprintBytes)->Arg(16)->Arg(1024)->Arg(1 << 20);
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include "KeywordMatcher.h"
+#include "AlertSystem.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+namespace {
+// A pg_stat_activity.query-like cell with no keyword in it, the common and slowest case
+std::string wideText(size_t length) {
+    const std::string sql = "SELECT u.id, u.name, o.total FROM users u JOIN orders o ON o.user_id = u.id "
+                            "WHERE o.created_at > NOW() - INTERVAL '1 hour' ORDER BY o.total DESC; ";
+    std::string text;
+    while (text.size() < length) {
+        text += sql;
+    }
+    text.resize(length);
+    return text;
+}
+
+KeywordMatcher defaultMatcher() {
+    KeywordMatcher matcher;
+    for (const auto& keyword : KeywordMatcher::splitList(AlertSystem::DEFAULT_CRITICAL_KEYWORDS)) {
+        matcher.add(keyword, 0);
+    }
+    for (const auto& keyword : KeywordMatcher::splitList(AlertSystem::DEFAULT_WARNING_KEYWORDS)) {
+        matcher.add(keyword, 1);
+    }
+    matcher.compile();
+    return matcher;
+}
+}
+
+static void BM_KeywordMatcherScan(benchmark::State& state) {
+    KeywordMatcher matcher = defaultMatcher();
+    std::string text = wideText(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matcher.scan(text));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KeywordMatcherScan)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+// What classifyAlert did per cell before: lowercase a copy, then one find per keyword
+static void BM_LowercaseAndFind(benchmark::State& state) {
+    const char* keywords[] = {"error", "fail", "critical", "breach", "warning", "alert", "unusual"};
+    std::string text = wideText(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::string value = text;
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        bool found = false;
+        for (const char* keyword : keywords) {
+            found = found || value.find(keyword) != std::string::npos;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LowercaseAndFind)->Arg(64)->Arg(4096)->Arg(1 << 20);
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include "QueryEngine.h"
+#include "DatabaseManager.h"
+#include "AlertSystem.h"
+#include <sstream>
+#include <string>
+
+namespace {
+// A queries.conf with the given number of sections, using most keys
+std::string syntheticQueriesConf(int queries) {
+    std::ostringstream conf;
+    conf << "# Generated for benchmarking\n";
+    for (int i = 0; i < queries; ++i) {
+        conf << "\n[Query" << i << "]\n"
+             << "name=Synthetic query " << i << "\n"
+             << "sql=SELECT id, message FROM events WHERE severity > " << i % 5
+             << " AND created_at > NOW() - INTERVAL '1 minute'\n"
+             << "alert_type=" << (i % 3 == 0 ? "critical" : i % 3 == 1 ? "warning" : "info") << "\n"
+             << "threshold=" << i % 10 << "\n"
+             << "enabled=true\n"
+             << "timeout=5\n"
+             << "interval=" << (i % 4 + 1) << "s\n"
+             << "jitter=100ms\n";
+    }
+    return conf.str();
+}
+}
+
+// Parsing and statement registration; the database is never connected
+static void BM_LoadQueriesFromString(benchmark::State& state) {
+    DatabaseManager database;
+    AlertSystem alerts;
+    QueryEngine engine(&database, &alerts);
+    std::string conf = syntheticQueriesConf(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.loadQueriesFromString(conf));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * conf.size()));
+}
+BENCHMARK(BM_LoadQueriesFromString)->Arg(10)->Arg(100)->Arg(1000);
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include "QueryTable.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+// Handles as the engine's interner hands them out: sequential, with titles
+// and run keys interned in between
+std::shared_ptr<const QueryTable> syntheticTable(int queries) {
+    std::vector<QueryTable::Entry> entries;
+    entries.reserve(static_cast<size_t>(queries));
+    for (int i = 0; i < queries; ++i) {
+        QueryConfig query("Query" + std::to_string(i), "Synthetic query " + std::to_string(i),
+                          "SELECT 1");
+        query.handle = static_cast<QueryHandle>(i * 3);
+        entries.push_back(std::make_shared<const QueryConfig>(std::move(query)));
+    }
+    return std::make_shared<const QueryTable>(std::move(entries));
+}
+}
+
+// Every result: the table load and handle lookup onQueryCompleted makes. All
+// threads load the one published table, as the engine's workers do, so the
+// threaded runs measure the shared reference count.
+static std::shared_ptr<const QueryTable> publishedTable;
+
+static void BM_QueryTableFindByHandle(benchmark::State& state) {
+    const int queries = static_cast<int>(state.range(0));
+    if (state.thread_index() == 0) {
+        std::atomic_store(&publishedTable, syntheticTable(queries));
+    }
+
+    // The loop starts once every thread is here, so the table is published
+    int i = state.thread_index() % queries;
+    for (auto _ : state) {
+        std::shared_ptr<const QueryTable> table = std::atomic_load(&publishedTable);
+        benchmark::DoNotOptimize(table->find(static_cast<QueryHandle>(i * 3)));
+        i = (i + 1) % queries;
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        std::atomic_store(&publishedTable, std::shared_ptr<const QueryTable>());
+    }
+}
+BENCHMARK(BM_QueryTableFindByHandle)->Arg(10)->Arg(1000)->Arg(100000)->ThreadRange(1, 8);
+
+static void BM_QueryTableFindById(benchmark::State& state) {
+    const int queries = static_cast<int>(state.range(0));
+    std::shared_ptr<const QueryTable> table = syntheticTable(queries);
+    std::vector<std::string> ids;
+    for (int i = 0; i < queries; ++i) {
+        ids.push_back("Query" + std::to_string(i));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table->find(ids[i]));
+        i = (i + 1) % ids.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueryTableFindById)->Arg(10)->Arg(1000)->Arg(100000);
+
+// What each UI edit costs: a new table sharing every other entry
+static void BM_QueryTableWith(benchmark::State& state) {
+    std::shared_ptr<const QueryTable> table = syntheticTable(static_cast<int>(state.range(0)));
+    QueryConfig query("Query0", "Edited", "SELECT 2");
+    query.handle = 0;
+    auto entry = std::make_shared<const QueryConfig>(query);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table->with(entry));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueryTableWith)->Arg(10)->Arg(1000);
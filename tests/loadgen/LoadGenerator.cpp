@@ -0,0 +1,178 @@
+// Runs QueryEngine against a live PostgreSQL with a synthetic workload of
+// N queries at M Hz each and reports scheduler lag and throughput. Exits
+// non-zero when a --max-* limit is exceeded, so it can gate a release.
+//
+//   monitor_loadgen -c config.txt --queries 200 --rate 5 --duration 30 --max-lag-ms 50
+
+#include "ConfigManager.h"
+#include "DatabaseManager.h"
+#include "AlertSystem.h"
+#include "QueryEngine.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+namespace {
+struct Workload {
+    int queries = 100;
+    double rateHz = 1.0;
+    int durationSeconds = 30;
+    int rows = 10;          // rows each query returns
+    int sleepMs = 0;        // server-side time each query takes
+    int workers = 5;
+    int maxQueued = 1000;
+    bool batch = false;
+};
+
+// Every query reads the same shape of rows; sleep makes each one hold its connection
+std::string syntheticQueries(const Workload& workload) {
+    const int intervalMs = std::max(1, static_cast<int>(1000.0 / workload.rateHz));
+
+    std::ostringstream conf;
+    for (int i = 0; i < workload.queries; ++i) {
+        conf << "[Load" << i << "]\n"
+             << "name=Load query " << i << "\n"
+             << "sql=SELECT g AS id, md5(g::text) AS payload";
+        if (workload.sleepMs > 0) {
+            conf << ", pg_sleep(" << workload.sleepMs / 1000.0 << ")";
+        }
+        conf << " FROM generate_series(1, " << workload.rows << ") AS g\n"
+             << "alert_type=info\n"
+             << "interval=" << intervalMs << "ms\n"
+             << "timeout=" << std::max(5, workload.sleepMs / 1000 + 5) << "\n\n";
+    }
+    return conf.str();
+}
+
+void printSummary(const char* label, const LatencySummary& summary) {
+    std::printf("  %-18s p50 %8.2f  p95 %8.2f  p99 %8.2f  max %8.2f ms  (n=%llu)\n", label,
+                summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs,
+                static_cast<unsigned long long>(summary.count));
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("PostgreSQL Monitor load generator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Drives QueryEngine with a synthetic workload and reports tick lag and throughput");
+    parser.addHelpOption();
+
+    QCommandLineOption configOption(QStringList() << "c" << "config",
+                                    "Configuration file with the [Database] to load", "file", "config.txt");
+    QCommandLineOption queriesOption("queries", "Number of queries", "n", "100");
+    QCommandLineOption rateOption("rate", "Runs per second of each query", "hz", "1");
+    QCommandLineOption durationOption("duration", "Length of the run in seconds", "seconds", "30");
+    QCommandLineOption rowsOption("rows", "Rows each query returns", "n", "10");
+    QCommandLineOption sleepOption("sleep", "Server time each query takes, in milliseconds", "ms", "0");
+    QCommandLineOption workersOption("workers", "Worker threads (max_concurrent_queries)", "n", "5");
+    QCommandLineOption queuedOption("max-queued", "Queue bound (max_queued_queries)", "n", "1000");
+    QCommandLineOption batchOption("batch", "Pipeline read-only queries (batch_execution)");
+    QCommandLineOption maxLagOption("max-lag-ms", "Fail when scheduler lag p99 exceeds this", "ms");
+    QCommandLineOption minThroughputOption("min-throughput", "Fail below this many runs per second", "runs");
+    QCommandLineOption debugOption("debug", "Enable debug output");
+    parser.addOptions({configOption, queriesOption, rateOption, durationOption, rowsOption, sleepOption,
+                       workersOption, queuedOption, batchOption, maxLagOption, minThroughputOption, debugOption});
+    parser.process(app);
+
+    QLoggingCategory::setFilterRules(parser.isSet(debugOption) ? "*.debug=true" : "*.debug=false");
+
+    Workload workload;
+    workload.queries = std::max(1, parser.value(queriesOption).toInt());
+    workload.rateHz = std::max(0.001, parser.value(rateOption).toDouble());
+    workload.durationSeconds = std::max(1, parser.value(durationOption).toInt());
+    workload.rows = std::max(0, parser.value(rowsOption).toInt());
+    workload.sleepMs = std::max(0, parser.value(sleepOption).toInt());
+    workload.workers = std::max(1, parser.value(workersOption).toInt());
+    workload.maxQueued = std::max(1, parser.value(queuedOption).toInt());
+    workload.batch = parser.isSet(batchOption);
+
+    ConfigManager configManager;
+    if (!configManager.loadFromFile(parser.value(configOption))) {
+        std::cerr << "Cannot load " << parser.value(configOption).toStdString() << "\n";
+        return 2;
+    }
+
+    DatabaseManager database(&configManager);
+    if (!database.connect()) {
+        std::cerr << "Cannot connect: " << database.getLastError() << "\n";
+        return 2;
+    }
+
+    // Alerts are part of the processing being measured, but their duplicates are not
+    AlertSystem alerts;
+    alerts.setDuplicateDetectionEnabled(false);
+
+    QueryEngine engine(&database, &alerts);
+    engine.setMaxConcurrentQueries(workload.workers);
+    engine.setMaxQueuedQueries(workload.maxQueued);
+    engine.setBatchExecution(workload.batch);
+    if (!engine.loadQueriesFromString(syntheticQueries(workload))) {
+        std::cerr << "Failed to load the synthetic queries\n";
+        return 2;
+    }
+
+    std::printf("Load: %d queries at %.2f Hz (%.0f runs/s offered) for %d s, %d workers%s\n",
+                workload.queries, workload.rateHz, workload.queries * workload.rateHz,
+                workload.durationSeconds, workload.workers, workload.batch ? ", batched" : "");
+
+    // Progress once a second, so a stall shows while it happens
+    int lastExecuted = 0;
+    QTimer progress;
+    progress.setInterval(1000);
+    QObject::connect(&progress, &QTimer::timeout, [&]() {
+        int executed = engine.getExecutedQueriesCount();
+        std::printf("  %5d runs/s  lag p95 %7.2f ms  queue %4d  active %2d\n",
+                    executed - lastExecuted, engine.getSchedulerLag().p95Ms,
+                    engine.getQueueDepth(), engine.getActiveWorkerCount());
+        std::fflush(stdout);
+        lastExecuted = executed;
+    });
+
+    QElapsedTimer elapsed;
+    QTimer::singleShot(workload.durationSeconds * 1000, &app, [&]() {
+        engine.stopMonitoring();
+        progress.stop();
+        QCoreApplication::quit();
+    });
+
+    elapsed.start();
+    engine.startMonitoring();
+    progress.start();
+    app.exec();
+
+    const double seconds = elapsed.elapsed() / 1000.0;
+    const int executed = engine.getExecutedQueriesCount();
+    const double throughput = executed / seconds;
+    const LatencySummary lag = engine.getSchedulerLag();
+
+    std::printf("\nResults over %.1f s\n", seconds);
+    std::printf("  throughput         %.1f runs/s of %.1f offered\n", throughput, workload.queries * workload.rateHz);
+    std::printf("  executed %d, failed %d, dropped %d, skipped in flight %d\n", executed,
+                engine.getFailedQueriesCount(), engine.getDroppedQueriesCount(), engine.getSkippedQueriesCount());
+    std::printf("  missed runs %d, tick overruns %d, deepest queue %d\n", engine.getMissedRunCount(),
+                engine.getTickOverrunCount(), engine.getMaxQueueDepth());
+    printSummary("scheduler lag", lag);
+    printSummary("queue wait", engine.getQueueWait());
+    printSummary("execution", engine.getOverallLatency());
+
+    int status = 0;
+    if (parser.isSet(maxLagOption) && lag.p99Ms > parser.value(maxLagOption).toDouble()) {
+        std::printf("FAIL: scheduler lag p99 %.2f ms exceeds %s ms\n", lag.p99Ms,
+                    parser.value(maxLagOption).toStdString().c_str());
+        status = 1;
+    }
+    if (parser.isSet(minThroughputOption) && throughput < parser.value(minThroughputOption).toDouble()) {
+        std::printf("FAIL: throughput %.1f runs/s is below %s\n", throughput,
+                    parser.value(minThroughputOption).toStdString().c_str());
+        status = 1;
+    }
+    return status;
+}